@@ -0,0 +1,77 @@
+#version 450
+
+layout(location = 0) in vec2 uv;
+layout(binding = 0) uniform sampler2D source;
+
+layout(push_constant) uniform push_data{
+    float threshold;
+    float knee;
+    float radius;
+    //the first pass reads the hdr image
+    int is_prefilter;
+} push;
+
+layout(location = 0) out vec4 out_color;
+
+float karis_weight(vec3 color){
+    return 1.0 / (1.0 + dot(color, vec3(0.2126, 0.7152, 0.0722)));
+}
+
+//soft knee threshold
+vec3 prefilter(vec3 color){
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - push.threshold + push.knee, 0.0, 2.0 * push.knee);
+    soft = soft * soft / (4.0 * push.knee + 0.00001);
+    float contribution = max(soft, brightness - push.threshold) / max(brightness, 0.00001);
+    return color * contribution;
+}
+
+void main(){
+    vec2 texel = 1.0 / textureSize(source, 0);
+
+    //13 taps, a b c
+    //          j k
+    //         d e f
+    //          l m
+    //         g h i
+    vec3 a = texture(source, uv + texel * vec2(-2.0, -2.0)).rgb;
+    vec3 b = texture(source, uv + texel * vec2( 0.0, -2.0)).rgb;
+    vec3 c = texture(source, uv + texel * vec2( 2.0, -2.0)).rgb;
+    vec3 d = texture(source, uv + texel * vec2(-2.0,  0.0)).rgb;
+    vec3 e = texture(source, uv).rgb;
+    vec3 f = texture(source, uv + texel * vec2( 2.0,  0.0)).rgb;
+    vec3 g = texture(source, uv + texel * vec2(-2.0,  2.0)).rgb;
+    vec3 h = texture(source, uv + texel * vec2( 0.0,  2.0)).rgb;
+    vec3 i = texture(source, uv + texel * vec2( 2.0,  2.0)).rgb;
+    vec3 j = texture(source, uv + texel * vec2(-1.0, -1.0)).rgb;
+    vec3 k = texture(source, uv + texel * vec2( 1.0, -1.0)).rgb;
+    vec3 l = texture(source, uv + texel * vec2(-1.0,  1.0)).rgb;
+    vec3 m = texture(source, uv + texel * vec2( 1.0,  1.0)).rgb;
+
+    vec3 color;
+    if(push.is_prefilter != 0){
+        //weight the boxes by luminance so single bright pixels do not flicker
+        vec3 boxes[5] = {
+            (a + b + d + e) * 0.25,
+            (b + c + e + f) * 0.25,
+            (d + e + g + h) * 0.25,
+            (e + f + h + i) * 0.25,
+            (j + k + l + m) * 0.25
+        };
+        const float box_weights[5] = {0.125, 0.125, 0.125, 0.125, 0.5};
+        color = vec3(0.0);
+        float weight_sum = 0.0;
+        for(int n = 0; n < 5; n++){
+            float weight = box_weights[n] * karis_weight(boxes[n]);
+            color += boxes[n] * weight;
+            weight_sum += weight;
+        }
+        color = prefilter(color / weight_sum);
+    }else{
+        color = e * 0.125;
+        color += (a + c + g + i) * 0.03125;
+        color += (b + d + f + h) * 0.0625;
+        color += (j + k + l + m) * 0.125;
+    }
+    out_color = vec4(max(color, vec3(0.0)), 1.0);
+}
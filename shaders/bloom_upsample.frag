@@ -0,0 +1,30 @@
+#version 450
+
+layout(location = 0) in vec2 uv;
+layout(binding = 0) uniform sampler2D source;
+
+layout(push_constant) uniform push_data{
+    float threshold;
+    float knee;
+    float radius;
+    int is_prefilter;
+} push;
+
+layout(location = 0) out vec4 out_color;
+
+//3x3 tent, blended additively onto the larger mip
+void main(){
+    vec2 offset = push.radius / textureSize(source, 0);
+
+    vec3 color = texture(source, uv).rgb * 4.0;
+    color += texture(source, uv + offset * vec2( 0.0, -1.0)).rgb * 2.0;
+    color += texture(source, uv + offset * vec2(-1.0,  0.0)).rgb * 2.0;
+    color += texture(source, uv + offset * vec2( 1.0,  0.0)).rgb * 2.0;
+    color += texture(source, uv + offset * vec2( 0.0,  1.0)).rgb * 2.0;
+    color += texture(source, uv + offset * vec2(-1.0, -1.0)).rgb;
+    color += texture(source, uv + offset * vec2( 1.0, -1.0)).rgb;
+    color += texture(source, uv + offset * vec2(-1.0,  1.0)).rgb;
+    color += texture(source, uv + offset * vec2( 1.0,  1.0)).rgb;
+
+    out_color = vec4(color / 16.0, 1.0);
+}
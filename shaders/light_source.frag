@@ -5,12 +5,13 @@ layout(location = 1) in vec2 offset;
 layout(location = 2) in float radius;
 
 layout(location = 0) out vec4 out_color;
-layout(location = 1) out vec4 bright_color;
+//light sources are not pickable
+layout(location = 1) out uint out_object_id;
 
 void main(){
     if(radius * radius < dot(offset,offset)){
         discard;
     }
-    out_color = vec4(color * (1.0 - step(2.0, dot(color,color))),1.0);
-    bright_color = vec4(color * step(2.0, dot(color,color)),1.0);
+    out_color = vec4(color,1.0);
+    out_object_id = 0;
 }
\ No newline at end of file
@@ -13,9 +13,11 @@ layout(location = 1) in vec3 frag_color;
 layout(location = 2) in vec2 frag_uv;
 layout(location = 3) in vec3 frag_normal;
 layout(location = 4) in mat3 TBN;
+layout(location = 7) flat in uint frag_object_id;
 
 layout(location = 0) out vec4 out_color;
-layout(location = 1) out vec4 bright_color;
+//discarded if the render pass has no object id attachment
+layout(location = 1) out uint out_object_id;
 
 layout(set = 1, binding = 1) uniform PointLight_UBO{
     PointLight lights[POINT_LIGHT_LIMIT];
@@ -30,6 +32,11 @@ layout(set = 2, binding = 1) uniform Material_const{
     bool has_normal;
 }ubo_material;
 
+//baked environment lighting
+layout(set = 3, binding = 0) uniform samplerCube irradiance_map;
+layout(set = 3, binding = 1) uniform samplerCube prefiltered_map;
+layout(set = 3, binding = 2) uniform sampler2D brdf_lut;
+
 //material
 #define ALBEDO 0
 #define METALLIC 1
@@ -37,6 +44,13 @@ layout(set = 2, binding = 1) uniform Material_const{
 #define NORMAL 3
 //
 
+//permutation of the material, RendererSolid creates a pipeline per combination
+layout(constant_id = 0) const bool ALBEDO_TEXTURE = true;
+layout(constant_id = 1) const bool METALLIC_TEXTURE = true;
+layout(constant_id = 2) const bool ROUGHNESS_TEXTURE = true;
+layout(constant_id = 3) const bool NORMAL_MAP = true;
+layout(constant_id = 4) const int POINT_LIGHT_COUNT = 1;
+
 layout(push_constant) uniform push_data{
     vec3 camera_pos;
 } push;
@@ -45,6 +59,10 @@ vec3 Fresnel_function(vec3 albedo,vec3 F0, float metalness, float cos_view_halfw
     return F0 + (1.0 - F0) * pow((1.0 - cos_view_halfway),5.0);
 }
 
+vec3 Fresnel_function_roughness(vec3 F0, float roughness, float cos_norm_view){
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow((1.0 - cos_norm_view),5.0);
+}
+
 // fspecular
 vec3 Cook_Torrance_function(float D, vec3 F, float G, vec3 V, vec3 N, vec3 L){
     return              (D * F * G) /
@@ -93,30 +111,47 @@ vec3 calculate_lighting(PointLight light, vec3 V, vec3 albedo, vec3 N, float met
     return result;
 }
 
+vec3 calculate_ambient_lighting(vec3 V, vec3 albedo, vec3 N, float metalness, float roughness, vec3 F0){
+    float cos_norm_view = max(dot(N, V), 0.0);
+    vec3 Fresnel = Fresnel_function_roughness(F0, roughness, cos_norm_view);
+    vec3 Kd = (1.0 - Fresnel) * (1.0 - metalness);
+
+    vec3 diffuse = texture(irradiance_map, N).rgb * albedo;
+
+    //split sum, the prefiltered mips go from smooth to rough
+    vec3 R = reflect(-V, N);
+    float lod = roughness * float(textureQueryLevels(prefiltered_map) - 1);
+    vec3 prefiltered = textureLod(prefiltered_map, R, lod).rgb;
+    vec2 brdf = texture(brdf_lut, vec2(cos_norm_view, roughness)).rg;
+    vec3 specular = prefiltered * (Fresnel * brdf.x + brdf.y);
+
+    return Kd * diffuse + specular;
+}
+
 void main(){
     vec3 albedo;
-    if(ubo_material.albedo == vec3(-1.0)){
+    if(ALBEDO_TEXTURE){
          albedo = texture(material[ALBEDO], frag_uv).rgb;
     }else{
         albedo = ubo_material.albedo;
     }
 
     vec3 normal;
-    if(ubo_material.has_normal){
+    if(NORMAL_MAP){
         normal = normalize(TBN * (texture(material[NORMAL],frag_uv).xyz * 2.0 - 1.0));
     }else{
         normal = frag_normal;
     }
 
     float metalness;
-    if(ubo_material.metalness == -1.0){
+    if(METALLIC_TEXTURE){
         metalness = texture(material[METALLIC], frag_uv).r;
     }else{
         metalness = ubo_material.metalness;
     }
 
     float roughness;
-    if(ubo_material.roughness == -1.0){
+    if(ROUGHNESS_TEXTURE){
         roughness = texture(material[ROUGHNESS],frag_uv).r;
     }else{
         roughness = ubo_material.roughness;
@@ -124,9 +159,12 @@ void main(){
     vec3 frag_to_camera = normalize(push.camera_pos - frag_pos);
 
     vec3 F0 = mix(vec3(0.04), albedo, metalness);
-    vec3 color = vec3(0.01) * albedo;
+    vec3 color = calculate_ambient_lighting(frag_to_camera, albedo, normal, metalness, roughness, F0);
 
-    color += calculate_lighting(light_ubo.lights[0], frag_to_camera, albedo, normal, metalness, roughness, F0);
+    for(int i = 0; i < min(POINT_LIGHT_COUNT, POINT_LIGHT_LIMIT); i++){
+        color += calculate_lighting(light_ubo.lights[i], frag_to_camera, albedo, normal, metalness, roughness, F0);
+    }
 
     out_color = vec4(color, 1.0);
+    out_object_id = frag_object_id;
 }
\ No newline at end of file
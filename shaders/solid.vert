@@ -1,7 +1,5 @@
 #version 450
 
-#define GROUP_MODEL_LIMIT 30
-
 const vec3 colors[] = {
     vec3(1.0,0.0,0.0),
     vec3(0.0,1.0,0.0),
@@ -13,8 +11,9 @@ layout(set = 0, binding = 0) uniform global_UBO{
     mat4 perspective;
 }ubo;
 
+//transforms of the whole scene, indexed by the first instance of the draw
 layout(set = 1, binding = 0) readonly buffer Transform{
-    mat4 model[GROUP_MODEL_LIMIT];
+    mat4 model[];
 }transform;
 
 
@@ -29,6 +28,8 @@ layout(location = 1) out vec3 frag_color;
 layout(location = 2) out vec2 frag_uv;
 layout(location = 3) out vec3 frag_normal;
 layout(location = 4) out mat3 TBN;
+//transform index + 1, 0 is left for the background
+layout(location = 7) flat out uint frag_object_id;
 
 void main(){
     mat3 model_inverse = inverse(transpose(mat3(transform.model[gl_InstanceIndex])));
@@ -40,6 +41,7 @@ void main(){
     vec3 T = normalize(mat3(transform.model[gl_InstanceIndex]) * tangent);
     vec3 B = cross(T,frag_normal);
     TBN = mat3(T,B,frag_normal);
+    frag_object_id = uint(gl_InstanceIndex) + 1;
     
     gl_Position = ubo.perspective * ubo.view * vec4(frag_pos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "Bvh.h"
+#include "Utils.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+//compares the build, refit and query times of the BVH with a linear scan at 1k, 10k and 100k items
+
+using benchmark_clock = std::chrono::steady_clock;
+
+//microseconds per call
+template<typename F>
+static double measure(uint32_t repeat_count, F&& function) {
+	const auto start = benchmark_clock::now();
+	for (uint32_t i = 0; i < repeat_count; i++) {
+		function(i);
+	}
+	return std::chrono::duration<double, std::micro>(benchmark_clock::now() - start).count() / repeat_count;
+}
+
+static const char* match(bool is_equal) {
+	return is_equal ? "" : " MISMATCH";
+}
+
+static void run_size(uint32_t item_count) {
+	//the same density at every size
+	std::mt19937 random(item_count);
+	const float world_size = 10.f * std::cbrt(static_cast<float>(item_count));
+	std::uniform_real_distribution<float> position(-world_size, world_size);
+	std::uniform_real_distribution<float> size(0.2f, 2.f);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+	std::vector<Aabb> bounds(item_count);
+	for (Aabb& box : bounds) {
+		const glm::vec3 center(position(random), position(random), position(random));
+		const glm::vec3 half_size(size(random), size(random), size(random));
+		box.min = center - half_size;
+		box.max = center + half_size;
+	}
+
+	Bvh bvh;
+	const double build_time = measure(1, [&](uint32_t) {
+		for (uint32_t i = 0; i < item_count; i++) {
+			bvh.set_bounds(i, bounds[i]);
+		}
+		bvh.build();
+	});
+
+	//a tenth of the items moves every frame
+	const double refit_time = measure(10, [&](uint32_t frame) {
+		for (uint32_t i = frame; i < item_count; i += 10) {
+			Aabb box = bounds[i];
+			box.min.x += 0.1f;
+			box.max.x += 0.1f;
+			bvh.set_bounds(i, box);
+		}
+		bvh.update();
+	});
+
+	//cameras at the center looking around
+	const uint32_t query_count = 64;
+	std::vector<Frustum> frustums;
+	std::vector<Ray> rays;
+	std::vector<glm::vec3> sphere_centers;
+	for (uint32_t i = 0; i < query_count; i++) {
+		glm::vec3 forward = glm::normalize(glm::vec3(unit(random), unit(random) * 0.5f, unit(random)) + glm::vec3(0.f, 0.f, 0.01f));
+		const glm::vec3 eye(position(random) * 0.5f, position(random) * 0.5f, position(random) * 0.5f);
+		const glm::mat4 view = glm::lookAt(eye, eye + forward, glm::vec3(0.f, 1.f, 0.f));
+		frustums.emplace_back(glm::perspective(glm::radians(90.f), 1.25f, 0.01f, world_size * 0.5f) * view);
+		rays.push_back(Ray{ eye, forward });
+		sphere_centers.push_back(eye);
+	}
+	const float sphere_radius = 25.f;
+
+	uint64_t bvh_visible = 0, linear_visible = 0;
+	const double bvh_frustum = measure(query_count, [&](uint32_t i) {
+		bvh.query_frustum(frustums[i], [&](uint32_t) { bvh_visible++; });
+	});
+	const double linear_frustum = measure(query_count, [&](uint32_t i) {
+		for (uint32_t item = 0; item < item_count; item++) {
+			linear_visible += frustums[i].intersects(bvh.get_bounds(item));
+		}
+	});
+
+	uint32_t bvh_hits = 0, linear_hits = 0;
+	const double bvh_ray = measure(query_count, [&](uint32_t i) {
+		float distance;
+		bvh_hits += bvh.raycast(rays[i], distance) != BVH_NO_ITEM;
+	});
+	const double linear_ray = measure(query_count, [&](uint32_t i) {
+		const glm::vec3 inverse_direction = 1.f / rays[i].direction;
+		float distance = FLT_MAX;
+		uint32_t closest = BVH_NO_ITEM;
+		for (uint32_t item = 0; item < item_count; item++) {
+			const float t = intersect_ray(rays[i], inverse_direction, bvh.get_bounds(item), distance);
+			if (t < distance) {
+				distance = t;
+				closest = item;
+			}
+		}
+		linear_hits += closest != BVH_NO_ITEM;
+	});
+
+	uint64_t bvh_overlaps = 0, linear_overlaps = 0;
+	const double bvh_sphere = measure(query_count, [&](uint32_t i) {
+		bvh.query_sphere(sphere_centers[i], sphere_radius, [&](uint32_t) { bvh_overlaps++; });
+	});
+	const double linear_sphere = measure(query_count, [&](uint32_t i) {
+		for (uint32_t item = 0; item < item_count; item++) {
+			linear_overlaps += bvh.get_bounds(item).overlaps_sphere(sphere_centers[i], sphere_radius);
+		}
+	});
+
+	LOG_STATUS(item_count, " items, ", bvh.get_node_count(), " nodes, build ", build_time, " us, refit of 10% ", refit_time, " us");
+	LOG_STATUS("frustum: bvh ", bvh_frustum, " us, linear ", linear_frustum, " us, visible ",
+		bvh_visible / query_count, match(bvh_visible == linear_visible));
+	LOG_STATUS("ray: bvh ", bvh_ray, " us, linear ", linear_ray, " us, hits ",
+		bvh_hits, match(bvh_hits == linear_hits));
+	LOG_STATUS("sphere: bvh ", bvh_sphere, " us, linear ", linear_sphere, " us, overlaps ",
+		bvh_overlaps / query_count, match(bvh_overlaps == linear_overlaps));
+}
+
+int main() {
+	for (uint32_t item_count : { 1000u, 10000u, 100000u }) {
+		run_size(item_count);
+	}
+	return 0;
+}
@@ -1,7 +1,43 @@
 #include "EnergycRenderer.h"
+#include "SceneFile.h"
+#include <cstring>
 
-int main(){
-    EnergycRenderer application(1280, 1024, "energyc_renderer", "energyc_renderer");
+//--headless [--frames N] [--output DIR] renders N frames offscreen and exits,
+//--benchmark FILE replays the benchmark script and writes its results, with or without a window,
+//--record FILE records the input and the camera, --replay FILE plays them back at a fixed delta time,
+//--scene FILE loads a JSON or .escene scene, --cook-scene IN OUT cooks a scene to .escene and exits
+int main(int argc, char** argv){
+    LaunchSettings launch_settings;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            launch_settings.is_headless = true;
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            launch_settings.frame_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            launch_settings.output_directory = argv[++i];
+        }
+        else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            launch_settings.benchmark_filename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            launch_settings.record_filename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            launch_settings.replay_filename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            launch_settings.scene_filename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--cook-scene") == 0 && i + 2 < argc) {
+            SceneDescription scene_description;
+            const bool is_cooked = scene_description.load(argv[i + 1]) && scene_description.save_binary(argv[i + 2]);
+            return is_cooked ? 0 : 1;
+        }
+    }
+
+    EnergycRenderer application(1280, 1024, "energyc_renderer", "energyc_renderer", launch_settings);
     application.run();
     return 0;
-}
\ No newline at end of file
+}
@@ -63,6 +63,15 @@ void CommandManager::copy_buffers(VkCommandBuffer command_buffer,
 	vkCmdCopyBuffer(command_buffer, src._buffer, dst._buffer, 1, &copy);
 }
 
+void CommandManager::copy_buffer_regions(VkCommandBuffer command_buffer,
+	const VulkanBuffer& src, const VulkanBuffer& dst,
+	const std::vector<VkBufferCopy>& regions) noexcept {
+	if (regions.empty()) {
+		return;
+	}
+	vkCmdCopyBuffer(command_buffer, src._buffer, dst._buffer, regions.size(), regions.data());
+}
+
 void CommandManager::copy_buffer_to_image(VkCommandBuffer command_buffer,
 	const VulkanBuffer& src_buffer, const VulkanImage& dst_image,
 	VkImageLayout dst_image_layout, const VkImageSubresourceLayers& subresource) noexcept {
@@ -77,7 +86,31 @@ void CommandManager::copy_buffer_to_image(VkCommandBuffer command_buffer,
 	vkCmdCopyBufferToImage(command_buffer, src_buffer._buffer, dst_image.get_image(), dst_image_layout, 1, &region);
 }
 
+void CommandManager::copy_buffer_to_image(VkCommandBuffer command_buffer,
+	const VulkanBuffer& src_buffer, VkImage dst_image,
+	VkImageLayout dst_image_layout, const std::vector<VkBufferImageCopy>& regions) noexcept {
+	vkCmdCopyBufferToImage(command_buffer, src_buffer._buffer, dst_image, dst_image_layout, regions.size(), regions.data());
+}
+
+void CommandManager::copy_image_to_buffer(VkCommandBuffer command_buffer,
+	VkImage src_image, VkImageLayout src_image_layout,
+	const VulkanBuffer& dst_buffer, const std::vector<VkBufferImageCopy>& regions) noexcept {
+	vkCmdCopyImageToBuffer(command_buffer, src_image, src_image_layout, dst_buffer._buffer, regions.size(), regions.data());
+}
+
 void CommandManager::transition_image_layout(VkCommandBuffer command_buffer, const VulkanImage& image,
+	VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage,
+	VkAccessFlags src_access, VkAccessFlags dst_access,
+	VkImageLayout old_layout, VkImageLayout new_layout,
+	const VkImageSubresourceRange& subresource_range) {
+	transition_image_layout(command_buffer, image.get_image(),
+		src_stage, dst_stage,
+		src_access, dst_access,
+		old_layout, new_layout,
+		subresource_range);
+}
+
+void CommandManager::transition_image_layout(VkCommandBuffer command_buffer, VkImage image,
 	VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage,
 	VkAccessFlags src_access, VkAccessFlags dst_access,
 	VkImageLayout old_layout, VkImageLayout new_layout,
@@ -86,7 +119,7 @@ void CommandManager::transition_image_layout(VkCommandBuffer command_buffer, con
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	barrier.srcAccessMask = src_access;
 	barrier.dstAccessMask = dst_access;
-	barrier.image = image.get_image();
+	barrier.image = image;
 	barrier.oldLayout = old_layout;
 	barrier.newLayout = new_layout;
 	barrier.subresourceRange = subresource_range;
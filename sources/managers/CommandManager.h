@@ -27,16 +27,35 @@ public:
 	static void copy_buffers(VkCommandBuffer command_buffer,
 		const class VulkanBuffer& src, const class VulkanBuffer& dst,
 		VkDeviceSize src_offset, VkDeviceSize dst_offset, VkDeviceSize size) noexcept;
+
+	//does nothing if the regions are empty
+	static void copy_buffer_regions(VkCommandBuffer command_buffer,
+		const class VulkanBuffer& src, const class VulkanBuffer& dst,
+		const std::vector<VkBufferCopy>& regions) noexcept;
 	
 	static void copy_buffer_to_image(VkCommandBuffer command_buffer,
 		const class VulkanBuffer& src_buffer, const class VulkanImage& dst_image,
 		VkImageLayout dst_image_layout, const VkImageSubresourceLayers& subresource) noexcept;
 
+	static void copy_buffer_to_image(VkCommandBuffer command_buffer,
+		const class VulkanBuffer& src_buffer, VkImage dst_image,
+		VkImageLayout dst_image_layout, const std::vector<VkBufferImageCopy>& regions) noexcept;
+
+	static void copy_image_to_buffer(VkCommandBuffer command_buffer,
+		VkImage src_image, VkImageLayout src_image_layout,
+		const class VulkanBuffer& dst_buffer, const std::vector<VkBufferImageCopy>& regions) noexcept;
+
 	static void transition_image_layout(VkCommandBuffer command_buffer, const VulkanImage& image,
 		VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage,
 		VkAccessFlags src_access, VkAccessFlags dst_access,
 		VkImageLayout old_layout, VkImageLayout new_layout,
 		const VkImageSubresourceRange& subresource_range);
+	//for images without a VulkanImage, like the swapchain ones
+	static void transition_image_layout(VkCommandBuffer command_buffer, VkImage image,
+		VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage,
+		VkAccessFlags src_access, VkAccessFlags dst_access,
+		VkImageLayout old_layout, VkImageLayout new_layout,
+		const VkImageSubresourceRange& subresource_range);
 
 	static void set_memory_dependency(VkCommandBuffer command_buffer,
 		VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage,
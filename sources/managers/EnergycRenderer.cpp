@@ -1,18 +1,16 @@
 #include "EnergycRenderer.h"
 #include "MaterialManager.h"
 #include "Scene.h"
-
-const std::string sphere_filename = std::string(RENDERER_DIRECTORY) + "/assets/sphere.obj";
-const std::string cube_filename = std::string(RENDERER_DIRECTORY) + "/assets/cube.obj";
-
-const std::string rusted_iron_albedo_filename = std::string(RENDERER_DIRECTORY) + "/assets/rustediron2_basecolor.png";
-const std::string rusted_iron_metallic_filename = std::string(RENDERER_DIRECTORY) + "/assets/rustediron2_metallic.png";
-const std::string rusted_iron_roughness_filename = std::string(RENDERER_DIRECTORY) + "/assets/rustediron2_roughness.png";
-const std::string rusted_iron_normal_filename = std::string(RENDERER_DIRECTORY) + "/assets/rustediron2_normal.png";
-
-EnergycRenderer::EnergycRenderer(int width, int height, const char* application_name, const char* engine_name) :
-	_window(width, height, application_name),
-	_core(_window.get_window(), application_name, engine_name),
+#include "SceneFile.h"
+#include "CpuProfiler.h"
+#include "ObjectPicker.h"
+#include "imgui.h"
+
+EnergycRenderer::EnergycRenderer(int width, int height, const char* application_name, const char* engine_name,
+	const LaunchSettings& launch_settings) :
+	_window(width, height, application_name, launch_settings.is_headless),
+	_core(_window, application_name, engine_name),
+	_launch_settings(launch_settings),
 	_camera(glm::vec3(0.0f, 0.f, -5.f)),
 	_controller(_window, _camera),
 	_material_manager(new MaterialManager()),
@@ -20,26 +18,12 @@ EnergycRenderer::EnergycRenderer(int width, int height, const char* application_
 	_gui_info(0.f,*_current_scene, _material_manager),
 	_scenes{ _current_scene } {
 
-	std::shared_ptr<PointLight> light(
-		new PointLight("My point light", glm::vec3(0.f), glm::vec3(10.f), 0.1));
-	
-	auto rusted_iron = _material_manager->create_new_material("Rusted iron",
-		rusted_iron_albedo_filename.c_str(),
-		rusted_iron_metallic_filename.c_str(),
-		rusted_iron_roughness_filename.c_str(),
-		rusted_iron_normal_filename.c_str());
-
-	_current_scene->add_point_light(light);
-
-	std::shared_ptr<Mesh> sphere(new Mesh(sphere_filename.c_str()));
-	sphere->set_material(rusted_iron);
-	for (float x = -6.f; x < 6.f; x += 2.f) {
-		for (float y = -6.f; y < 6.f; y += 2.f) {
-			sphere->set_pos(glm::vec3(x,y,5.f));
-			_current_scene->add_mesh(sphere);
-		}
+	SceneDescription scene_description;
+	if (!scene_description.load(_launch_settings.scene_filename)) {
+		LOG_ERROR("Failed to load the scene ", _launch_settings.scene_filename);
 	}
-	//_current_scene->add_mesh(sphere);
+	scene_description.instantiate(*_current_scene, *_material_manager);
+
 	RenderManagerCreateInfo render_manager_create_info{
 		_current_scene,
 		_controller.get_camera(),
@@ -48,21 +32,108 @@ EnergycRenderer::EnergycRenderer(int width, int height, const char* application_
 		_material_manager
 	};
 	_render_manager = std::unique_ptr<RenderManager>(new RenderManager(render_manager_create_info));
+	if (_window.is_headless()) {
+		_frame_capture = std::unique_ptr<FrameCapture>(new FrameCapture(_launch_settings.output_directory));
+	}
+	if (!_launch_settings.benchmark_filename.empty()) {
+		_benchmark = std::unique_ptr<Benchmark>(new Benchmark(_launch_settings.benchmark_filename));
+	}
+	if (!_launch_settings.replay_filename.empty() && !_controller.start_replay(_launch_settings.replay_filename)) {
+		LOG_ERROR("Failed to replay ", _launch_settings.replay_filename);
+	}
+	if (!_launch_settings.record_filename.empty()) {
+		_controller.start_recording(_launch_settings.record_filename);
+	}
 
 	LOG_STATUS("Application start.");
 }
 
+bool EnergycRenderer::is_running(uint32_t frame) const noexcept {
+	if (_benchmark && _benchmark->is_finished()) {
+		return false;
+	}
+	if (_controller.is_replaying() && _controller.is_replay_finished()) {
+		return false;
+	}
+	if (_window.is_headless()) {
+		return _benchmark || _controller.is_replaying() || frame < _launch_settings.frame_count;
+	}
+	return !glfwWindowShouldClose(_window.get_window());
+}
+
 void EnergycRenderer::run() {
-	while (!glfwWindowShouldClose(_window.get_window())) {
-		glfwPollEvents();
-		float delta_time = _timer.process_time();
-		_controller.process_input(delta_time);
+	for (uint32_t frame = 0; is_running(frame); frame++) {
+#ifdef CPU_PROFILER
+		CpuProfiler::begin_frame();
+#endif
+		if (!_window.is_headless()) {
+			glfwPollEvents();
+		}
+		const float frame_time = _timer.process_time();
+		float delta_time = frame_time;
+		if (_benchmark) {
+			//the measured time does not change the workload
+			delta_time = _benchmark->get_timestep();
+			_benchmark->update_camera(_camera);
+		}
+		else {
+			if (_controller.is_replaying()) {
+				delta_time = _controller.get_replay_timestep();
+			}
+			_controller.process_input(delta_time);
+		}
+		update_selection();
+		//recompiled shaders replace their pipelines before the frame is recorded
+		{
+			PROFILE_SCOPE("ShaderManager::update");
+			_shader_manager.update(delta_time);
+		}
 		draw_frame(delta_time);
+		_frame_statistics.end_frame(frame_time, _gui_info.render_queue_statistics);
+		if (_benchmark) {
+			_benchmark->end_frame(frame_time);
+		}
 		_core.next_frame();
 	}
+
+	if (_frame_capture || _benchmark) {
+		vkDeviceWaitIdle(Core::get_device());
+	}
+	if (_frame_capture) {
+		_frame_capture->flush();
+	}
+	if (_benchmark) {
+		_benchmark->write_results();
+	}
+}
+
+void EnergycRenderer::update_selection() {
+	//the object id of an earlier click was read back
+	uint32_t object_id;
+	if (_render_manager->get_object_id(object_id)) {
+		_current_scene->select(object_id == OBJECT_ID_NONE ? nullptr : _current_scene->get_transform_model(object_id - 1));
+	}
+
+	//delete removes the selected model with its children
+	if (_current_scene->get_selected() != nullptr && ImGui::GetCurrentContext() &&
+		!ImGui::GetIO().WantCaptureKeyboard && ImGui::IsKeyPressed(ImGuiKey_Delete, false)) {
+		_current_scene->remove_mesh(_current_scene->get_selected());
+	}
+
+	glm::vec2 click_ndc;
+	if (!_controller.consume_click(click_ndc) || (ImGui::GetCurrentContext() && ImGui::GetIO().WantCaptureMouse)) {
+		return;
+	}
+	const glm::vec2 pixel = (click_ndc * 0.5f + 0.5f) * glm::vec2(Core::get_swapchain_width(), Core::get_swapchain_height());
+	if (!_render_manager->request_object_id(static_cast<uint32_t>(pixel.x), static_cast<uint32_t>(pixel.y))) {
+		//the bounds are picked without the object id attachment
+		const float aspect = static_cast<float>(Core::get_swapchain_width()) / static_cast<float>(Core::get_swapchain_height());
+		_current_scene->select(_current_scene->pick(_camera.get_world_position(), _camera.get_ray_direction(click_ndc, aspect)));
+	}
 }
 
 void EnergycRenderer::update_uniform(float delta_time) {
+	PROFILE_FUNCTION();
 	_gui_info.delta_time = delta_time;
 
 	VkCommandBuffer command_buffer = _command_manager.get_frame_command_buffer();
@@ -72,6 +143,7 @@ void EnergycRenderer::update_uniform(float delta_time) {
 		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
 		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
 
+	_texture_streaming_manager.update(command_buffer);
 	_render_manager->update_descriptor_sets(command_buffer);
 
 	CommandManager::set_memory_dependency(command_buffer,
@@ -82,19 +154,34 @@ void EnergycRenderer::update_uniform(float delta_time) {
 void EnergycRenderer::update_render_tasks(float delta_time) {
 	VkCommandBuffer command_buffer = _command_manager.get_frame_command_buffer();
 	_render_manager->render(command_buffer);
+	if (_frame_capture) {
+		_frame_capture->record(command_buffer);
+	}
 
 	_command_manager.end_frame_command_buffer();
 }
 
 void EnergycRenderer::draw_frame(float delta_time) {
+	PROFILE_FUNCTION();
 	CurrentFrameSync frame_sync = _sync_manager.get_current_frame_sync_objects();
 
-	vkWaitForFences(_core.get_device(), 1, &frame_sync.fence, VK_TRUE, UINT64_MAX);
-	vkResetFences(_core.get_device(), 1, &frame_sync.fence);
+	{
+		PROFILE_SCOPE("wait frame fence");
+		vkWaitForFences(_core.get_device(), 1, &frame_sync.fence, VK_TRUE, UINT64_MAX);
+		vkResetFences(_core.get_device(), 1, &frame_sync.fence);
+	}
+	if (_frame_capture) {
+		_frame_capture->begin_frame();
+	}
 
-	auto result = _core.acquire_next_image(frame_sync.semaphore_to_render,NULL);
+	VkResult result;
+	{
+		PROFILE_SCOPE("acquire image");
+		result = _core.acquire_next_image(frame_sync.semaphore_to_render, NULL);
+	}
 
 	_command_manager.begin_frame_command_buffer();
+	_gpu_profiler.begin_frame(_command_manager.get_frame_command_buffer());
 	update_uniform(delta_time);
 	update_render_tasks(delta_time);
 
@@ -106,6 +193,7 @@ void EnergycRenderer::draw_frame(float delta_time) {
 		frame_sync.fence);									//fence
 	VK_ASSERT(result, "vkQueueSubmit() - FAILED");
 
+	PROFILE_SCOPE("present");
 	result = _core.queue_present(frame_sync.present_image_semaphores);
 }
 
@@ -3,9 +3,33 @@
 #include "RenderManager.h";
 #include "CommandManager.h"
 #include "SyncManager.h"
+#include "TextureStreamingManager.h"
+#include "ShaderManager.h"
 #include "UserController.h"
 #include "RendererGui.h"
 #include "Timer.h"
+#include "ThreadPool.h"
+#include "BakeCache.h"
+#include "PipelineCache.h"
+#include "GpuProfiler.h"
+#include "FrameStatistics.h"
+#include "FrameCapture.h"
+#include "Benchmark.h"
+
+struct LaunchSettings {
+	//JSON or cooked .escene, relative to RENDERER_DIRECTORY
+	std::string scene_filename = "assets/scenes/sphere_grid.json";
+	bool is_headless = false;
+	//headless frames without a benchmark
+	uint32_t frame_count = 100;
+	//headless frames are not written if empty
+	std::string output_directory;
+	//runs the benchmark script instead of the user input if not empty
+	std::string benchmark_filename;
+	//input recordings, the replay runs at its mean delta time until it ends
+	std::string record_filename;
+	std::string replay_filename;
+};
 
 class EnergycRenderer {
 private:
@@ -14,10 +38,21 @@ private:
 	Core _core;
 
 	StagingBuffer _staging_buffer;
+	ThreadPool _thread_pool;
+	BakeCache _bake_cache;
+	PipelineCache _pipeline_cache;
+	FrameStatistics _frame_statistics;
 
 	CommandManager _command_manager;
 	SyncManager _sync_manager;
+	TextureStreamingManager _texture_streaming_manager;
+	ShaderManager _shader_manager;
+	GpuProfiler _gpu_profiler;
 	std::unique_ptr<RenderManager> _render_manager;
+	//only in the headless mode
+	std::unique_ptr<FrameCapture> _frame_capture;
+	std::unique_ptr<Benchmark> _benchmark;
+	LaunchSettings _launch_settings;
 
 	FreeCamera _camera;
 	FreeCameraController _controller;
@@ -30,12 +65,16 @@ private:
 	GuiInfo _gui_info;
 
 private:
+	//object picking of the left click
+	void update_selection();
 	void update_uniform(float delta_time);
 	void update_render_tasks(float delta_time);
 	void draw_frame(float delta_time);
+	bool is_running(uint32_t frame) const noexcept;
 
 public:
-	EnergycRenderer(int width, int height, const char* application_name, const char* engine_name);
+	EnergycRenderer(int width, int height, const char* application_name, const char* engine_name,
+		const LaunchSettings& launch_settings = LaunchSettings{});
 
 	void run();
 
@@ -10,17 +10,40 @@ constexpr uint32_t MATERIAL_BUFFER_LIMIT = 10;
 ObjectMaterial::ObjectMaterial(const std::string& name, int32_t material_index) noexcept :
 	NamedObject(name), _material_index(material_index) {}
 
+std::array<DecodedImage, 4> MaterialManager::Material::decode_textures(const char* albedo,
+	const char* metallic,
+	const char* roughness,
+	const char* normal) noexcept {
+	std::array<std::future<DecodedImage>, 4> futures{
+		image_import::decode_async(albedo, false),
+		image_import::decode_async(metallic, false),
+		image_import::decode_async(roughness, false),
+		image_import::decode_async(normal, false)
+	};
+	return { futures[0].get(), futures[1].get(), futures[2].get(), futures[3].get() };
+}
+
 MaterialManager::Material::Material(const std::string& name,
 	int32_t material_index, const VulkanBuffer& material_ubo,
 	const char* albedo,
 	const char* metallic,
 	const char* roughness,
 	const char* normal) noexcept :
+	Material(name, material_index, material_ubo, albedo, metallic, roughness, normal,
+		decode_textures(albedo, metallic, roughness, normal)) {}
+
+MaterialManager::Material::Material(const std::string& name,
+	int32_t material_index, const VulkanBuffer& material_ubo,
+	const char* albedo,
+	const char* metallic,
+	const char* roughness,
+	const char* normal,
+	const std::array<DecodedImage, 4>& images) noexcept :
 	ObjectMaterial(name,material_index),
-	_albedo(VK_FORMAT_R8G8B8A8_SRGB,albedo),
-	_metallic(VK_FORMAT_R8G8B8A8_UNORM,metallic),
-	_roughness(VK_FORMAT_R8G8B8A8_UNORM, roughness),
-	_normal(VK_FORMAT_R8G8B8A8_UNORM,normal),
+	_albedo(VK_FORMAT_R8G8B8A8_SRGB, albedo, images[0]),
+	_metallic(VK_FORMAT_R8G8B8A8_UNORM, metallic, images[1]),
+	_roughness(VK_FORMAT_R8G8B8A8_UNORM, roughness, images[2]),
+	_normal(VK_FORMAT_R8G8B8A8_UNORM, normal, images[3]),
 	_ubo_data(glm::vec3(-1.f),-1.f,-1.f,VK_TRUE),
 	_material_ubo(material_ubo)	
 {
@@ -69,6 +92,36 @@ void MaterialManager::Material::update_uniform_buffer(VkCommandBuffer command_bu
 	}
 }
 
+void MaterialManager::Material::update_texture_descriptors(VkDescriptorSet descriptor_set) noexcept {
+	if (_albedo.is_descriptor_written() && _metallic.is_descriptor_written() &&
+		_roughness.is_descriptor_written() && _normal.is_descriptor_written()) {
+		return;
+	}
+
+	auto image_info = get_info();
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.descriptorCount = image_info.size();
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.dstBinding = 0;
+	write.dstArrayElement = 0;
+	write.dstSet = descriptor_set;
+	write.pImageInfo = image_info.data();
+	vkUpdateDescriptorSets(Core::get_device(), 1, &write, 0, 0);
+
+	_albedo.set_descriptor_written();
+	_metallic.set_descriptor_written();
+	_roughness.set_descriptor_written();
+	_normal.set_descriptor_written();
+}
+
+void MaterialManager::Material::report_usage(float screen_size) noexcept {
+	_albedo.report_usage(screen_size);
+	_metallic.report_usage(screen_size);
+	_roughness.report_usage(screen_size);
+	_normal.report_usage(screen_size);
+}
+
 std::vector<VkDescriptorImageInfo> MaterialManager::Material::get_info() {
 	std::vector<VkDescriptorImageInfo> info{
 		_albedo.get_info(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
@@ -110,32 +163,33 @@ MaterialManager::MaterialManager() :
 
 void MaterialManager::push_new_descriptor_pool() {
 	VkDescriptorPool descriptor_pool;
+	const uint32_t set_count = MATERIAL_ALLOCATION_POOL * Core::get_swapchain_image_count();
 
 	VkDescriptorPoolSize pool_sizes[2]{};
-	pool_sizes[0].descriptorCount = MATERIAL_ALLOCATION_POOL * 4;
+	pool_sizes[0].descriptorCount = set_count * 4;
 	pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 
-	pool_sizes[1].descriptorCount = MATERIAL_ALLOCATION_POOL;
+	pool_sizes[1].descriptorCount = set_count;
 	pool_sizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 
 	VkDescriptorPoolCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	create_info.poolSizeCount = 2;
 	create_info.pPoolSizes = pool_sizes;
-	create_info.maxSets = MATERIAL_ALLOCATION_POOL;
+	create_info.maxSets = set_count;
 	VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &create_info, nullptr, &descriptor_pool),"vkCreateDescriptorPool() - FAILED");
 	_descriptor_pools.push_back(descriptor_pool);
 
-	_descriptor_sets.resize(_descriptor_sets.size() + MATERIAL_ALLOCATION_POOL);
-	std::vector< VkDescriptorSetLayout> layouts(MATERIAL_ALLOCATION_POOL, _descriptor_set_layout);
+	_descriptor_sets.resize(_descriptor_sets.size() + set_count);
+	std::vector< VkDescriptorSetLayout> layouts(set_count, _descriptor_set_layout);
 	VkDescriptorSetAllocateInfo alloc_info{};
 	alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	alloc_info.descriptorPool = descriptor_pool;
-	alloc_info.descriptorSetCount = MATERIAL_ALLOCATION_POOL;
+	alloc_info.descriptorSetCount = set_count;
 	alloc_info.pSetLayouts = layouts.data();
 	VK_ASSERT(vkAllocateDescriptorSets(Core::get_device(),
 		&alloc_info,
-		_descriptor_sets.data() + _descriptor_sets.size() - MATERIAL_ALLOCATION_POOL),
+		_descriptor_sets.data() + _descriptor_sets.size() - set_count),
 		"vkAllocateDescriptorSets() - FAILED");
 
 	_pool_allocations_left = MATERIAL_ALLOCATION_POOL;
@@ -158,6 +212,24 @@ std::vector<VkDescriptorSetLayoutBinding> MaterialManager::get_bindings() {
 	return bindings;
 }
 
+uint32_t MaterialManager::Material::get_features() const noexcept {
+	//-1 marks the values read from the textures
+	uint32_t features = 0;
+	if (_ubo_data.albedo == glm::vec3(-1.f)) {
+		features |= MATERIAL_FEATURE_ALBEDO_TEXTURE;
+	}
+	if (_ubo_data.metallic == -1.f) {
+		features |= MATERIAL_FEATURE_METALLIC_TEXTURE;
+	}
+	if (_ubo_data.roughness == -1.f) {
+		features |= MATERIAL_FEATURE_ROUGHNESS_TEXTURE;
+	}
+	if (_ubo_data.has_normal) {
+		features |= MATERIAL_FEATURE_NORMAL_MAP;
+	}
+	return features;
+}
+
 void MaterialManager::Material::show_gui_info() noexcept {
 	ImGui::BeginChild(_name.c_str(), ImVec2(0, 0),
 		ImGuiChildFlags_AutoResizeX |
@@ -180,8 +252,10 @@ void MaterialManager::Material::show_gui_info() noexcept {
 }
 
 void MaterialManager::update_uniform_buffer(VkCommandBuffer command_buffer) noexcept {
-	for (auto& material : _materials) {
-		material->update_uniform_buffer(command_buffer);
+	const uint32_t image_count = Core::get_swapchain_image_count();
+	for (uint32_t i = 0; i < _materials.size(); i++) {
+		_materials[i]->update_uniform_buffer(command_buffer);
+		_materials[i]->update_texture_descriptors(_descriptor_sets[i * image_count + Core::get_current_frame()]);
 	}
 }
 
@@ -200,7 +274,8 @@ ObjectMaterial MaterialManager::create_new_material(const std::string& name,
 		push_new_descriptor_pool();
 	}
 
-	int32_t material_index = _descriptor_sets.size() - _pool_allocations_left;
+	const uint32_t image_count = Core::get_swapchain_image_count();
+	int32_t material_index = _descriptor_sets.size() / image_count - _pool_allocations_left;
 
 	Material* material = new Material(name, material_index,_material_ubo, albedo, metallic, roughness, normal);
 	_materials.emplace_back(material);
@@ -209,24 +284,26 @@ ObjectMaterial MaterialManager::create_new_material(const std::string& name,
 	VkDeviceSize offset = (_material_ubo.get_size() / MATERIAL_BUFFER_LIMIT) * material_index;
 	auto buffer_info = _material_ubo.get_info(offset, sizeof(MaterialUniformData));
 
-	VkWriteDescriptorSet write[2]{};
-	write[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write[0].descriptorCount = image_info.size();
-	write[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	write[0].dstBinding = 0;
-	write[0].dstArrayElement = 0;
-	write[0].dstSet = _descriptor_sets[material_index];
-	write[0].pImageInfo = image_info.data();
-
-	write[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write[1].descriptorCount = 1;
-	write[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	write[1].dstBinding = 1;
-	write[1].dstArrayElement = 0;
-	write[1].dstSet = _descriptor_sets[material_index];
-	write[1].pBufferInfo = &buffer_info;
-
-	vkUpdateDescriptorSets(Core::get_device(), 2, write, 0, 0);
+	for (uint32_t i = 0; i < image_count; i++) {
+		VkWriteDescriptorSet write[2]{};
+		write[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write[0].descriptorCount = image_info.size();
+		write[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write[0].dstBinding = 0;
+		write[0].dstArrayElement = 0;
+		write[0].dstSet = _descriptor_sets[material_index * image_count + i];
+		write[0].pImageInfo = image_info.data();
+
+		write[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write[1].descriptorCount = 1;
+		write[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		write[1].dstBinding = 1;
+		write[1].dstArrayElement = 0;
+		write[1].dstSet = _descriptor_sets[material_index * image_count + i];
+		write[1].pBufferInfo = &buffer_info;
+
+		vkUpdateDescriptorSets(Core::get_device(), 2, write, 0, 0);
+	}
 
 	_pool_allocations_left--;
 	LOG_STATUS("Created new material: ", name);
@@ -241,24 +318,26 @@ ObjectMaterial MaterialManager::create_new_material(const std::string& name,
 		push_new_descriptor_pool();
 	}
 
-	int32_t material_index = _descriptor_sets.size() - _pool_allocations_left;
+	const uint32_t image_count = Core::get_swapchain_image_count();
+	int32_t material_index = _descriptor_sets.size() / image_count - _pool_allocations_left;
 
 	Material* material = new Material(name, material_index,_material_ubo, albedo, metallic, roughness);
 	_materials.emplace_back(material);
 	VkDeviceSize offset = (_material_ubo.get_size() / MATERIAL_BUFFER_LIMIT) * material_index;
 	auto buffer_info = _material_ubo.get_info(offset, sizeof(MaterialUniformData));
 
-
-	VkWriteDescriptorSet write{};
-	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.descriptorCount = 1;
-	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	write.dstBinding = 1;
-	write.dstArrayElement = 0;
-	write.dstSet = _descriptor_sets[material_index];
-	write.pBufferInfo = &buffer_info;
-
-	vkUpdateDescriptorSets(Core::get_device(), 1, &write, 0, 0);
+	for (uint32_t i = 0; i < image_count; i++) {
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		write.dstBinding = 1;
+		write.dstArrayElement = 0;
+		write.dstSet = _descriptor_sets[material_index * image_count + i];
+		write.pBufferInfo = &buffer_info;
+
+		vkUpdateDescriptorSets(Core::get_device(), 1, &write, 0, 0);
+	}
 
 	_pool_allocations_left--;
 	LOG_STATUS("Created new material: ", name);
@@ -2,6 +2,9 @@
 
 #include "VulkanDataObjects.h"
 #include "SceneObject.h"
+#include "TextureStreamingManager.h"
+#include "ImageImport.h"
+#include <array>
 
 class ObjectMaterial : public NamedObject {
 protected:
@@ -23,15 +26,23 @@ struct MaterialUniformData {
 		albedo(albedo_), metallic(metallic_), roughness(roughness_), has_normal(has_normal_) {}
 };
 
+//what a material reads from its textures, selects the permutation of the solid pipeline
+enum MaterialFeatureBits : uint32_t {
+	MATERIAL_FEATURE_ALBEDO_TEXTURE = 1,
+	MATERIAL_FEATURE_METALLIC_TEXTURE = 2,
+	MATERIAL_FEATURE_ROUGHNESS_TEXTURE = 4,
+	MATERIAL_FEATURE_NORMAL_MAP = 8
+};
+
 class MaterialManager {
 private:
 
 	class Material : public ObjectMaterial {
 	private:
-		VulkanTexture2D _albedo;
-		VulkanTexture2D _metallic;
-		VulkanTexture2D _roughness;
-		VulkanTexture2D _normal;
+		VulkanStreamedTexture2D _albedo;
+		VulkanStreamedTexture2D _metallic;
+		VulkanStreamedTexture2D _roughness;
+		VulkanStreamedTexture2D _normal;
 
 		MaterialUniformData _ubo_data;
 		bool _has_changed = false;
@@ -39,6 +50,20 @@ private:
 
 	private:
 		void initialize_uniform_buffer() const noexcept;
+
+		//albedo, metallic, roughness and normal decoded on the thread pool at the same time
+		static std::array<DecodedImage, 4> decode_textures(const char* albedo,
+			const char* metallic,
+			const char* roughness,
+			const char* normal) noexcept;
+
+		Material(const std::string& name,
+			int32_t material_index, const VulkanBuffer& material_ubo,
+			const char* albedo,
+			const char* metallic,
+			const char* roughness,
+			const char* normal,
+			const std::array<DecodedImage, 4>& images) noexcept;
 	public:
 		Material(const std::string& name,
 		int32_t material_index, const VulkanBuffer& material_ubo,
@@ -56,15 +81,20 @@ private:
 		Material(Material&& material) noexcept;
 
 		inline MaterialUniformData get_uniform_data() const noexcept { return _ubo_data; }
+		uint32_t get_features() const noexcept;
 		inline ObjectMaterial get_object_material() const noexcept { return ObjectMaterial(_name, _material_index); }
 
 		void show_gui_info() noexcept;
 		void update_uniform_buffer(VkCommandBuffer command_buffer) noexcept;
+		//rewrite the textures of the current frame set when their mips changed
+		void update_texture_descriptors(VkDescriptorSet descriptor_set) noexcept;
+		void report_usage(float screen_size) noexcept;
 
 		std::vector<VkDescriptorImageInfo> get_info();
 	};
 
 	std::vector<Material*> _materials;
+	//a set per frame in flight for every material, so streamed textures can be rewritten safely
 	std::vector<VkDescriptorSet> _descriptor_sets;
 	std::vector<VkDescriptorPool> _descriptor_pools;
 	VkDescriptorSetLayout _descriptor_set_layout;
@@ -90,7 +120,16 @@ public:
 		float metallic,
 		float roughness);
 
-	inline VkDescriptorSet get_material_descriptor(Model* model) const noexcept {	return _descriptor_sets[model->get_material_index()]; }
+	inline VkDescriptorSet get_material_descriptor(Model* model) const noexcept {
+		return _descriptor_sets[model->get_material_index() * Core::get_swapchain_image_count() + Core::get_current_frame()];
+	}
+	inline void report_material_usage(int32_t material_index, float screen_size) noexcept {
+		if (material_index >= 0) {
+			_materials[material_index]->report_usage(screen_size);
+		}
+	}
+	inline uint32_t get_material_count() const noexcept { return _materials.size(); }
+	inline uint32_t get_material_features(uint32_t material_index) const noexcept { return _materials[material_index]->get_features(); }
 	inline VkDescriptorSetLayout get_descriptor_set_layout() const noexcept { return _descriptor_set_layout; }
 	static std::vector<VkDescriptorSetLayoutBinding> get_bindings();
 	
@@ -0,0 +1,212 @@
+#include "ShaderManager.h"
+#include "ThreadPool.h"
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+const std::string shader_directory = std::string(RENDERER_DIRECTORY) + "/shaders";
+
+constexpr float SHADER_POLL_INTERVAL = 500.f;//ms
+
+ShaderManager::ShaderManager() : _compiler(find_compiler()) {
+	assert(shader_manager_ptr == nullptr && "There can be only one ShaderManager.");
+	shader_manager_ptr = this;
+	LOG_STATUS("Created ShaderManager, compiler: ", _compiler);
+}
+
+ShaderManager::~ShaderManager() {
+	for (auto& shader : _shaders) {
+		if (shader.compilation.valid()) {
+			shader.compilation.wait();
+		}
+	}
+	release_retired_pipelines(true);
+	shader_manager_ptr = nullptr;
+}
+
+std::string ShaderManager::find_compiler() {
+	//glslc comes with the Vulkan SDK
+	const char* sdk = std::getenv("VULKAN_SDK");
+	if (sdk != nullptr) {
+#ifdef _WIN32
+		fs::path compiler = fs::path(sdk) / "Bin" / "glslc.exe";
+#else
+		fs::path compiler = fs::path(sdk) / "bin" / "glslc";
+#endif
+		std::error_code error;
+		if (fs::exists(compiler, error)) {
+			return compiler.string();
+		}
+	}
+	return "glslc";
+}
+
+std::string ShaderManager::find_source_path(const std::string& spv_path) {
+	const std::string name = fs::path(spv_path).stem().string();
+	std::error_code error;
+	for (const char* stage : { "vert", "frag", "comp" }) {
+		const std::string suffix = std::string("_") + stage;
+		if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+			return shader_directory + "/" + name.substr(0, name.size() - suffix.size()) + "." + stage;
+		}
+	}
+	for (const char* stage : { "vert", "frag", "comp" }) {
+		std::string source_path = shader_directory + "/" + name + "." + stage;
+		if (fs::exists(source_path, error)) {
+			return source_path;
+		}
+	}
+	return "";
+}
+
+bool ShaderManager::compile(const std::string& compiler, const std::string& source_path, const std::string& spv_path) {
+	//written aside and renamed, a pipeline created meanwhile never reads a partial file
+	const std::string temporary_path = spv_path + ".tmp";
+	const std::string command = "\"" + compiler + "\" \"" + source_path + "\" -o \"" + temporary_path + "\"";
+#ifdef _WIN32
+	//cmd strips the outer quotes of the command
+	const int result = std::system(("\"" + command + "\"").c_str());
+#else
+	const int result = std::system(command.c_str());
+#endif
+	std::error_code error;
+	if (result != 0) {
+		fs::remove(temporary_path, error);
+		return false;
+	}
+	fs::rename(temporary_path, spv_path, error);
+	return !error;
+}
+
+uint32_t ShaderManager::subscribe(const std::vector<std::string>& spv_paths, const std::function<void()>& reload) {
+	ShaderManager& manager = *shader_manager_ptr;
+	std::lock_guard<std::mutex> lock(manager._mutex);
+
+	std::error_code error;
+	for (const auto& spv_path : spv_paths) {
+		auto it = std::find_if(manager._shaders.begin(), manager._shaders.end(),
+			[&spv_path](const WatchedShader& shader) { return shader.spv_path == spv_path; });
+		if (it != manager._shaders.end()) {
+			continue;
+		}
+
+		WatchedShader shader;
+		shader.spv_path = spv_path;
+		shader.source_path = find_source_path(spv_path);
+		if (shader.source_path.empty() || !fs::exists(shader.source_path, error)) {
+			LOG_WARNING("No GLSL source found for ", spv_path, ", it is not reloaded.");
+			continue;
+		}
+		shader.last_write_time = fs::last_write_time(shader.source_path, error);
+		manager._shaders.push_back(std::move(shader));
+	}
+
+	const uint32_t id = manager._next_subscription_id++;
+	manager._subscriptions.push_back(Subscription{ id, spv_paths, reload });
+	return id;
+}
+
+void ShaderManager::unsubscribe(uint32_t id) noexcept {
+	ShaderManager& manager = *shader_manager_ptr;
+	std::lock_guard<std::mutex> lock(manager._mutex);
+	auto it = std::remove_if(manager._subscriptions.begin(), manager._subscriptions.end(),
+		[id](const Subscription& subscription) { return subscription.id == id; });
+	manager._subscriptions.erase(it, manager._subscriptions.end());
+}
+
+void ShaderManager::retire(VkPipeline pipeline) noexcept {
+	ShaderManager& manager = *shader_manager_ptr;
+	std::lock_guard<std::mutex> lock(manager._mutex);
+	manager._retired_pipelines.push_back(RetiredPipeline{ pipeline, manager._frame });
+}
+
+void ShaderManager::update(float delta_time) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_frame++;
+	}
+	release_retired_pipelines(false);
+	finish_compilations();
+
+	_time_since_poll += delta_time;
+	if (_time_since_poll >= SHADER_POLL_INTERVAL) {
+		_time_since_poll = 0.f;
+		poll_sources();
+	}
+}
+
+void ShaderManager::poll_sources() noexcept {
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::error_code error;
+	for (auto& shader : _shaders) {
+		if (shader.compilation.valid()) {
+			continue;
+		}
+		auto write_time = fs::last_write_time(shader.source_path, error);
+		if (error || write_time == shader.last_write_time) {
+			continue;
+		}
+		shader.last_write_time = write_time;
+		LOG_STATUS("Recompiling ", shader.source_path);
+		shader.compilation = ThreadPool::submit(
+			[compiler = _compiler, source_path = shader.source_path, spv_path = shader.spv_path] {
+				return compile(compiler, source_path, spv_path);
+			});
+	}
+}
+
+void ShaderManager::finish_compilations() {
+	std::vector<std::string> compiled;
+	std::vector<std::function<void()>> reloads;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& shader : _shaders) {
+			if (!shader.compilation.valid() ||
+				shader.compilation.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				continue;
+			}
+			if (shader.compilation.get()) {
+				compiled.push_back(shader.spv_path);
+			}
+			else {
+				//the old pipelines stay until the source compiles again
+				LOG_WARNING("Failed to compile ", shader.source_path);
+			}
+		}
+		if (compiled.empty()) {
+			return;
+		}
+
+		for (const auto& subscription : _subscriptions) {
+			bool is_dependent = std::any_of(subscription.spv_paths.begin(), subscription.spv_paths.end(),
+				[&compiled](const std::string& spv_path) {
+					return std::find(compiled.begin(), compiled.end(), spv_path) != compiled.end();
+				});
+			if (is_dependent) {
+				reloads.push_back(subscription.reload);
+			}
+		}
+	}
+
+	//the reloads retire pipelines, they run without the lock
+	for (const auto& reload : reloads) {
+		reload();
+	}
+	LOG_STATUS("Reloaded ", compiled.size(), " shaders, rebuilt ", reloads.size(), " renderers.");
+}
+
+void ShaderManager::release_retired_pipelines(bool release_all) noexcept {
+	std::lock_guard<std::mutex> lock(_mutex);
+	const uint64_t frames_in_flight = Core::get_swapchain_image_count();
+	auto it = std::remove_if(_retired_pipelines.begin(), _retired_pipelines.end(),
+		[this, frames_in_flight, release_all](const RetiredPipeline& retired) {
+			if (!release_all && _frame - retired.frame <= frames_in_flight) {
+				return false;
+			}
+			vkDestroyPipeline(Core::get_device(), retired.pipeline, nullptr);
+			return true;
+		});
+	_retired_pipelines.erase(it, _retired_pipelines.end());
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Core.h"
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+
+//pipeline replaced by a reload, destroyed when no frame in flight can use it
+struct RetiredPipeline {
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	uint64_t frame = 0;
+};
+
+//watches the GLSL sources of the loaded SPIR-V, recompiles the changed ones with glslc
+//on the thread pool and lets the renderers using them rebuild their pipelines between frames
+class ShaderManager {
+private:
+	struct WatchedShader {
+		std::string spv_path;
+		std::string source_path;
+		std::filesystem::file_time_type last_write_time;
+		//true if the compilation succeeded
+		std::future<bool> compilation;
+	};
+
+	struct Subscription {
+		uint32_t id;
+		std::vector<std::string> spv_paths;
+		std::function<void()> reload;
+	};
+
+	std::string _compiler;
+	std::vector<WatchedShader> _shaders;
+	std::vector<Subscription> _subscriptions;
+	std::vector<RetiredPipeline> _retired_pipelines;
+	//renderers subscribe while the render units are built on the thread pool
+	std::mutex _mutex;
+
+	uint32_t _next_subscription_id = 1;
+	uint64_t _frame = 0;
+	float _time_since_poll = 0.f;
+
+	static inline ShaderManager* shader_manager_ptr = nullptr;
+
+private:
+	static std::string find_compiler();
+	//shaders/name.stage for shaders/spir-v/name_stage.spv or shaders/spir-v/name.spv
+	static std::string find_source_path(const std::string& spv_path);
+	static bool compile(const std::string& compiler, const std::string& source_path, const std::string& spv_path);
+
+	void poll_sources() noexcept;
+	void finish_compilations();
+	void release_retired_pipelines(bool release_all) noexcept;
+
+public:
+	ShaderManager();
+
+	//reload is called on the main thread after any of the shaders has been recompiled,
+	//returns the id to unsubscribe with
+	static uint32_t subscribe(const std::vector<std::string>& spv_paths, const std::function<void()>& reload);
+	static void unsubscribe(uint32_t id) noexcept;
+	//the pipeline may still be used by the recorded frames
+	static void retire(VkPipeline pipeline) noexcept;
+
+	//call between frames
+	void update(float delta_time);
+
+	~ShaderManager();
+};
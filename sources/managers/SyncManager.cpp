@@ -40,6 +40,11 @@ CurrentFrameSync SyncManager::get_current_frame_sync_objects() noexcept {
 	sync.fence = _fences[current_frame];
 	sync.semaphore_to_render = _semaphores_to_render[current_frame];
 
+	//headless frames are neither acquired nor presented, only the fence is used
+	if (Core::is_headless()) {
+		return sync;
+	}
+
 	sync.present_image_semaphores = { _semaphores_to_present[current_frame] };
 	sync.signal_submit_semaphores = { _semaphores_to_present[current_frame] };
 
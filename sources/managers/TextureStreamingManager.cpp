@@ -0,0 +1,558 @@
+#include "TextureStreamingManager.h"
+#include "CommandManager.h"
+#include "ImageImport.h"
+#include "FrameStatistics.h"
+#include "CpuProfiler.h"
+#include <cmath>
+#include <algorithm>
+
+//mips not larger than this are loaded with the texture and never evicted
+constexpr uint32_t MIP_TAIL_SIZE = 128;
+//part of the free video memory the streamer is allowed to use
+constexpr float STREAMING_BUDGET_FRACTION = 0.8f;
+constexpr uint32_t TEXEL_SIZE = 4;
+
+TextureStreamingManager* TextureStreamingManager::streaming_manager_ptr = nullptr;
+
+static inline uint32_t mip_extent(uint32_t extent, uint32_t mip) noexcept {
+	return std::max(1u, extent >> mip);
+}
+
+static float srgb_to_linear(uint8_t value) noexcept {
+	float c = value / 255.f;
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static uint8_t linear_to_srgb(float c) noexcept {
+	c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.f / 2.4f) - 0.055f;
+	return static_cast<uint8_t>(std::clamp(c, 0.f, 1.f) * 255.f + 0.5f);
+}
+
+//2x2 box filter, color channels of srgb images are averaged in linear space
+static void downsample(const uint8_t* src, uint32_t src_width, uint32_t src_height, uint8_t* dst, bool is_srgb) noexcept {
+	static float srgb_table[256];
+	static const bool is_table_filled = [] {
+		for (uint32_t i = 0; i < 256; i++) {
+			srgb_table[i] = srgb_to_linear(static_cast<uint8_t>(i));
+		}
+		return true;
+	}();
+
+	const uint32_t dst_width = mip_extent(src_width, 1);
+	const uint32_t dst_height = mip_extent(src_height, 1);
+	for (uint32_t y = 0; y < dst_height; y++) {
+		const uint32_t y0 = std::min(y * 2, src_height - 1);
+		const uint32_t y1 = std::min(y * 2 + 1, src_height - 1);
+		for (uint32_t x = 0; x < dst_width; x++) {
+			const uint32_t x0 = std::min(x * 2, src_width - 1);
+			const uint32_t x1 = std::min(x * 2 + 1, src_width - 1);
+			const uint8_t* texels[4] = {
+				src + (y0 * src_width + x0) * TEXEL_SIZE,
+				src + (y0 * src_width + x1) * TEXEL_SIZE,
+				src + (y1 * src_width + x0) * TEXEL_SIZE,
+				src + (y1 * src_width + x1) * TEXEL_SIZE
+			};
+			uint8_t* out = dst + (y * dst_width + x) * TEXEL_SIZE;
+			for (uint32_t c = 0; c < TEXEL_SIZE; c++) {
+				if (is_srgb && c < 3) {
+					float sum = 0.f;
+					for (const uint8_t* texel : texels) {
+						sum += srgb_table[texel[c]];
+					}
+					out[c] = linear_to_srgb(sum * 0.25f);
+				}
+				else {
+					uint32_t sum = 2;
+					for (const uint8_t* texel : texels) {
+						sum += texel[c];
+					}
+					out[c] = static_cast<uint8_t>(sum / 4);
+				}
+			}
+		}
+	}
+}
+
+//build mips [first_mip, last_mip) of the decoded image and pack them one after another
+static void build_mips(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t first_mip, uint32_t last_mip, bool is_srgb,
+	std::vector<uint8_t>& data, std::vector<VkDeviceSize>& offsets) {
+	std::vector<uint8_t> previous(pixels, pixels + static_cast<size_t>(width) * height * TEXEL_SIZE);
+	std::vector<uint8_t> current;
+
+	offsets.clear();
+	data.clear();
+	for (uint32_t mip = 0; mip < last_mip; mip++) {
+		if (mip > 0) {
+			current.resize(static_cast<size_t>(mip_extent(width, mip)) * mip_extent(height, mip) * TEXEL_SIZE);
+			downsample(previous.data(), mip_extent(width, mip - 1), mip_extent(height, mip - 1), current.data(), is_srgb);
+			previous.swap(current);
+		}
+		if (mip >= first_mip) {
+			offsets.push_back(data.size());
+			data.insert(data.end(), previous.begin(), previous.end());
+		}
+	}
+}
+
+static void image_barrier(VkCommandBuffer command_buffer, VkImage image,
+	VkImageLayout old_layout, VkImageLayout new_layout,
+	uint32_t base_mip, uint32_t mip_count,
+	VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage,
+	VkAccessFlags src_access, VkAccessFlags dst_access) noexcept {
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = src_access;
+	barrier.dstAccessMask = dst_access;
+	barrier.image = image;
+	barrier.oldLayout = old_layout;
+	barrier.newLayout = new_layout;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.baseMipLevel = base_mip;
+	barrier.subresourceRange.levelCount = mip_count;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, 0, 0, 0, 1, &barrier);
+}
+
+//
+//
+//VulkanStreamedTexture2D
+//
+//
+
+VulkanStreamedTexture2D::VulkanStreamedTexture2D() noexcept : VulkanTexture2D() {}
+
+VulkanStreamedTexture2D::VulkanStreamedTexture2D(VkFormat format, const char* filename) noexcept :
+	VulkanStreamedTexture2D(format, filename, image_import::decode(filename, false)) {}
+
+VulkanStreamedTexture2D::VulkanStreamedTexture2D(VkFormat format, const char* filename, const DecodedImage& image) noexcept :
+	VulkanTexture2D(), _filename(filename) {
+	_format = format;
+	if (_format != VK_FORMAT_R8G8B8A8_UNORM && _format != VK_FORMAT_R8G8B8A8_SRGB) {
+		LOG_ERROR("Failed to create the streamed texture, unsupported format: ", filename);
+	}
+	LOG_STATUS("Loaded ", filename);
+
+	std::vector<uint8_t> pixels(image.get_texel_count() * TEXEL_SIZE);
+	image_import::convert(image, _format, pixels.data());
+
+	_full_width = image.width;
+	_full_height = image.height;
+	_full_mip_levels = static_cast<uint32_t>(std::floor(std::log2(std::max(_full_width, _full_height)))) + 1;
+	_tail_mip = 0;
+	while (_tail_mip + 1 < _full_mip_levels &&
+		std::max(mip_extent(_full_width, _tail_mip), mip_extent(_full_height, _tail_mip)) > MIP_TAIL_SIZE) {
+		_tail_mip++;
+	}
+	_resident_mip = _full_mip_levels;
+	_requested_mip = _tail_mip;
+
+	std::vector<uint8_t> data;
+	std::vector<VkDeviceSize> offsets;
+	build_mips(pixels.data(), _full_width, _full_height, _tail_mip, _full_mip_levels, _format == VK_FORMAT_R8G8B8A8_SRGB, data, offsets);
+
+	VulkanBuffer staging_buffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, data.size(),
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	memcpy(staging_buffer.map_memory(0, data.size()), data.data(), data.size());
+	staging_buffer.unmap_memory();
+	FrameStatistics::add_upload_bytes(data.size());
+
+	auto cmd = CommandManager::begin_single_command_buffer();
+	change_residency(cmd, _tail_mip, &staging_buffer, offsets);
+	CommandManager::end_single_command_buffer(cmd);
+	//the staging buffer dies with this scope
+	vkQueueWaitIdle(Core::get_graphics_queue());
+
+	create_sampler(VK_LOD_CLAMP_NONE);
+	_id = TextureStreamingManager::register_texture(this);
+}
+
+VulkanStreamedTexture2D::VulkanStreamedTexture2D(VulkanStreamedTexture2D&& texture) noexcept :
+	VulkanTexture2D(std::move(texture)),
+	_filename(std::move(texture._filename)),
+	_id(texture._id),
+	_full_width(texture._full_width),
+	_full_height(texture._full_height),
+	_full_mip_levels(texture._full_mip_levels),
+	_tail_mip(texture._tail_mip),
+	_resident_mip(texture._resident_mip),
+	_requested_mip(texture._requested_mip),
+	_last_used_frame(texture._last_used_frame),
+	_is_pending(texture._is_pending),
+	_is_failed(texture._is_failed),
+	_is_descriptor_written(std::move(texture._is_descriptor_written)) {
+	texture._id = UINT32_MAX;
+	if (_id != UINT32_MAX) {
+		TextureStreamingManager::rebind_texture(_id, this);
+	}
+}
+
+VulkanStreamedTexture2D::~VulkanStreamedTexture2D() {
+	if (_id != UINT32_MAX) {
+		TextureStreamingManager::unregister_texture(_id);
+	}
+}
+
+void VulkanStreamedTexture2D::report_usage(float screen_size) noexcept {
+	if (_id == UINT32_MAX) {
+		return;
+	}
+	//one texel per pixel across the object
+	float ratio = static_cast<float>(std::max(_full_width, _full_height)) / std::max(screen_size, 1.f);
+	uint32_t mip = ratio > 1.f ? static_cast<uint32_t>(std::floor(std::log2(ratio))) : 0;
+	_requested_mip = std::min({ _requested_mip, mip, _tail_mip });
+	_last_used_frame = TextureStreamingManager::get_frame();
+}
+
+VkDeviceSize VulkanStreamedTexture2D::get_mip_chain_size(uint32_t first_mip, uint32_t last_mip) const noexcept {
+	VkDeviceSize size = 0;
+	for (uint32_t mip = first_mip; mip < last_mip; mip++) {
+		size += static_cast<VkDeviceSize>(mip_extent(_full_width, mip)) * mip_extent(_full_height, mip) * TEXEL_SIZE;
+	}
+	return size;
+}
+
+RetiredTextureResources VulkanStreamedTexture2D::change_residency(VkCommandBuffer command_buffer, uint32_t new_mip,
+	const VulkanBuffer* staging_buffer, const std::vector<VkDeviceSize>& offsets) noexcept {
+	RetiredTextureResources retired{ _image, _memory, _image_view, nullptr, 0 };
+	const uint32_t old_mip = _resident_mip;
+	const uint32_t old_levels = _full_mip_levels - old_mip;
+	const uint32_t new_levels = _full_mip_levels - new_mip;
+
+	VulkanImageCreateInfo image_create_info{};
+	image_create_info.width = mip_extent(_full_width, new_mip);
+	image_create_info.height = mip_extent(_full_height, new_mip);
+	image_create_info.mip_levels = new_levels;
+	image_create_info.memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	image_create_info.array_layers = 1;
+	image_create_info.format = _format;
+	image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+	image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	_image = create_image(image_create_info);
+	_width = image_create_info.width;
+	_height = image_create_info.height;
+
+	image_barrier(command_buffer, _image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, new_levels,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_NONE, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+	//copy the mips both images have
+	if (retired.image != VK_NULL_HANDLE) {
+		const uint32_t first_kept_mip = std::max(old_mip, new_mip);
+		const uint32_t src_base = first_kept_mip - old_mip;
+		const uint32_t kept_levels = _full_mip_levels - first_kept_mip;
+
+		image_barrier(command_buffer, retired.image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			src_base, kept_levels,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+		std::vector<VkImageCopy> regions(kept_levels);
+		for (uint32_t i = 0; i < kept_levels; i++) {
+			const uint32_t mip = first_kept_mip + i;
+			regions[i].srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - old_mip, 0, 1 };
+			regions[i].dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - new_mip, 0, 1 };
+			regions[i].extent = { mip_extent(_full_width, mip), mip_extent(_full_height, mip), 1 };
+		}
+		vkCmdCopyImage(command_buffer,
+			retired.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			regions.size(), regions.data());
+
+		//earlier frames may still sample the old image
+		image_barrier(command_buffer, retired.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			src_base, kept_levels,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+	}
+
+	//upload the new finer mips
+	if (staging_buffer != nullptr && new_mip < old_mip) {
+		std::vector<VkBufferImageCopy> regions(old_mip - new_mip);
+		for (uint32_t i = 0; i < regions.size(); i++) {
+			const uint32_t mip = new_mip + i;
+			regions[i].bufferOffset = offsets[i];
+			regions[i].imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 };
+			regions[i].imageExtent = { mip_extent(_full_width, mip), mip_extent(_full_height, mip), 1 };
+		}
+		CommandManager::copy_buffer_to_image(command_buffer, *staging_buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions);
+	}
+
+	image_barrier(command_buffer, _image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, new_levels,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+	VulkanImageViewCreateInfo image_view_create_info{};
+	image_view_create_info.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	image_view_create_info.layer_count = 1;
+	image_view_create_info.mip_level_count = new_levels;
+	image_view_create_info.type = VK_IMAGE_VIEW_TYPE_2D;
+	_image_view = create_image_view(_image, _format, image_view_create_info);
+
+	_resident_mip = new_mip;
+	std::fill(_is_descriptor_written.begin(), _is_descriptor_written.end(), false);
+
+	return retired;
+}
+
+//
+//
+//TextureStreamingManager
+//
+//
+
+TextureStreamingManager::TextureStreamingManager() {
+	assert(streaming_manager_ptr == nullptr && "There can be only one TextureStreamingManager.");
+	streaming_manager_ptr = this;
+
+	_worker = std::thread(&TextureStreamingManager::worker_loop, this);
+	LOG_STATUS("Created TextureStreamingManager.");
+}
+
+uint32_t TextureStreamingManager::register_texture(VulkanStreamedTexture2D* texture) noexcept {
+	uint32_t id = streaming_manager_ptr->_next_texture_id++;
+	streaming_manager_ptr->_textures[id] = texture;
+	streaming_manager_ptr->_resident_bytes += texture->get_resident_size();
+	return id;
+}
+
+void TextureStreamingManager::rebind_texture(uint32_t id, VulkanStreamedTexture2D* texture) noexcept {
+	streaming_manager_ptr->_textures[id] = texture;
+}
+
+void TextureStreamingManager::unregister_texture(uint32_t id) noexcept {
+	auto it = streaming_manager_ptr->_textures.find(id);
+	if (it != streaming_manager_ptr->_textures.end()) {
+		streaming_manager_ptr->_resident_bytes -= it->second->get_resident_size();
+		streaming_manager_ptr->_textures.erase(it);
+	}
+}
+
+void TextureStreamingManager::worker_loop() noexcept {
+	while (true) {
+		StreamRequest request;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this] { return !_requests.empty() || !_is_running; });
+			if (!_is_running) {
+				return;
+			}
+			request = std::move(_requests.front());
+			_requests.pop_front();
+		}
+
+		PROFILE_SCOPE("TextureStreamingManager::stream_mips");
+		StreamResult result{ request.texture_id, request.first_mip, request.last_mip, request.size };
+		DecodedImage image;
+		std::vector<uint8_t> pixels;
+		if (image_import::try_decode(request.filename, false, image)) {
+			pixels.resize(image.get_texel_count() * TEXEL_SIZE);
+			result.is_failed = !image_import::try_convert(image, request.format, pixels.data());
+		}
+		else {
+			result.is_failed = true;
+		}
+		if (result.is_failed) {
+			LOG_WARNING("Failed to stream ", request.filename, ", the request is dropped.");
+		}
+		else {
+			build_mips(pixels.data(), image.width, image.height, request.first_mip, request.last_mip,
+				request.format == VK_FORMAT_R8G8B8A8_SRGB, result.data, result.offsets);
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_results.push_back(std::move(result));
+	}
+}
+
+void TextureStreamingManager::update(VkCommandBuffer command_buffer) noexcept {
+	PROFILE_SCOPE("TextureStreamingManager::update");
+	_frame++;
+	release_retired_resources(false);
+
+	apply_results(command_buffer);
+
+	VkDeviceSize budget = query_budget();
+	evict_least_recently_used(command_buffer, budget);
+	request_mips(budget);
+
+	_statistics.resident_bytes = _resident_bytes;
+	_statistics.budget_bytes = budget;
+	_statistics.textures = _textures.size();
+}
+
+void TextureStreamingManager::apply_results(VkCommandBuffer command_buffer) noexcept {
+	std::deque<StreamResult> results;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		results.swap(_results);
+	}
+
+	for (StreamResult& result : results) {
+		_statistics.pending_requests--;
+		_pending_bytes -= result.size;
+		auto it = _textures.find(result.texture_id);
+		if (it == _textures.end()) {
+			continue;
+		}
+		VulkanStreamedTexture2D* texture = it->second;
+		texture->_is_pending = false;
+		texture->_is_failed |= result.is_failed;
+
+		//the texture lost mips while the request was in flight
+		if (result.data.empty() || result.last_mip != texture->_resident_mip) {
+			continue;
+		}
+
+		VulkanBuffer* staging_buffer = new VulkanBuffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, result.data.size(),
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		memcpy(staging_buffer->map_memory(0, result.data.size()), result.data.data(), result.data.size());
+		staging_buffer->unmap_memory();
+		FrameStatistics::add_upload_bytes(result.data.size());
+
+		VkDeviceSize old_size = texture->get_resident_size();
+		RetiredTextureResources retired = texture->change_residency(command_buffer, result.first_mip, staging_buffer, result.offsets);
+		retired.staging_buffer = staging_buffer;
+		retired.frame = _frame;
+		_retired_resources.push_back(retired);
+
+		_resident_bytes += texture->get_resident_size() - old_size;
+		_statistics.streamed_mips += result.last_mip - result.first_mip;
+	}
+}
+
+void TextureStreamingManager::evict_least_recently_used(VkCommandBuffer command_buffer, VkDeviceSize budget) noexcept {
+	while (_resident_bytes > budget) {
+		VulkanStreamedTexture2D* victim = nullptr;
+		for (auto& [id, texture] : _textures) {
+			if (texture->_resident_mip >= texture->_tail_mip || texture->_is_pending) {
+				continue;
+			}
+			//the usage is reported while the frame is recorded, after the update of its frame,
+			//evicting a texture of the last recorded frame would stream it back right away
+			if (texture->_last_used_frame + 1 >= _frame) {
+				continue;
+			}
+			if (victim == nullptr || texture->_last_used_frame < victim->_last_used_frame ||
+				(texture->_last_used_frame == victim->_last_used_frame && texture->get_resident_size() > victim->get_resident_size())) {
+				victim = texture;
+			}
+		}
+		if (victim == nullptr) {
+			//everything left is in use, stay over the budget until the textures go out of view
+			if (!_is_over_budget) {
+				LOG_WARNING("Texture streaming exceeds the budget by ", _resident_bytes - budget, " bytes, the resident textures are in use.");
+				_is_over_budget = true;
+			}
+			return;
+		}
+
+		//drop the finest resident mip
+		VkDeviceSize old_size = victim->get_resident_size();
+		RetiredTextureResources retired = victim->change_residency(command_buffer, victim->_resident_mip + 1, nullptr, {});
+		retired.frame = _frame;
+		_retired_resources.push_back(retired);
+
+		_resident_bytes -= old_size - victim->get_resident_size();
+		_statistics.evicted_mips++;
+	}
+	_is_over_budget = false;
+}
+
+void TextureStreamingManager::request_mips(VkDeviceSize budget) noexcept {
+	bool has_new_requests = false;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& [id, texture] : _textures) {
+			const uint32_t requested_mip = texture->_requested_mip;
+			texture->_requested_mip = texture->_tail_mip;
+			if (texture->_is_pending || texture->_is_failed || requested_mip >= texture->_resident_mip) {
+				continue;
+			}
+
+			//stream everything at once when it fits, else only the next mip
+			uint32_t first_mip = requested_mip;
+			VkDeviceSize size = texture->get_mip_chain_size(first_mip, texture->_resident_mip);
+			if (_resident_bytes + _pending_bytes + size > budget) {
+				first_mip = texture->_resident_mip - 1;
+				size = texture->get_mip_chain_size(first_mip, texture->_resident_mip);
+				if (_resident_bytes + _pending_bytes + size > budget) {
+					continue;
+				}
+			}
+
+			_requests.push_back(StreamRequest{ id, texture->_filename, texture->_format, first_mip, texture->_resident_mip, size });
+			texture->_is_pending = true;
+			_pending_bytes += size;
+			_statistics.pending_requests++;
+			has_new_requests = true;
+		}
+	}
+	if (has_new_requests) {
+		_condition.notify_one();
+	}
+}
+
+VkDeviceSize TextureStreamingManager::query_budget() const noexcept {
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties{};
+	budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+	VkPhysicalDeviceMemoryProperties2 memory_properties{};
+	memory_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	memory_properties.pNext = Core::is_memory_budget_supported() ? &budget_properties : nullptr;
+	vkGetPhysicalDeviceMemoryProperties2(Core::get_physical_device(), &memory_properties);
+
+	VkDeviceSize budget = 0;
+	for (uint32_t i = 0; i < memory_properties.memoryProperties.memoryHeapCount; i++) {
+		const VkMemoryHeap& heap = memory_properties.memoryProperties.memoryHeaps[i];
+		if (!(heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) {
+			continue;
+		}
+		if (Core::is_memory_budget_supported()) {
+			//usage already includes the resident mips
+			VkDeviceSize available = budget_properties.heapBudget[i] > budget_properties.heapUsage[i] ?
+				budget_properties.heapBudget[i] - budget_properties.heapUsage[i] : 0;
+			budget = std::max(budget, static_cast<VkDeviceSize>(available * STREAMING_BUDGET_FRACTION));
+		}
+		else {
+			//without the extension other allocations are unknown, take half of the heap
+			budget = std::max(budget, static_cast<VkDeviceSize>(heap.size * STREAMING_BUDGET_FRACTION * 0.5f));
+		}
+	}
+	//the budget is soft, textures used by the last recorded frame are never evicted,
+	//so the resident mips can exceed it while they are in view, a warning is logged then
+	if (Core::is_memory_budget_supported()) {
+		budget += _resident_bytes;
+	}
+	return budget;
+}
+
+void TextureStreamingManager::release_retired_resources(bool release_all) noexcept {
+	const uint64_t frames_in_flight = Core::get_swapchain_image_count();
+	auto it = std::remove_if(_retired_resources.begin(), _retired_resources.end(),
+		[this, frames_in_flight, release_all](RetiredTextureResources& resources) {
+			if (!release_all && _frame - resources.frame <= frames_in_flight) {
+				return false;
+			}
+			vkDestroyImageView(Core::get_device(), resources.image_view, nullptr);
+			vkDestroyImage(Core::get_device(), resources.image, nullptr);
+			vkFreeMemory(Core::get_device(), resources.memory, nullptr);
+			delete resources.staging_buffer;
+			return true;
+		});
+	_retired_resources.erase(it, _retired_resources.end());
+}
+
+TextureStreamingManager::~TextureStreamingManager() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_is_running = false;
+	}
+	_condition.notify_all();
+	_worker.join();
+
+	release_retired_resources(true);
+	streaming_manager_ptr = nullptr;
+}
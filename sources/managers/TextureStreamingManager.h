@@ -0,0 +1,142 @@
+#pragma once
+
+#include "VulkanDataObjects.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+
+//resources of a replaced image, destroyed when no frame in flight can use them
+struct RetiredTextureResources {
+	VkImage image = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkImageView image_view = VK_NULL_HANDLE;
+	VulkanBuffer* staging_buffer = nullptr;
+	uint64_t frame = 0;
+};
+
+//RGBA8 texture which keeps only the needed part of its mip chain in video memory,
+//mips smaller than the tail size are always resident
+class VulkanStreamedTexture2D : public VulkanTexture2D {
+private:
+	std::string _filename;
+	uint32_t _id = UINT32_MAX;
+
+	uint32_t _full_width = 0;
+	uint32_t _full_height = 0;
+	uint32_t _full_mip_levels = 1;
+	uint32_t _tail_mip = 0;
+	//mip of the full chain stored in the level 0 of the image
+	uint32_t _resident_mip = 0;
+	//the finest mip requested by the draws since the last update
+	uint32_t _requested_mip = 0;
+	uint64_t _last_used_frame = 0;
+	bool _is_pending = false;
+	//the file failed to stream, the resident mips stay
+	bool _is_failed = false;
+
+	std::vector<bool> _is_descriptor_written = std::vector<bool>(Core::get_swapchain_image_count(), true);
+
+private:
+	//recreate the image with mips [new_mip, full), copy the kept mips from the old image
+	//and upload the missing ones from the staging buffer
+	RetiredTextureResources change_residency(VkCommandBuffer command_buffer, uint32_t new_mip,
+		const VulkanBuffer* staging_buffer, const std::vector<VkDeviceSize>& offsets) noexcept;
+
+public:
+	VulkanStreamedTexture2D() noexcept;
+	VulkanStreamedTexture2D(VkFormat format, const char* filename) noexcept;
+	VulkanStreamedTexture2D(VkFormat format, const char* filename, const struct DecodedImage& image) noexcept;
+	VulkanStreamedTexture2D(VulkanStreamedTexture2D&& texture) noexcept;
+
+	//screen_size is the estimated size of the textured object in pixels
+	void report_usage(float screen_size) noexcept;
+
+	VkDeviceSize get_mip_chain_size(uint32_t first_mip, uint32_t last_mip) const noexcept;
+	inline VkDeviceSize get_resident_size() const noexcept { return get_mip_chain_size(_resident_mip, _full_mip_levels); }
+	inline uint32_t get_resident_mip() const noexcept { return _resident_mip; }
+	inline uint32_t get_full_mip_levels() const noexcept { return _full_mip_levels; }
+
+	inline bool is_descriptor_written() const noexcept { return _is_descriptor_written[Core::get_current_frame()]; }
+	inline void set_descriptor_written() noexcept { _is_descriptor_written[Core::get_current_frame()] = true; }
+
+	~VulkanStreamedTexture2D();
+
+	friend class TextureStreamingManager;
+};
+
+struct TextureStreamingStatistics {
+	VkDeviceSize resident_bytes = 0;
+	VkDeviceSize budget_bytes = 0;
+	uint32_t textures = 0;
+	uint32_t pending_requests = 0;
+	uint32_t streamed_mips = 0;
+	uint32_t evicted_mips = 0;
+};
+
+class TextureStreamingManager {
+private:
+	struct StreamRequest {
+		uint32_t texture_id;
+		std::string filename;
+		VkFormat format;
+		uint32_t first_mip;
+		uint32_t last_mip;
+		VkDeviceSize size;
+	};
+
+	struct StreamResult {
+		uint32_t texture_id;
+		uint32_t first_mip;
+		uint32_t last_mip;
+		VkDeviceSize size;
+		std::vector<uint8_t> data;
+		std::vector<VkDeviceSize> offsets;
+		bool is_failed = false;
+	};
+
+	std::unordered_map<uint32_t, VulkanStreamedTexture2D*> _textures;
+	uint32_t _next_texture_id = 0;
+
+	//worker thread decodes files and builds the requested mips
+	std::thread _worker;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::deque<StreamRequest> _requests;
+	std::deque<StreamResult> _results;
+	bool _is_running = true;
+
+	std::vector<RetiredTextureResources> _retired_resources;
+	uint64_t _frame = 0;
+	VkDeviceSize _resident_bytes = 0;
+	VkDeviceSize _pending_bytes = 0;
+	bool _is_over_budget = false;
+
+	TextureStreamingStatistics _statistics;
+
+	static TextureStreamingManager* streaming_manager_ptr;
+
+private:
+	void worker_loop() noexcept;
+	void apply_results(VkCommandBuffer command_buffer) noexcept;
+	void evict_least_recently_used(VkCommandBuffer command_buffer, VkDeviceSize budget) noexcept;
+	void request_mips(VkDeviceSize budget) noexcept;
+	void release_retired_resources(bool release_all) noexcept;
+	VkDeviceSize query_budget() const noexcept;
+
+public:
+	TextureStreamingManager();
+
+	static uint32_t register_texture(VulkanStreamedTexture2D* texture) noexcept;
+	static void rebind_texture(uint32_t id, VulkanStreamedTexture2D* texture) noexcept;
+	static void unregister_texture(uint32_t id) noexcept;
+
+	static inline uint64_t get_frame() noexcept { return streaming_manager_ptr->_frame; }
+	static inline const TextureStreamingStatistics& get_statistics() noexcept { return streaming_manager_ptr->_statistics; }
+
+	//record finished uploads and evictions, must be called after the frame fence
+	void update(VkCommandBuffer command_buffer) noexcept;
+
+	~TextureStreamingManager();
+};
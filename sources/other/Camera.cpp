@@ -67,6 +67,17 @@ void FreeCamera::add_velocity(const glm::vec3& velocity) {
 
 }
 
+void FreeCamera::set_view(const glm::vec3& pos, const glm::vec3& forward) noexcept {
+	_world_pos = pos;
+	_forward = glm::normalize(forward);
+	_right = glm::cross(-camera_up, _forward);
+	_velocity = glm::vec3(0.f);
+
+	//inverse of rotate_camera()
+	_pitch = glm::degrees(asin(glm::clamp(-_forward.y, -1.f, 1.f)));
+	_yaw = glm::degrees(atan2(-_forward.x, _forward.z));
+}
+
 void FreeCamera::rotate_camera(float x_delta, float y_delta) {
 	_yaw += x_delta * _sensetivity;
 	_pitch += y_delta * _sensetivity;
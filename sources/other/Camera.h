@@ -8,6 +8,9 @@ protected:
 	glm::vec3 _forward;
 public:
 	static constexpr glm::vec3 camera_up = glm::vec3(0.f,1.f,0.f);
+	static constexpr float field_of_view = 90.f;
+	static constexpr float near_plane = 0.01f;
+	static constexpr float far_plane = 1000.f;
 
 	CameraBase() : _world_pos(0.0f), _forward(0.0f,0.0f,1.0f) {}
 	CameraBase(const glm::vec3& pos) : _world_pos(pos), _forward(0.0f, 0.0f, 1.0f) {}
@@ -16,6 +19,19 @@ public:
 	inline glm::vec3 get_world_position() const noexcept { return _world_pos; }
 	inline glm::vec3 get_forward_vector() const noexcept { return _forward; }
 	inline glm::mat4 get_view_matrix() const noexcept { return glm::lookAt(_world_pos, _world_pos + _forward, camera_up); }
+	static inline glm::mat4 get_projection_matrix(float aspect) noexcept {
+		glm::mat4 projection = glm::perspective(glm::radians(field_of_view), aspect, near_plane, far_plane);
+		//vulkan -y
+		projection[1][1] *= -1;
+		return projection;
+	}
+	//direction through a point of the screen, ndc x to the right and y down like the window
+	inline glm::vec3 get_ray_direction(const glm::vec2& ndc, float aspect) const noexcept {
+		const glm::vec3 right = glm::normalize(glm::cross(_forward, camera_up));
+		const glm::vec3 up = glm::cross(right, _forward);
+		const float tangent = tan(glm::radians(field_of_view * 0.5f));
+		return glm::normalize(_forward + right * (ndc.x * aspect * tangent) - up * (ndc.y * tangent));
+	}
 
 	virtual ~CameraBase() {}
 };
@@ -46,6 +62,8 @@ public:
 
 	inline glm::vec3 get_right_vector() const noexcept { return _right; }
 
+	//places the camera without the velocity, keeps the yaw and pitch in sync with the forward vector
+	void set_view(const glm::vec3& pos, const glm::vec3& forward) noexcept;
 	void rotate_camera(float x_delta, float y_delta);
 	void add_velocity(const glm::vec3& velocity);
 	void process_position(float delta_time);
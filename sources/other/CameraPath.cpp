@@ -0,0 +1,50 @@
+#include "CameraPath.h"
+#include "Utils.h"
+#include <algorithm>
+
+template<typename T>
+static T catmull_rom(const T& p0, const T& p1, const T& p2, const T& p3, float t) noexcept {
+	const float t2 = t * t;
+	const float t3 = t2 * t;
+	return 0.5f * ((2.f * p1) + (p2 - p0) * t +
+		(2.f * p0 - 5.f * p1 + 4.f * p2 - p3) * t2 +
+		(3.f * p1 - p0 - 3.f * p2 + p3) * t3);
+}
+
+void CameraPath::add_key(const CameraKey& key) {
+	if (!_keys.empty() && key.time <= _keys.back().time) {
+		LOG_WARNING("Camera path keys are not in the time order, the key is skipped.");
+		return;
+	}
+	_keys.push_back(CameraKey{ key.time, key.position, glm::normalize(key.forward) });
+}
+
+CameraKey CameraPath::evaluate(float time) const noexcept {
+	if (_keys.empty()) {
+		return CameraKey{ time, glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f) };
+	}
+	if (time <= _keys.front().time) {
+		return _keys.front();
+	}
+	if (time >= _keys.back().time) {
+		return _keys.back();
+	}
+
+	//the first key after the time
+	const size_t i = std::upper_bound(_keys.begin(), _keys.end(), time,
+		[](float time, const CameraKey& key) { return time < key.time; }) - _keys.begin();
+	const CameraKey& k0 = _keys[i > 1 ? i - 2 : 0];
+	const CameraKey& k1 = _keys[i - 1];
+	const CameraKey& k2 = _keys[i];
+	const CameraKey& k3 = _keys[std::min(i + 1, _keys.size() - 1)];
+	const float t = (time - k1.time) / (k2.time - k1.time);
+
+	return CameraKey{ time,
+		catmull_rom(k0.position, k1.position, k2.position, k3.position, t),
+		glm::normalize(catmull_rom(k0.forward, k1.forward, k2.forward, k3.forward, t)) };
+}
+
+void CameraPath::apply(FreeCamera& camera, float time) const noexcept {
+	const CameraKey key = evaluate(time);
+	camera.set_view(key.position, key.forward);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "Camera.h"
+#include <vector>
+
+struct CameraKey {
+	float time;//ms
+	glm::vec3 position;
+	glm::vec3 forward;
+};
+
+//Catmull-Rom spline through the keys, the camera holds the first and the last key outside of them
+class CameraPath {
+private:
+	std::vector<CameraKey> _keys;
+
+public:
+	CameraPath() noexcept {}
+
+	//keys must be added in the time order
+	void add_key(const CameraKey& key);
+
+	inline bool empty() const noexcept { return _keys.empty(); }
+	inline float get_duration() const noexcept { return _keys.empty() ? 0.f : _keys.back().time; }
+
+	CameraKey evaluate(float time) const noexcept;
+	void apply(FreeCamera& camera, float time) const noexcept;
+};
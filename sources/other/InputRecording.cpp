@@ -0,0 +1,94 @@
+#include "InputRecording.h"
+#include "Utils.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+constexpr char INPUT_RECORDING_MAGIC[4] = { 'E', 'C', 'I', 'R' };
+constexpr uint32_t INPUT_RECORDING_VERSION = 1;
+constexpr size_t INPUT_FRAME_SIZE = sizeof(float) + sizeof(uint8_t) + sizeof(float) * 2 + sizeof(glm::vec3) * 2;
+
+template<typename T>
+static char* write_value(char* dst, const T& value) noexcept {
+	memcpy(dst, &value, sizeof(T));
+	return dst + sizeof(T);
+}
+
+template<typename T>
+static const char* read_value(const char* src, T& value) noexcept {
+	memcpy(&value, src, sizeof(T));
+	return src + sizeof(T);
+}
+
+float InputRecording::get_timestep() const noexcept {
+	if (_frames.empty()) {
+		return 1000.f / 60.f;
+	}
+	double sum = 0.0;
+	for (const InputFrame& frame : _frames) {
+		sum += frame.delta_time;
+	}
+	return static_cast<float>(sum / _frames.size());
+}
+
+bool InputRecording::save(const std::string& filename) const {
+	std::vector<char> data(sizeof(INPUT_RECORDING_MAGIC) + sizeof(uint32_t) * 2 + _frames.size() * INPUT_FRAME_SIZE);
+	char* dst = data.data();
+	memcpy(dst, INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC));
+	dst += sizeof(INPUT_RECORDING_MAGIC);
+	dst = write_value(dst, INPUT_RECORDING_VERSION);
+	dst = write_value(dst, static_cast<uint32_t>(_frames.size()));
+	for (const InputFrame& frame : _frames) {
+		dst = write_value(dst, frame.delta_time);
+		dst = write_value(dst, frame.buttons);
+		dst = write_value(dst, frame.mouse_x_delta);
+		dst = write_value(dst, frame.mouse_y_delta);
+		dst = write_value(dst, frame.position);
+		dst = write_value(dst, frame.forward);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(filename).parent_path(), error);
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.write(data.data(), data.size())) {
+		LOG_WARNING("Failed to write the input recording ", filename);
+		return false;
+	}
+	LOG_STATUS("Saved ", _frames.size(), " input frames to ", filename);
+	return true;
+}
+
+bool InputRecording::load(const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+	std::vector<char> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	if (!file.read(data.data(), data.size())) {
+		return false;
+	}
+
+	const size_t header_size = sizeof(INPUT_RECORDING_MAGIC) + sizeof(uint32_t) * 2;
+	uint32_t version = 0;
+	uint32_t frame_count = 0;
+	if (data.size() < header_size || memcmp(data.data(), INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC)) != 0) {
+		return false;
+	}
+	const char* src = read_value(data.data() + sizeof(INPUT_RECORDING_MAGIC), version);
+	src = read_value(src, frame_count);
+	if (version != INPUT_RECORDING_VERSION || data.size() != header_size + frame_count * INPUT_FRAME_SIZE) {
+		return false;
+	}
+
+	_frames.resize(frame_count);
+	for (InputFrame& frame : _frames) {
+		src = read_value(src, frame.delta_time);
+		src = read_value(src, frame.buttons);
+		src = read_value(src, frame.mouse_x_delta);
+		src = read_value(src, frame.mouse_y_delta);
+		src = read_value(src, frame.position);
+		src = read_value(src, frame.forward);
+	}
+	return true;
+}
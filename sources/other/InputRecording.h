@@ -0,0 +1,46 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+enum InputButtonBits : uint8_t {
+	INPUT_BUTTON_W = 1 << 0,
+	INPUT_BUTTON_A = 1 << 1,
+	INPUT_BUTTON_S = 1 << 2,
+	INPUT_BUTTON_D = 1 << 3,
+	INPUT_BUTTON_SPACE = 1 << 4,
+	INPUT_BUTTON_CTRL = 1 << 5,
+	INPUT_BUTTON_MIDDLE = 1 << 6
+};
+
+//input of a frame and the camera transform after it is applied
+struct InputFrame {
+	float delta_time;//ms
+	uint8_t buttons;
+	//cursor movement while rotating
+	float mouse_x_delta;
+	float mouse_y_delta;
+	glm::vec3 position;
+	glm::vec3 forward;
+};
+
+//frames are stored packed after a small header, 37 bytes each
+class InputRecording {
+private:
+	std::vector<InputFrame> _frames;
+
+public:
+	InputRecording() noexcept {}
+
+	inline void add_frame(const InputFrame& frame) { _frames.push_back(frame); }
+	inline void clear() noexcept { _frames.clear(); }
+	inline bool empty() const noexcept { return _frames.empty(); }
+	inline size_t size() const noexcept { return _frames.size(); }
+	inline const InputFrame& operator[](size_t i) const noexcept { return _frames[i]; }
+
+	//mean delta time of the recorded frames
+	float get_timestep() const noexcept;
+
+	bool save(const std::string& filename) const;
+	bool load(const std::string& filename);
+};
@@ -1,4 +1,8 @@
 #include "UserController.h"
+#include "Utils.h"
+#include <chrono>
+
+const std::string recording_directory = std::string(RENDERER_DIRECTORY) + "/traces";
 
 
 
@@ -9,6 +13,10 @@ UserControllerBase::~UserControllerBase() {}
 FreeCameraController::FreeCameraController(const Window& window, FreeCamera& camera) :
 	UserControllerBase(window),
 	_camera(camera){
+	//headless runs have no input
+	if (window.is_headless()) {
+		return;
+	}
 
 	glfwGetCursorPos(_window_context->get_window(), &_last_xpos, &_last_ypos);
 	glfwSetWindowUserPointer(_window_context->get_window(), this);
@@ -29,6 +37,7 @@ FreeCameraController::FreeCameraController(const Window& window, FreeCamera& cam
 			case GLFW_KEY_SPACE: ptr->_is_space_pressed = action == GLFW_PRESS; break;
 			case GLFW_KEY_LEFT_CONTROL:ptr-> _is_ctrl_pressed = action == GLFW_PRESS; break;
 			case GLFW_KEY_ESCAPE: glfwSetWindowShouldClose(window, GLFW_TRUE); break;
+			case GLFW_KEY_F9: if (action == GLFW_PRESS) ptr->toggle_recording(); break;
 			default: break;
 		}
 	});
@@ -42,6 +51,8 @@ FreeCameraController::FreeCameraController(const Window& window, FreeCamera& cam
 			float y_delta = static_cast<float>(ypos - ptr->_last_ypos);
 
 			ptr->_camera.rotate_camera(x_delta, y_delta);
+			ptr->_mouse_x_delta += x_delta;
+			ptr->_mouse_y_delta += y_delta;
 		}
 		ptr->_last_xpos = xpos;
 		ptr->_last_ypos = ypos;
@@ -55,12 +66,93 @@ FreeCameraController::FreeCameraController(const Window& window, FreeCamera& cam
 		switch (button)
 		{
 		case GLFW_MOUSE_BUTTON_MIDDLE: ptr->_is_middle_button_pressed = action == GLFW_PRESS; break;
+		case GLFW_MOUSE_BUTTON_LEFT:
+			if (action == GLFW_PRESS) {
+				int width, height;
+				glfwGetWindowSize(window, &width, &height);
+				if (width > 0 && height > 0) {
+					ptr->_click_ndc = glm::vec2(ptr->_last_xpos / width, ptr->_last_ypos / height) * 2.f - 1.f;
+					ptr->_is_clicked = true;
+				}
+			}
+			break;
 		default: break;
 		}
 	});
 }
 
+FreeCameraController::~FreeCameraController() {
+	stop_recording();
+}
+
+uint8_t FreeCameraController::get_buttons() const noexcept {
+	return (_is_W_pressed ? INPUT_BUTTON_W : 0) |
+		(_is_A_pressed ? INPUT_BUTTON_A : 0) |
+		(_is_S_pressed ? INPUT_BUTTON_S : 0) |
+		(_is_D_pressed ? INPUT_BUTTON_D : 0) |
+		(_is_space_pressed ? INPUT_BUTTON_SPACE : 0) |
+		(_is_ctrl_pressed ? INPUT_BUTTON_CTRL : 0) |
+		(_is_middle_button_pressed ? INPUT_BUTTON_MIDDLE : 0);
+}
+
+void FreeCameraController::start_recording(const std::string& filename) {
+	_recording.clear();
+	_recording_filename = filename;
+	_is_recording = true;
+	LOG_STATUS("Recording the input to ", filename);
+}
+
+bool FreeCameraController::stop_recording() {
+	if (!_is_recording) {
+		return false;
+	}
+	_is_recording = false;
+	return _recording.save(_recording_filename);
+}
+
+void FreeCameraController::toggle_recording() {
+	if (_is_recording) {
+		stop_recording();
+		return;
+	}
+	const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	start_recording(recording_directory + "/input_recording_" + std::to_string(seconds) + ".ecir");
+}
+
+bool FreeCameraController::start_replay(const std::string& filename) {
+	_replay_frame = 0;
+	if (!_replay.load(filename) || _replay.empty()) {
+		_replay.clear();
+		LOG_WARNING("Failed to load the input recording ", filename);
+		return false;
+	}
+	LOG_STATUS("Replaying ", _replay.size(), " input frames from ", filename);
+	return true;
+}
+
+void FreeCameraController::replay_frame() noexcept {
+	if (is_replay_finished()) {
+		return;
+	}
+	const InputFrame& frame = _replay[_replay_frame++];
+	_is_W_pressed = frame.buttons & INPUT_BUTTON_W;
+	_is_A_pressed = frame.buttons & INPUT_BUTTON_A;
+	_is_S_pressed = frame.buttons & INPUT_BUTTON_S;
+	_is_D_pressed = frame.buttons & INPUT_BUTTON_D;
+	_is_space_pressed = frame.buttons & INPUT_BUTTON_SPACE;
+	_is_ctrl_pressed = frame.buttons & INPUT_BUTTON_CTRL;
+	_is_middle_button_pressed = frame.buttons & INPUT_BUTTON_MIDDLE;
+	//the transforms do not drift with the fixed delta time
+	_camera.set_view(frame.position, frame.forward);
+}
+
 void FreeCameraController::process_input(float delta_time) {
+	if (is_replaying()) {
+		replay_frame();
+		return;
+	}
+
 	if (_is_middle_button_pressed) {
 		glm::vec3 velocity = glm::vec3(0.f);
 		if (_is_W_pressed) {
@@ -84,4 +176,11 @@ void FreeCameraController::process_input(float delta_time) {
 		_camera.add_velocity(velocity);
 	}
 	_camera.process_position(delta_time);
+
+	if (_is_recording) {
+		_recording.add_frame(InputFrame{ delta_time, get_buttons(), _mouse_x_delta, _mouse_y_delta,
+			_camera.get_world_position(), _camera.get_forward_vector() });
+	}
+	_mouse_x_delta = 0.f;
+	_mouse_y_delta = 0.f;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Window.h"
 #include "Camera.h"
+#include "InputRecording.h"
 
 class UserControllerBase {
 protected:
@@ -31,11 +32,50 @@ protected:
 
 	double _last_xpos;
 	double _last_ypos;
+	//cursor movement while rotating since the last frame
+	float _mouse_x_delta = 0.f;
+	float _mouse_y_delta = 0.f;
+
+	//left click position in ndc until it is consumed
+	glm::vec2 _click_ndc;
+	bool _is_clicked = false;
+
+	//F9 toggles the recording
+	InputRecording _recording;
+	std::string _recording_filename;
+	bool _is_recording = false;
+
+	InputRecording _replay;
+	size_t _replay_frame = 0;
+
+protected:
+	uint8_t get_buttons() const noexcept;
+	void replay_frame() noexcept;
+	void toggle_recording();
+
 public:
 	FreeCameraController(const Window& window, FreeCamera& camera);
 
 	inline bool is_middle_button_pressed()const noexcept { return _is_middle_button_pressed; }
 	const FreeCamera& get_camera() const noexcept { return _camera; }
+	//returns true once per left click
+	inline bool consume_click(glm::vec2& ndc) noexcept {
+		ndc = _click_ndc;
+		return std::exchange(_is_clicked, false);
+	}
+
+	void start_recording(const std::string& filename);
+	bool stop_recording();
+	inline bool is_recording() const noexcept { return _is_recording; }
+
+	//replaces the user input with the recorded one and the camera with the recorded transforms
+	bool start_replay(const std::string& filename);
+	inline bool is_replaying() const noexcept { return !_replay.empty(); }
+	inline bool is_replay_finished() const noexcept { return _replay_frame >= _replay.size(); }
+	//the fixed delta time of the replay
+	inline float get_replay_timestep() const noexcept { return _replay.get_timestep(); }
 
 	virtual void process_input(float delta_time);
+
+	virtual ~FreeCameraController();
 };
\ No newline at end of file
@@ -2,7 +2,11 @@
 #include <iostream>
 uint32_t Window::_windows_count = 0;
 
-Window::Window(int width, int height, const char* title) {
+Window::Window(int width, int height, const char* title, bool is_headless) :
+	_window(nullptr), _width(width), _height(height) {
+	if (is_headless) {
+		return;
+	}
 	if (_windows_count == 0) {
 		glfwInit();
 	}
@@ -13,6 +17,9 @@ Window::Window(int width, int height, const char* title) {
 }
 
 Window::~Window() {
+	if (_window == nullptr) {
+		return;
+	}
 	_windows_count--;
 	glfwDestroyWindow(_window);
 	if (_windows_count == 0) {
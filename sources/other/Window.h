@@ -1,16 +1,24 @@
 #pragma once
 
 #include <GLFW/glfw3.h>
+#include <cstdint>
 
 class Window{
 private:
 	static uint32_t _windows_count;
 
+	//nullptr if headless
 	GLFWwindow* _window;
+	uint32_t _width;
+	uint32_t _height;
 
 
 public:
-	Window(int width, int height, const char* title);
+	//a headless window only keeps the size, GLFW is not initialized
+	Window(int width, int height, const char* title, bool is_headless = false);
 	~Window();
 	inline GLFWwindow* get_window() const noexcept { return _window; }
+	inline bool is_headless() const noexcept { return _window == nullptr; }
+	inline uint32_t get_width() const noexcept { return _width; }
+	inline uint32_t get_height() const noexcept { return _height; }
 };
\ No newline at end of file
@@ -0,0 +1,513 @@
+#include "EnvironmentLighting.h"
+#include "CommandManager.h"
+#include "PipelineCache.h"
+#include "CpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const std::string equirect_to_cube_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/ibl_equirect_to_cube.spv";
+const std::string prefilter_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/ibl_prefilter.spv";
+const std::string irradiance_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/ibl_irradiance.spv";
+const std::string brdf_lut_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/ibl_brdf_lut.spv";
+
+//storage support is mandatory, texels are packed by 8 bytes in the cache
+constexpr VkFormat IBL_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+constexpr VkDeviceSize IBL_TEXEL_SIZE = 8;
+
+//bake input, not kept after the bake
+constexpr uint32_t ENVIRONMENT_SIZE = 512;
+constexpr uint32_t IRRADIANCE_SIZE = 32;
+//roughness goes from 0 to 1 over the mips
+constexpr uint32_t PREFILTERED_SIZE = 256;
+constexpr uint32_t PREFILTERED_MIP_LEVELS = 6;
+constexpr uint32_t BRDF_LUT_SIZE = 256;
+//must match the ibl compute shaders
+constexpr uint32_t BAKE_GROUP_SIZE = 8;
+
+//bump when the bake shaders change, the cached results are keyed by it
+constexpr uint32_t BAKE_VERSION = 1;
+
+struct BakePushConstants {
+	float roughness;
+	float environment_size;
+};
+
+namespace {
+	uint32_t get_group_count(uint32_t size) noexcept {
+		return (size + BAKE_GROUP_SIZE - 1) / BAKE_GROUP_SIZE;
+	}
+
+	VkPipeline create_compute_pipeline(VkPipelineLayout layout, const char* shader_path) noexcept {
+		VkShaderModule compute_shader = utils::create_shader_module(shader_path);
+
+		VkComputePipelineCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		create_info.layout = layout;
+		create_info.stage = utils::set_pipeline_shader_stage(compute_shader, VK_SHADER_STAGE_COMPUTE_BIT);
+
+		VkPipeline pipeline = PipelineCache::create_compute_pipeline(create_info, "EnvironmentLighting");
+
+		vkDestroyShaderModule(Core::get_device(), compute_shader, nullptr);
+		return pipeline;
+	}
+}
+
+EnvironmentLighting::EnvironmentLighting(const std::string& equirectangular_path) {
+	PROFILE_SCOPE("EnvironmentLighting::EnvironmentLighting");
+	create_images();
+	create_descriptor_tools();
+
+	BakeKey key;
+	key.add_file(equirectangular_path)
+		.add(BAKE_VERSION)
+		.add(IBL_FORMAT)
+		.add(ENVIRONMENT_SIZE)
+		.add(IRRADIANCE_SIZE)
+		.add(PREFILTERED_SIZE)
+		.add(PREFILTERED_MIP_LEVELS)
+		.add(BRDF_LUT_SIZE);
+
+	if (load_cache(key)) {
+		LOG_STATUS("Loaded cached environment lighting of ", equirectangular_path);
+	}
+	else {
+		bake(equirectangular_path, key);
+		LOG_STATUS("Baked environment lighting of ", equirectangular_path);
+	}
+}
+
+EnvironmentLighting::~EnvironmentLighting() {
+	vkDestroyDescriptorPool(Core::get_device(), _descriptor_pool, nullptr);
+	vkDestroyDescriptorSetLayout(Core::get_device(), _descriptor_set_layout, nullptr);
+	vkDestroySampler(Core::get_device(), _sampler, nullptr);
+}
+
+void EnvironmentLighting::create_images() {
+	const uint32_t sizes[3] = { IRRADIANCE_SIZE, PREFILTERED_SIZE, BRDF_LUT_SIZE };
+	const uint32_t mip_levels[3] = { 1, PREFILTERED_MIP_LEVELS, 1 };
+
+	for (uint32_t i = 0; i < _baked_images.size(); i++) {
+		const bool is_cube = i < 2;
+
+		VulkanImageCreateInfo image_create_info{};
+		image_create_info.width = sizes[i];
+		image_create_info.height = sizes[i];
+		image_create_info.format = IBL_FORMAT;
+		image_create_info.array_layers = is_cube ? 6 : 1;
+		image_create_info.mip_levels = mip_levels[i];
+		image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		//written by the bake or copied from the cache, read back to fill the cache
+		image_create_info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		image_create_info.memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		image_create_info.flags = is_cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+
+		VulkanImageViewCreateInfo view_create_info{};
+		view_create_info.type = is_cube ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D;
+		view_create_info.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		view_create_info.layer_count = image_create_info.array_layers;
+		view_create_info.mip_level_count = image_create_info.mip_levels;
+
+		BakedImage& baked = _baked_images[i];
+		baked.image = std::shared_ptr<VulkanImage>(new VulkanImage(image_create_info));
+		baked.image_view = std::shared_ptr<VulkanImageView>(new VulkanImageView(*baked.image, view_create_info));
+		baked.mip_levels = image_create_info.mip_levels;
+		baked.array_layers = image_create_info.array_layers;
+	}
+	LOG_STATUS("Created EnvironmentLighting images.");
+}
+
+void EnvironmentLighting::create_descriptor_tools() {
+	{
+		VkSamplerCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.magFilter = VK_FILTER_LINEAR;
+		create_info.minFilter = VK_FILTER_LINEAR;
+		create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		create_info.maxLod = VK_LOD_CLAMP_NONE;
+		create_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+		VK_ASSERT(vkCreateSampler(Core::get_device(), &create_info, nullptr, &_sampler), "vkCreateSampler(), EnvironmentLighting - FAILED");
+	}
+
+	{
+		auto bindings = get_bindings();
+		VkDescriptorSetLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		create_info.bindingCount = bindings.size();
+		create_info.pBindings = bindings.data();
+		VK_ASSERT(vkCreateDescriptorSetLayout(Core::get_device(), &create_info, nullptr, &_descriptor_set_layout), "vkCreateDescriptorSetLayout(), EnvironmentLighting - FAILED");
+	}
+
+	{
+		VkDescriptorPoolSize pool_size{};
+		pool_size.descriptorCount = _baked_images.size();
+		pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+		VkDescriptorPoolCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		create_info.pPoolSizes = &pool_size;
+		create_info.poolSizeCount = 1;
+		create_info.maxSets = 1;
+		VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &create_info, nullptr, &_descriptor_pool), "vkCreateDescriptorPool(), EnvironmentLighting - FAILED");
+
+		VkDescriptorSetAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		alloc_info.descriptorPool = _descriptor_pool;
+		alloc_info.descriptorSetCount = 1;
+		alloc_info.pSetLayouts = &_descriptor_set_layout;
+		VK_ASSERT(vkAllocateDescriptorSets(Core::get_device(), &alloc_info, &_descriptor_set), "vkAllocateDescriptorSets(), EnvironmentLighting - FAILED");
+	}
+
+	{
+		std::array<VkDescriptorImageInfo, 3> infos{};
+		std::array<VkWriteDescriptorSet, 3> writes{};
+		for (uint32_t i = 0; i < writes.size(); i++) {
+			infos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			infos[i].imageView = _baked_images[i].image_view->get_image_view();
+			infos[i].sampler = _sampler;
+
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writes[i].dstArrayElement = 0;
+			writes[i].dstBinding = i;
+			writes[i].dstSet = _descriptor_set;
+			writes[i].pImageInfo = &infos[i];
+		}
+		vkUpdateDescriptorSets(Core::get_device(), writes.size(), writes.data(), 0, 0);
+	}
+	LOG_STATUS("Created EnvironmentLighting descriptor set.");
+}
+
+std::vector<VkDescriptorSetLayoutBinding> EnvironmentLighting::get_bindings() noexcept {
+	//irradiance, prefiltered and BRDF lut
+	std::vector<VkDescriptorSetLayoutBinding> bindings(3);
+	for (uint32_t i = 0; i < bindings.size(); i++) {
+		bindings[i].binding = i;
+		bindings[i].descriptorCount = 1;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+	return bindings;
+}
+
+VkDeviceSize EnvironmentLighting::get_copy_regions(std::array<std::vector<VkBufferImageCopy>, 3>& regions) const noexcept {
+	VkDeviceSize offset = 0;
+	for (uint32_t i = 0; i < _baked_images.size(); i++) {
+		const BakedImage& baked = _baked_images[i];
+		regions[i].resize(baked.mip_levels);
+		for (uint32_t mip = 0; mip < baked.mip_levels; mip++) {
+			const uint32_t width = std::max(baked.image->get_width() >> mip, 1u);
+			const uint32_t height = std::max(baked.image->get_height() >> mip, 1u);
+
+			VkBufferImageCopy& region = regions[i][mip];
+			region = {};
+			region.bufferOffset = offset;
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, baked.array_layers };
+			region.imageExtent = { width, height, 1 };
+			offset += static_cast<VkDeviceSize>(width) * height * baked.array_layers * IBL_TEXEL_SIZE;
+		}
+	}
+	return offset;
+}
+
+bool EnvironmentLighting::load_cache(const BakeKey& key) {
+	std::array<std::vector<VkBufferImageCopy>, 3> regions;
+	const VkDeviceSize size = get_copy_regions(regions);
+
+	MappedBlob blob = BakeCache::load("ibl", key);
+	if (!blob || blob.size() != size) {
+		return false;
+	}
+
+	VulkanBuffer staging_buffer(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, size,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	memcpy(staging_buffer.map_memory(0, size), blob.data(), size);
+	staging_buffer.unmap_memory();
+
+	auto cmd = CommandManager::begin_single_command_buffer();
+	for (uint32_t i = 0; i < _baked_images.size(); i++) {
+		const BakedImage& baked = _baked_images[i];
+		const VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, baked.mip_levels, 0, baked.array_layers };
+		CommandManager::transition_image_layout(cmd, *baked.image,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, range);
+		CommandManager::copy_buffer_to_image(cmd, staging_buffer, baked.image->get_image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions[i]);
+		CommandManager::transition_image_layout(cmd, *baked.image,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, range);
+	}
+	CommandManager::end_single_command_buffer(cmd);
+	//the staging buffer dies with this scope
+	vkQueueWaitIdle(Core::get_graphics_queue());
+	return true;
+}
+
+void EnvironmentLighting::bake(const std::string& equirectangular_path, const BakeKey& key) {
+	//half floats keep the hdr range at half the memory and upload size
+	VulkanTexture2D equirectangular_map(VK_FORMAT_R16G16B16A16_SFLOAT, equirectangular_path.c_str());
+
+	const uint32_t environment_mip_levels = static_cast<uint32_t>(std::log2(ENVIRONMENT_SIZE)) + 1;
+
+	VulkanImageCreateInfo image_create_info{};
+	image_create_info.width = ENVIRONMENT_SIZE;
+	image_create_info.height = ENVIRONMENT_SIZE;
+	image_create_info.format = IBL_FORMAT;
+	image_create_info.array_layers = 6;
+	image_create_info.mip_levels = environment_mip_levels;
+	image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+	//mips are blitted for the filtered lookups of the prefilter and irradiance
+	image_create_info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	image_create_info.memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	image_create_info.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+	VulkanImage environment(image_create_info);
+
+	VulkanImageViewCreateInfo view_create_info{};
+	view_create_info.type = VK_IMAGE_VIEW_TYPE_CUBE;
+	view_create_info.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	view_create_info.layer_count = 6;
+	view_create_info.mip_level_count = environment_mip_levels;
+	VulkanImageView environment_view(environment, view_create_info);
+
+	//storage views address a single mip
+	view_create_info.mip_level_count = 1;
+	VulkanImageView environment_target_view(environment, view_create_info);
+	std::vector<std::unique_ptr<VulkanImageView>> prefiltered_target_views(PREFILTERED_MIP_LEVELS);
+	for (uint32_t mip = 0; mip < PREFILTERED_MIP_LEVELS; mip++) {
+		view_create_info.base_mip_level = mip;
+		prefiltered_target_views[mip] = std::unique_ptr<VulkanImageView>(new VulkanImageView(*_baked_images[1].image, view_create_info));
+	}
+
+	//equirectangular projection, prefilter mips, irradiance and BRDF lut
+	const uint32_t set_count = PREFILTERED_MIP_LEVELS + 3;
+
+	VkDescriptorSetLayout descriptor_set_layout;
+	VkDescriptorPool descriptor_pool;
+	VkPipelineLayout pipeline_layout;
+	std::vector<VkDescriptorSet> descriptor_sets(set_count);
+	{
+		//source and target
+		std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+		for (uint32_t i = 0; i < bindings.size(); i++) {
+			bindings[i].binding = i;
+			bindings[i].descriptorCount = 1;
+			bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		VkDescriptorSetLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		create_info.bindingCount = bindings.size();
+		create_info.pBindings = bindings.data();
+		VK_ASSERT(vkCreateDescriptorSetLayout(Core::get_device(), &create_info, nullptr, &descriptor_set_layout), "vkCreateDescriptorSetLayout(), EnvironmentLighting - FAILED");
+	}
+
+	{
+		std::array<VkDescriptorPoolSize, 2> pool_sizes{};
+		pool_sizes[0].descriptorCount = set_count;
+		pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		pool_sizes[1].descriptorCount = set_count;
+		pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+		VkDescriptorPoolCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		create_info.pPoolSizes = pool_sizes.data();
+		create_info.poolSizeCount = pool_sizes.size();
+		create_info.maxSets = set_count;
+		VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &create_info, nullptr, &descriptor_pool), "vkCreateDescriptorPool(), EnvironmentLighting - FAILED");
+
+		std::vector<VkDescriptorSetLayout> layouts(set_count, descriptor_set_layout);
+		VkDescriptorSetAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		alloc_info.descriptorPool = descriptor_pool;
+		alloc_info.descriptorSetCount = set_count;
+		alloc_info.pSetLayouts = layouts.data();
+		VK_ASSERT(vkAllocateDescriptorSets(Core::get_device(), &alloc_info, descriptor_sets.data()), "vkAllocateDescriptorSets(), EnvironmentLighting - FAILED");
+	}
+
+	{
+		VkDescriptorImageInfo equirectangular_info = equirectangular_map.get_info(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		VkDescriptorImageInfo environment_info{ _sampler, environment_view.get_image_view(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+		std::vector<VkDescriptorImageInfo> target_infos;
+		target_infos.reserve(set_count);
+		target_infos.push_back({ VK_NULL_HANDLE, environment_target_view.get_image_view(), VK_IMAGE_LAYOUT_GENERAL });
+		for (const auto& view : prefiltered_target_views) {
+			target_infos.push_back({ VK_NULL_HANDLE, view->get_image_view(), VK_IMAGE_LAYOUT_GENERAL });
+		}
+		target_infos.push_back({ VK_NULL_HANDLE, _baked_images[0].image_view->get_image_view(), VK_IMAGE_LAYOUT_GENERAL });
+		target_infos.push_back({ VK_NULL_HANDLE, _baked_images[2].image_view->get_image_view(), VK_IMAGE_LAYOUT_GENERAL });
+
+		std::vector<VkWriteDescriptorSet> writes;
+		writes.reserve(set_count * 2);
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.descriptorCount = 1;
+		write.dstArrayElement = 0;
+		for (uint32_t i = 0; i < set_count; i++) {
+			write.dstSet = descriptor_sets[i];
+
+			//the BRDF lut does not sample anything
+			if (i + 1 < set_count) {
+				write.dstBinding = 0;
+				write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				write.pImageInfo = i == 0 ? &equirectangular_info : &environment_info;
+				writes.push_back(write);
+			}
+
+			write.dstBinding = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			write.pImageInfo = &target_infos[i];
+			writes.push_back(write);
+		}
+		vkUpdateDescriptorSets(Core::get_device(), writes.size(), writes.data(), 0, 0);
+	}
+
+	{
+		VkPushConstantRange push_range{};
+		push_range.offset = 0;
+		push_range.size = sizeof(BakePushConstants);
+		push_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		VkPipelineLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		create_info.setLayoutCount = 1;
+		create_info.pSetLayouts = &descriptor_set_layout;
+		create_info.pPushConstantRanges = &push_range;
+		create_info.pushConstantRangeCount = 1;
+		VK_ASSERT(vkCreatePipelineLayout(Core::get_device(), &create_info, nullptr, &pipeline_layout), "vkCreatePipelineLayout(), EnvironmentLighting - FAILED.");
+	}
+
+	VkPipeline equirect_to_cube_pipeline = create_compute_pipeline(pipeline_layout, equirect_to_cube_path.c_str());
+	VkPipeline prefilter_pipeline = create_compute_pipeline(pipeline_layout, prefilter_path.c_str());
+	VkPipeline irradiance_pipeline = create_compute_pipeline(pipeline_layout, irradiance_path.c_str());
+	VkPipeline brdf_lut_pipeline = create_compute_pipeline(pipeline_layout, brdf_lut_path.c_str());
+
+	std::array<std::vector<VkBufferImageCopy>, 3> regions;
+	const VkDeviceSize size = get_copy_regions(regions);
+	VulkanBuffer readback_buffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT, size,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	auto cmd = CommandManager::begin_single_command_buffer();
+
+	//the equirectangular upload was submitted with a barrier for the fragment shaders only
+	CommandManager::set_memory_dependency(cmd,
+		VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+	//project the equirectangular map on the first mip
+	CommandManager::transition_image_layout(cmd, environment,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, VK_ACCESS_SHADER_WRITE_BIT,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+		{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 });
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, equirect_to_cube_pipeline);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &descriptor_sets[0], 0, 0);
+	vkCmdDispatch(cmd, get_group_count(ENVIRONMENT_SIZE), get_group_count(ENVIRONMENT_SIZE), 6);
+
+	CommandManager::transition_image_layout(cmd, environment,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+		VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 });
+
+	//every mip is blitted from the previous one
+	for (uint32_t mip = 1; mip < environment_mip_levels; mip++) {
+		const VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, mip, 1, 0, 6 };
+		CommandManager::transition_image_layout(cmd, environment,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, range);
+
+		const int32_t src_size = static_cast<int32_t>(ENVIRONMENT_SIZE >> (mip - 1));
+		VkImageBlit region{};
+		region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, 0, 6 };
+		region.srcOffsets[1] = { src_size, src_size, 1 };
+		region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 6 };
+		region.dstOffsets[1] = { std::max(src_size / 2, 1), std::max(src_size / 2, 1), 1 };
+		vkCmdBlitImage(cmd,
+			environment.get_image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			environment.get_image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &region, VK_FILTER_LINEAR);
+
+		CommandManager::transition_image_layout(cmd, environment,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, range);
+	}
+
+	CommandManager::transition_image_layout(cmd, environment,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		{ VK_IMAGE_ASPECT_COLOR_BIT, 0, environment_mip_levels, 0, 6 });
+
+	for (const auto& baked : _baked_images) {
+		CommandManager::transition_image_layout(cmd, *baked.image,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, VK_ACCESS_SHADER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+			{ VK_IMAGE_ASPECT_COLOR_BIT, 0, baked.mip_levels, 0, baked.array_layers });
+	}
+
+	BakePushConstants push{};
+	push.environment_size = static_cast<float>(ENVIRONMENT_SIZE);
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, prefilter_pipeline);
+	for (uint32_t mip = 0; mip < PREFILTERED_MIP_LEVELS; mip++) {
+		push.roughness = static_cast<float>(mip) / static_cast<float>(PREFILTERED_MIP_LEVELS - 1);
+		const uint32_t mip_size = std::max(PREFILTERED_SIZE >> mip, 1u);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &descriptor_sets[mip + 1], 0, 0);
+		vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BakePushConstants), &push);
+		vkCmdDispatch(cmd, get_group_count(mip_size), get_group_count(mip_size), 6);
+	}
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, irradiance_pipeline);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &descriptor_sets[set_count - 2], 0, 0);
+	vkCmdDispatch(cmd, get_group_count(IRRADIANCE_SIZE), get_group_count(IRRADIANCE_SIZE), 6);
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, brdf_lut_pipeline);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &descriptor_sets[set_count - 1], 0, 0);
+	vkCmdDispatch(cmd, get_group_count(BRDF_LUT_SIZE), get_group_count(BRDF_LUT_SIZE), 1);
+
+	//read the results back for the cache
+	for (uint32_t i = 0; i < _baked_images.size(); i++) {
+		const BakedImage& baked = _baked_images[i];
+		const VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, baked.mip_levels, 0, baked.array_layers };
+		CommandManager::transition_image_layout(cmd, *baked.image,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+			VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, range);
+		CommandManager::copy_image_to_buffer(cmd, baked.image->get_image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback_buffer, regions[i]);
+		CommandManager::transition_image_layout(cmd, *baked.image,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, VK_ACCESS_SHADER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, range);
+	}
+	CommandManager::set_memory_dependency(cmd,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT);
+
+	CommandManager::end_single_command_buffer(cmd);
+	//the bake resources die with this scope
+	vkQueueWaitIdle(Core::get_graphics_queue());
+
+	BakeCache::store("ibl", key, readback_buffer.map_memory(0, size), size);
+	readback_buffer.unmap_memory();
+
+	vkDestroyPipeline(Core::get_device(), equirect_to_cube_pipeline, nullptr);
+	vkDestroyPipeline(Core::get_device(), prefilter_pipeline, nullptr);
+	vkDestroyPipeline(Core::get_device(), irradiance_pipeline, nullptr);
+	vkDestroyPipeline(Core::get_device(), brdf_lut_pipeline, nullptr);
+	vkDestroyPipelineLayout(Core::get_device(), pipeline_layout, nullptr);
+	vkDestroyDescriptorPool(Core::get_device(), descriptor_pool, nullptr);
+	vkDestroyDescriptorSetLayout(Core::get_device(), descriptor_set_layout, nullptr);
+}
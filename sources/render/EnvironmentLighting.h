@@ -0,0 +1,44 @@
+#pragma once
+#include "VulkanDataObjects.h"
+#include "BakeCache.h"
+#include <array>
+
+//image based lighting from an equirectangular environment map:
+//diffuse irradiance cube, GGX prefiltered specular cube and the split sum BRDF lut,
+//baked in compute once and kept in the bake cache
+class EnvironmentLighting {
+private:
+	struct BakedImage {
+		std::shared_ptr<VulkanImage> image;
+		std::shared_ptr<VulkanImageView> image_view;
+		uint32_t mip_levels;
+		uint32_t array_layers;
+	};
+
+	//irradiance, prefiltered and BRDF lut in the order of the cache file
+	std::array<BakedImage, 3> _baked_images;
+	VkSampler _sampler;
+
+	VkDescriptorPool _descriptor_pool;
+	VkDescriptorSetLayout _descriptor_set_layout;
+	VkDescriptorSet _descriptor_set;
+
+private:
+	void create_images();
+	void create_descriptor_tools();
+
+	//regions of every mip and layer packed one after another, returns the packed size
+	VkDeviceSize get_copy_regions(std::array<std::vector<VkBufferImageCopy>, 3>& regions) const noexcept;
+
+	bool load_cache(const BakeKey& key);
+	void bake(const std::string& equirectangular_path, const BakeKey& key);
+
+public:
+	EnvironmentLighting(const std::string& equirectangular_path);
+
+	inline VkDescriptorSetLayout get_descriptor_set_layout() const noexcept { return _descriptor_set_layout; }
+	inline VkDescriptorSet get_descriptor_set() const noexcept { return _descriptor_set; }
+	static std::vector<VkDescriptorSetLayoutBinding> get_bindings() noexcept;
+
+	~EnvironmentLighting();
+};
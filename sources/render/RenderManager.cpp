@@ -1,9 +1,17 @@
 #include "RenderManager.h"
 #include "RenderUnitSolid.h"
 #include "RenderUnitPostProcess.h"
+#include "RenderUnitBloom.h"
 #include "Camera.h"
 #include "Scene.h"
 #include "MaterialManager.h"
+#include "EnvironmentLighting.h"
+#include "PipelineCache.h"
+#include "GpuProfiler.h"
+#include "CpuProfiler.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "ObjectPicker.h"
 #include <array>
 
 const std::string environment_map_path = std::string(RENDERER_DIRECTORY) + "/assets/thatch_chapel_4k.hdr";
@@ -19,7 +27,8 @@ RenderManager::RenderManager(const RenderManagerCreateInfo& render_manager_creat
 	_material_manager(render_manager_create_info.material_manager){
 	CreateImagesInfo create_images_info;
 
-	create_images(create_images_info);
+	create_images(create_images_info, render_manager_create_info.render_target_formats,
+		render_manager_create_info.is_object_id_enabled);
 	create_buffers();
 	create_descritor_tools();
 
@@ -27,27 +36,68 @@ RenderManager::RenderManager(const RenderManagerCreateInfo& render_manager_creat
 		render_manager_create_info.scene,
 		render_manager_create_info.material_manager,
 		render_manager_create_info.camera,
+		render_manager_create_info.gui_info,
 		create_images_info.depth_image,
 		create_images_info.depth_image_view,
 		create_images_info.hdr_image,
 		create_images_info.hdr_image_view,
-		create_images_info.bright_image,
+		create_images_info.object_id_image,
+		create_images_info.object_id_image_view,
+		_environment_lighting,
 		_descriptor_set_layout
 	};
 
+	RenderUnitBloomCreateInfo bloom_create_info{
+		render_manager_create_info.gui_info,
+		create_images_info.hdr_image_view,
+		create_images_info.bloom_format
+	};
+
+	//the units create their pipelines on the pool, post process is created here
+	//once the bloom image exists and keeps the gui on this thread
+	Timer<> timer;
+	auto unit_solid_future = ThreadPool::submit([&solid_create_info] { return new RenderUnitSolid(solid_create_info); });
+	auto unit_bloom_future = ThreadPool::submit([&bloom_create_info] { return new RenderUnitBloom(bloom_create_info); });
+	RenderUnitBloom* unit_bloom = unit_bloom_future.get();
+
 	RenderUnitPostProcessCreateInfo post_process_create_info{
 		render_manager_create_info.window,
 		render_manager_create_info.gui_info,
 		create_images_info.hdr_image,
 		create_images_info.hdr_image_view,
-		create_images_info.staging_color_image,
-		create_images_info.bright_image
+		unit_bloom->get_bloom_image(),
+		unit_bloom->get_bloom_image_view()
 	};
 
-	_render_units = { new RenderUnitSolid(solid_create_info), new RenderUnitPostProcess(post_process_create_info)};
+	RenderUnitPostProcess* unit_post_process = new RenderUnitPostProcess(post_process_create_info);
+	_render_units = { unit_solid_future.get(), unit_bloom, unit_post_process };
+
+	PipelineCacheStatistics statistics = PipelineCache::get_statistics();
+	LOG_STATUS("Created render units in ", timer.get_elapsed_time_from_start(), " ms, pipelines: ", statistics.pipeline_count,
+		", pipeline creation: ", statistics.creation_time, " ms", statistics.is_warm ? ", warm cache." : ", cold cache.");
+}
+
+VkFormat RenderManager::get_render_target_format(RenderTargetPrecision precision) noexcept {
+	std::vector<VkFormat> candidates;
+	switch (precision)
+	{
+	case RenderTargetPrecision::PACKED:
+		candidates.push_back(VK_FORMAT_B10G11R11_UFLOAT_PACK32);
+		[[fallthrough]];
+	case RenderTargetPrecision::HALF:
+		candidates.push_back(VK_FORMAT_R16G16B16A16_SFLOAT);
+		[[fallthrough]];
+	case RenderTargetPrecision::FULL:
+		candidates.push_back(VK_FORMAT_R32G32B32A32_SFLOAT);//97.63% availability
+		break;
+	}
+	//bloom blends its upsamples additively
+	return Core::find_appropriate_format(candidates,
+		VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT,
+		VK_IMAGE_TILING_OPTIMAL);
 }
 
-void RenderManager::create_images(CreateImagesInfo& create_images_info) {
+void RenderManager::create_images(CreateImagesInfo& create_images_info, const RenderTargetFormatPolicy& policy, bool is_object_id_enabled) {
 	VulkanImageCreateInfo image_create_info{};
 	image_create_info.array_layers = 1;
 	image_create_info.mip_levels = 1;
@@ -69,38 +119,29 @@ void RenderManager::create_images(CreateImagesInfo& create_images_info) {
 	create_images_info.depth_image_view = std::shared_ptr<VulkanImageView>(new VulkanImageView(*create_images_info.depth_image, view_create_info));
 	LOG_STATUS("Created depth image and image view.");
 	
-	image_create_info.format = VK_FORMAT_R32G32B32A32_SFLOAT;//97.63% availability
-	image_create_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+	image_create_info.format = get_render_target_format(policy.hdr);
+	image_create_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 	create_images_info.hdr_image = std::shared_ptr<VulkanImage>(new VulkanImage(image_create_info));
 
 	view_create_info.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
 	create_images_info.hdr_image_view = std::shared_ptr<VulkanImageView>(new VulkanImageView(*create_images_info.hdr_image, view_create_info));
-	LOG_STATUS("Created HDR image and image view.");
-
-	image_create_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-	create_images_info.bright_image = std::shared_ptr<VulkanTexture2D>(new VulkanTexture2D(
-		VK_FORMAT_R32G32B32A32_SFLOAT,
-		image_create_info.width, image_create_info.height,
-		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-		VK_IMAGE_ASPECT_COLOR_BIT));
-	LOG_STATUS("Created bright image and image view.");
-
-	create_images_info.staging_color_image = std::shared_ptr<VulkanTexture2D>(new VulkanTexture2D(
-		VK_FORMAT_R32G32B32A32_SFLOAT,
-		image_create_info.width, image_create_info.height,
-		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
-		VK_IMAGE_ASPECT_COLOR_BIT));
-	LOG_STATUS("Created staging image and image view for blur.");
-
-	create_images_info.equirectangular_env_map = std::shared_ptr<VulkanTexture2D>(new VulkanTexture2D(
-		VK_FORMAT_R32G32B32A32_SFLOAT, environment_map_path.c_str()));
-	LOG_STATUS("Loaded equirectangluar environment map.");
-
-	create_images_info.skybox = std::shared_ptr<VulkanCube>(new VulkanCube(
-		create_images_info.equirectangular_env_map->get_format(),
-		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT
-	));
-	LOG_STATUS("Created skybox.");
+	LOG_STATUS("Created HDR image and image view, format: ", image_create_info.format);
+
+	if (is_object_id_enabled) {
+		//R32_UINT color attachments are mandatory
+		image_create_info.format = VK_FORMAT_R32_UINT;
+		image_create_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		create_images_info.object_id_image = std::shared_ptr<VulkanImage>(new VulkanImage(image_create_info));
+		create_images_info.object_id_image_view = std::shared_ptr<VulkanImageView>(new VulkanImageView(*create_images_info.object_id_image, view_create_info));
+		_object_picker = std::unique_ptr<ObjectPicker>(new ObjectPicker(create_images_info.object_id_image));
+		LOG_STATUS("Created object id image and image view.");
+	}
+
+	create_images_info.bloom_format = get_render_target_format(policy.bloom);
+	LOG_STATUS("Chose bloom format: ", create_images_info.bloom_format);
+
+	//loaded from the bake cache unless the environment map or the bake changed
+	_environment_lighting = std::shared_ptr<EnvironmentLighting>(new EnvironmentLighting(environment_map_path));
 }
 
 void RenderManager::create_buffers() {
@@ -180,11 +221,12 @@ void RenderManager::update_descriptor_sets(VkCommandBuffer command_buffer) {
 
 	GlobalData data;
 	data.view = _camera.get_view_matrix();
-	data.perspective = glm::perspective(glm::radians(90.f), aspect, 0.01f, 1000.f);
-	//vulkan -y
-	data.perspective[1][1] *= -1;
+	data.perspective = CameraBase::get_projection_matrix(aspect);
 
 	memcpy(_global_uniform_memory_ptrs[Core::get_current_frame()], &data, sizeof(GlobalData));
+	if (_object_picker) {
+		_object_picker->begin_frame();
+	}
 
 	_scene->update_descriptor_sets(command_buffer);
 	_material_manager->update_uniform_buffer(command_buffer);
@@ -202,13 +244,30 @@ std::vector<VkDescriptorSetLayoutBinding> RenderManager::get_bindings() noexcept
 }
 
 void RenderManager::render(VkCommandBuffer command_buffer) {
+	PROFILE_FUNCTION();
 	CurrentFrameData frame_data{
 		_descriptor_sets[Core::get_current_frame()]
 	};
 
 	for (auto render_unit : _render_units) {
+		GpuScope scope(command_buffer, render_unit->get_name(), true);
 		render_unit->fill_command_buffer(command_buffer, frame_data);
 	}
+	if (_object_picker) {
+		_object_picker->record(command_buffer);
+	}
+}
+
+bool RenderManager::request_object_id(uint32_t x, uint32_t y) noexcept {
+	if (!_object_picker) {
+		return false;
+	}
+	_object_picker->request(x, y);
+	return true;
+}
+
+bool RenderManager::get_object_id(uint32_t& object_id) noexcept {
+	return _object_picker && _object_picker->get_result(object_id);
 }
 
 RenderManager::~RenderManager() {
@@ -6,12 +6,29 @@ public:
 	VkDescriptorSet global_UBO;
 };
 
+//bytes per pixel of an offscreen target: FULL - 16, HALF - 8, PACKED - 4
+enum class RenderTargetPrecision {
+	FULL,
+	HALF,
+	PACKED
+};
+
+struct RenderTargetFormatPolicy {
+	//lit scene color read by the post-process pass
+	RenderTargetPrecision hdr = RenderTargetPrecision::HALF;
+	//bloom mip chain, it loses alpha and sign when packed
+	RenderTargetPrecision bloom = RenderTargetPrecision::PACKED;
+};
+
 struct RenderManagerCreateInfo {
 	const std::shared_ptr<class Scene>& scene;
 	const class CameraBase& camera;
 	const class Window& window;
 	struct GuiInfo& gui_info;
 	const std::shared_ptr<class MaterialManager>& material_manager;
+	RenderTargetFormatPolicy render_target_formats = {};
+	//R32_UINT attachment of the solid pass with the object under every pixel, used for picking
+	bool is_object_id_enabled = true;
 };
 
 class RenderManager {
@@ -20,6 +37,9 @@ private:
 	const std::shared_ptr<class Scene> _scene;
 	const std::shared_ptr<class MaterialManager> _material_manager;
 	std::vector<RenderUnitBase*> _render_units;
+	std::shared_ptr<class EnvironmentLighting> _environment_lighting;
+	//nullptr without the object id attachment
+	std::unique_ptr<class ObjectPicker> _object_picker;
 
 	std::vector<VulkanBuffer*> _global_uniform_buffers;
 	std::vector<char*> _global_uniform_memory_ptrs;
@@ -35,13 +55,15 @@ private:
 		std::shared_ptr<VulkanImageView> depth_image_view;
 		std::shared_ptr<VulkanImage> hdr_image;
 		std::shared_ptr<VulkanImageView> hdr_image_view;
-		std::shared_ptr<VulkanTexture2D> bright_image;
-		std::shared_ptr<VulkanTexture2D> staging_color_image;
-		std::shared_ptr<VulkanTexture2D> equirectangular_env_map;
-		std::shared_ptr<VulkanCube> skybox;
+		//nullptr if disabled
+		std::shared_ptr<VulkanImage> object_id_image;
+		std::shared_ptr<VulkanImageView> object_id_image_view;
+		VkFormat bloom_format;
 	};
 
-	void create_images(CreateImagesInfo& create_images_info);
+	//the precision is lowered to the closest format the device can render to and sample
+	static VkFormat get_render_target_format(RenderTargetPrecision precision) noexcept;
+	void create_images(CreateImagesInfo& create_images_info, const RenderTargetFormatPolicy& policy, bool is_object_id_enabled);
 	void create_buffers();
 	void create_descritor_tools();
 public:
@@ -49,6 +71,11 @@ public:
 
 	void update_descriptor_sets(VkCommandBuffer command_buffer);
 	void render(VkCommandBuffer command_buffer);
+
+	//reads the object id under the pixel back, the result arrives a few frames later
+	bool request_object_id(uint32_t x, uint32_t y) noexcept;
+	//returns true once per resolved request, OBJECT_ID_NONE if there was no object
+	bool get_object_id(uint32_t& object_id) noexcept;
 	//global UBO
 	static std::vector<VkDescriptorSetLayoutBinding> get_bindings() noexcept;
 
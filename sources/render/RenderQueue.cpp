@@ -0,0 +1,110 @@
+#include "RenderQueue.h"
+#include "SceneObject.h"
+#include <cstring>
+
+constexpr uint32_t RADIX_BITS = 8;
+constexpr uint32_t RADIX_SIZE = 1 << RADIX_BITS;
+constexpr uint32_t RADIX_PASSES = sizeof(uint64_t) * 8 / RADIX_BITS;
+
+uint64_t RenderQueue::make_key(uint32_t pipeline_id, uint32_t material_id, uint32_t mesh_id, float view_depth) noexcept {
+	//positive floats keep their order when compared as integers,
+	//the sign bit is dropped, so the top 24 bits of the rest are the bucket
+	view_depth = view_depth > 0.f ? view_depth : 0.f;
+	uint32_t depth_bits;
+	memcpy(&depth_bits, &view_depth, sizeof(float));
+	const uint64_t depth_bucket = depth_bits >> 7;
+
+	return (static_cast<uint64_t>(pipeline_id & 0xFF) << 56) |
+		(static_cast<uint64_t>(material_id & 0xFFFF) << 40) |
+		(static_cast<uint64_t>(mesh_id & 0xFFFF) << 24) |
+		(depth_bucket & 0xFFFFFF);
+}
+
+void RenderQueue::clear() noexcept {
+	_keys.clear();
+	_order.clear();
+	_commands.clear();
+}
+
+void RenderQueue::push(uint64_t key, const DrawCommand& command) {
+	_order.push_back(static_cast<uint32_t>(_commands.size()));
+	_keys.push_back(key);
+	_commands.push_back(command);
+}
+
+void RenderQueue::sort() noexcept {
+	const size_t count = _keys.size();
+	if (count < 2) {
+		return;
+	}
+	_keys_scratch.resize(count);
+	_order_scratch.resize(count);
+
+	uint32_t histogram[RADIX_SIZE];
+	for (uint32_t pass = 0; pass < RADIX_PASSES; pass++) {
+		const uint32_t shift = pass * RADIX_BITS;
+
+		memset(histogram, 0, sizeof(histogram));
+		for (uint64_t key : _keys) {
+			histogram[(key >> shift) & (RADIX_SIZE - 1)]++;
+		}
+		//every key has the same digit, the pass would not change the order
+		if (histogram[(_keys[0] >> shift) & (RADIX_SIZE - 1)] == count) {
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (uint32_t& bucket : histogram) {
+			uint32_t bucket_size = bucket;
+			bucket = offset;
+			offset += bucket_size;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			uint32_t dst = histogram[(_keys[i] >> shift) & (RADIX_SIZE - 1)]++;
+			_keys_scratch[dst] = _keys[i];
+			_order_scratch[dst] = _order[i];
+		}
+		_keys.swap(_keys_scratch);
+		_order.swap(_order_scratch);
+	}
+}
+
+void RenderQueue::submit(VkCommandBuffer command_buffer, VkPipelineLayout layout) noexcept {
+	_statistics = RenderQueueStatistics{};
+
+	VkPipeline bound_pipeline = VK_NULL_HANDLE;
+	VkDescriptorSet bound_group_set = VK_NULL_HANDLE;
+	VkDescriptorSet bound_material_set = VK_NULL_HANDLE;
+	const VulkanBuffer* bound_vertex_buffer = nullptr;
+
+	for (uint32_t idx : _order) {
+		const DrawCommand& command = _commands[idx];
+
+		if (command.pipeline != bound_pipeline) {
+			bound_pipeline = command.pipeline;
+			vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bound_pipeline);
+			_statistics.pipeline_binds++;
+		}
+		if (command.vertex_buffer != bound_vertex_buffer) {
+			bound_vertex_buffer = command.vertex_buffer;
+			command.index_buffer->bind_index_buffer(command_buffer, 0);
+			command.vertex_buffer->bind_vertex_buffer(command_buffer, 0);
+			_statistics.vertex_buffer_binds++;
+		}
+		if (command.group_descriptor_set != bound_group_set) {
+			bound_group_set = command.group_descriptor_set;
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &bound_group_set, 0, 0);
+			_statistics.descriptor_binds++;
+		}
+		if (command.material_descriptor_set != bound_material_set) {
+			bound_material_set = command.material_descriptor_set;
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 2, 1, &bound_material_set, 0, 0);
+			_statistics.descriptor_binds++;
+		}
+
+		command.model->draw(command_buffer);
+		_statistics.draw_calls++;
+		_statistics.triangles += command.model->get_triangle_count();
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "VulkanDataObjects.h"
+
+struct RenderQueueStatistics {
+	uint32_t draw_calls = 0;
+	uint32_t triangles = 0;
+	uint32_t pipeline_binds = 0;
+	uint32_t descriptor_binds = 0;
+	uint32_t vertex_buffer_binds = 0;
+};
+
+//pipeline the material is drawn with and its id in the sort key
+struct MaterialPipeline {
+	VkPipeline pipeline;
+	uint32_t pipeline_id;
+};
+
+struct DrawCommand {
+	VkPipeline pipeline;
+	//set = 1
+	VkDescriptorSet group_descriptor_set;
+	//set = 2
+	VkDescriptorSet material_descriptor_set;
+	const VulkanBuffer* vertex_buffer;
+	const VulkanBuffer* index_buffer;
+	class Model* model;
+};
+
+class RenderQueue {
+private:
+	std::vector<uint64_t> _keys;
+	std::vector<uint32_t> _order;
+	std::vector<DrawCommand> _commands;
+
+	//radix sort ping-pong buffers
+	std::vector<uint64_t> _keys_scratch;
+	std::vector<uint32_t> _order_scratch;
+
+	RenderQueueStatistics _statistics;
+
+public:
+	//key layout from the most significant bit:
+	//8 bits pipeline | 16 bits material | 16 bits mesh | 24 bits depth bucket
+	static uint64_t make_key(uint32_t pipeline_id, uint32_t material_id, uint32_t mesh_id, float view_depth) noexcept;
+
+	void clear() noexcept;
+	void push(uint64_t key, const DrawCommand& command);
+
+	//LSD radix sort, 8 bits per pass
+	void sort() noexcept;
+	//bind state only when it differs from the previous draw
+	void submit(VkCommandBuffer command_buffer, VkPipelineLayout layout) noexcept;
+
+	inline uint32_t size() const noexcept { return static_cast<uint32_t>(_commands.size()); }
+	inline const RenderQueueStatistics& get_statistics() const noexcept { return _statistics; }
+};
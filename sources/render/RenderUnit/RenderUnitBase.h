@@ -17,6 +17,8 @@ public:
 
 	//begin and end render pass
 	virtual void fill_command_buffer(VkCommandBuffer command_buffer, const struct CurrentFrameData& frame_data) = 0;
+	//GPU profiler scope of the unit
+	virtual const char* get_name() const noexcept = 0;
 
 	inline VkRenderPass get_render_pass() const noexcept { return _render_pass; }
 
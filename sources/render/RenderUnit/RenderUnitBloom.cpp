@@ -0,0 +1,185 @@
+#include "RendererBloom.h"
+#include "RendererGui.h"
+#include "RenderUnitBloom.h"
+#include "GpuProfiler.h"
+#include <array>
+#include <algorithm>
+
+constexpr uint32_t BLOOM_MAX_MIP_COUNT = 8;
+constexpr uint32_t BLOOM_MIN_MIP_SIZE = 4;
+
+RenderUnitBloom::RenderUnitBloom(const RenderUnitBloomCreateInfo& create_info) :
+	_gui_info(create_info.gui_info),
+	_upsample_render_pass(VK_NULL_HANDLE) {
+	create_images(create_info.format);
+	create_render_pass();
+	create_framebuffers();
+
+	_gui_info.bloom.max_iterations = _mip_views.size();
+	_gui_info.bloom.iterations = std::min(_gui_info.bloom.iterations, _gui_info.bloom.max_iterations);
+
+	RendererBloomCreateInfo renderer_create_info{
+		_render_pass,
+		_upsample_render_pass,
+		_gui_info.bloom,
+		create_info.hdr_image_view,
+		_mip_views
+	};
+	_renderer_bloom = std::unique_ptr<RendererBloom>(new RendererBloom(renderer_create_info));
+
+	LOG_STATUS("Created RenderUnitBloom.");
+}
+
+RenderUnitBloom::~RenderUnitBloom() {
+	for (auto framebuffer : _mip_framebuffers) {
+		delete framebuffer;
+	}
+	vkDestroyRenderPass(Core::get_device(), _upsample_render_pass, nullptr);
+}
+
+void RenderUnitBloom::create_images(VkFormat format) {
+	const uint32_t width = std::max(1u, Core::get_swapchain_width() / 2);
+	const uint32_t height = std::max(1u, Core::get_swapchain_height() / 2);
+
+	uint32_t mip_count = 1;
+	while (mip_count < BLOOM_MAX_MIP_COUNT && std::min(width, height) >> mip_count >= BLOOM_MIN_MIP_SIZE) {
+		mip_count++;
+	}
+
+	VulkanImageCreateInfo image_create_info{};
+	image_create_info.width = width;
+	image_create_info.height = height;
+	image_create_info.format = format;
+	image_create_info.array_layers = 1;
+	image_create_info.mip_levels = mip_count;
+	image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+	image_create_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	image_create_info.memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	_bloom_image = std::shared_ptr<VulkanImage>(new VulkanImage(image_create_info));
+
+	//a view per mip, a pass samples one mip while rendering to another
+	VulkanImageViewCreateInfo view_create_info{};
+	view_create_info.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	view_create_info.layer_count = 1;
+	view_create_info.mip_level_count = 1;
+	view_create_info.type = VK_IMAGE_VIEW_TYPE_2D;
+	_mip_views.reserve(mip_count);
+	for (uint32_t mip = 0; mip < mip_count; mip++) {
+		view_create_info.base_mip_level = mip;
+		_mip_views.push_back(std::shared_ptr<VulkanImageView>(new VulkanImageView(*_bloom_image, view_create_info)));
+	}
+	LOG_STATUS("Created bloom image, mip count: ", mip_count);
+}
+
+VkRenderPass RenderUnitBloom::create_render_pass(bool is_upsample) const noexcept {
+	//downsample overwrites the target mip
+	//upsample keeps it and adds the smaller mip
+	VkAttachmentDescription attachment{};
+	attachment.initialLayout = is_upsample ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+	attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	attachment.format = _bloom_image->get_format();
+	attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	attachment.loadOp = is_upsample ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+	VkAttachmentReference color_attachment_reference{};
+	color_attachment_reference.attachment = 0;
+	color_attachment_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &color_attachment_reference;
+
+	std::array<VkSubpassDependency, 2> dependency{};
+	//the previous pass wrote the source mip, and it may still read the target mip
+	dependency[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency[0].dstSubpass = 0;
+	dependency[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependency[0].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	dependency[1].srcSubpass = 0;
+	dependency[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependency[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	dependency[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	VkRenderPassCreateInfo create_info{};
+	create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	create_info.pSubpasses = &subpass;
+	create_info.subpassCount = 1;
+	create_info.attachmentCount = 1;
+	create_info.pAttachments = &attachment;
+	create_info.pDependencies = dependency.data();
+	create_info.dependencyCount = dependency.size();
+
+	VkRenderPass render_pass;
+	VK_ASSERT(vkCreateRenderPass(Core::get_device(), &create_info, nullptr, &render_pass), "vkCreateRenderPass(), RenderUnitBloom - FAILED");
+	return render_pass;
+}
+
+void RenderUnitBloom::create_render_pass() {
+	_render_pass = create_render_pass(false);
+	_upsample_render_pass = create_render_pass(true);
+	LOG_STATUS("Created RenderUnitBloom render passes.");
+}
+
+void RenderUnitBloom::create_framebuffers() {
+	//both render passes are compatible, so a framebuffer per mip serves both
+	_mip_framebuffers.reserve(_mip_views.size());
+	for (uint32_t mip = 0; mip < _mip_views.size(); mip++) {
+		std::vector<VkImageView> attachments = { _mip_views[mip]->get_image_view() };
+		_mip_framebuffers.push_back(new VulkanFramebuffer(
+			std::max(1u, _bloom_image->get_width() >> mip),
+			std::max(1u, _bloom_image->get_height() >> mip),
+			attachments, _render_pass));
+	}
+	LOG_STATUS("Created RenderUnitBloom framebuffers.");
+}
+
+void RenderUnitBloom::begin_render_pass(VkCommandBuffer command_buffer, VkRenderPass render_pass, uint32_t mip) const noexcept {
+	const VulkanFramebuffer* framebuffer = _mip_framebuffers[mip];
+
+	VkRenderPassBeginInfo begin_info{};
+	begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	begin_info.framebuffer = framebuffer->get_framebuffer();
+	begin_info.renderPass = render_pass;
+	begin_info.renderArea.offset = { 0,0 };
+	begin_info.renderArea.extent = { framebuffer->get_width(), framebuffer->get_height() };
+	vkCmdBeginRenderPass(command_buffer, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+	VkViewport viewport{};
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	viewport.x = 0.0f;
+	viewport.y = 0.0f;
+	viewport.width = framebuffer->get_width();
+	viewport.height = framebuffer->get_height();
+	vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+	vkCmdSetScissor(command_buffer, 0, 1, &begin_info.renderArea);
+}
+
+void RenderUnitBloom::fill_command_buffer(VkCommandBuffer command_buffer, const CurrentFrameData& frame_data) {
+	const uint32_t iterations = std::clamp(_gui_info.bloom.iterations, 1, static_cast<int>(_mip_views.size()));
+
+	{
+		GpuScope scope(command_buffer, "Downsample");
+		for (uint32_t mip = 0; mip < iterations; mip++) {
+			begin_render_pass(command_buffer, _render_pass, mip);
+			_renderer_bloom->downsample(command_buffer, mip);
+			vkCmdEndRenderPass(command_buffer);
+		}
+	}
+
+	GpuScope scope(command_buffer, "Upsample");
+	for (uint32_t mip = iterations - 1; mip-- > 0;) {
+		begin_render_pass(command_buffer, _upsample_render_pass, mip);
+		_renderer_bloom->upsample(command_buffer, mip);
+		vkCmdEndRenderPass(command_buffer);
+	}
+}
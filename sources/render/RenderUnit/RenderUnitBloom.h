@@ -0,0 +1,42 @@
+#pragma once
+#include "RenderUnitBase.h"
+
+struct RenderUnitBloomCreateInfo {
+	struct GuiInfo& gui_info;
+	const std::shared_ptr<VulkanImageView>& hdr_image_view;
+	VkFormat format;
+};
+
+class RenderUnitBloom : public RenderUnitBase {
+private:
+	struct GuiInfo& _gui_info;
+
+	//_render_pass downsamples, the upsample pass loads the target to add to it
+	VkRenderPass _upsample_render_pass;
+
+	//half resolution mip chain, mip 0 is the bloom result
+	std::shared_ptr<VulkanImage> _bloom_image;
+	std::vector<std::shared_ptr<VulkanImageView>> _mip_views;
+	std::vector<VulkanFramebuffer*> _mip_framebuffers;
+
+	std::unique_ptr<class RendererBloom> _renderer_bloom;
+
+private:
+	void create_images(VkFormat format);
+
+	VkRenderPass create_render_pass(bool is_upsample) const noexcept;
+	virtual void create_render_pass();
+	virtual void create_framebuffers();
+
+	void begin_render_pass(VkCommandBuffer command_buffer, VkRenderPass render_pass, uint32_t mip) const noexcept;
+public:
+	RenderUnitBloom(const RenderUnitBloomCreateInfo& create_info);
+
+	virtual void fill_command_buffer(VkCommandBuffer command_buffer, const struct CurrentFrameData& frame_data);
+	inline virtual const char* get_name() const noexcept { return "Bloom"; }
+
+	inline const std::shared_ptr<VulkanImage>& get_bloom_image() const noexcept { return _bloom_image; }
+	inline const std::shared_ptr<VulkanImageView>& get_bloom_image_view() const noexcept { return _mip_views[0]; }
+
+	~RenderUnitBloom();
+};
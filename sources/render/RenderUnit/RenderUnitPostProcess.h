@@ -7,32 +7,40 @@ struct RenderUnitPostProcessCreateInfo {
 
 	const std::shared_ptr<VulkanImage>& hdr_color_image;
 	const std::shared_ptr<VulkanImageView>& hdr_color_image_view;
-	// for blur output
-	const std::shared_ptr<VulkanTexture2D>& staging_color_image;
-	const std::shared_ptr<VulkanTexture2D>& _bright_color_image;
+	const std::shared_ptr<VulkanImage>& bloom_image;
+	const std::shared_ptr<VulkanImageView>& bloom_image_view;
 };
 
 class RenderUnitPostProcess : public RenderUnitBase {
 private:
+	struct GuiInfo& _gui_info;
+
 	std::shared_ptr<VulkanImage> _hdr_color_image;
 	std::shared_ptr<VulkanImageView> _hdr_color_image_view;
-	std::shared_ptr<VulkanTexture2D> _bright_color_image;
-	// for blur output
-	std::shared_ptr<VulkanTexture2D> _staging_color_image;
 
+	std::vector<VkImage> _swapchain_images;
 	VulkanMultipleImageViews* _image_views;
 
-	std::unique_ptr<class RendererBlur> _renderer_blur;
+	//compatible with _render_pass, loads the blitted compute result to draw the gui over it
+	VkRenderPass _overlay_render_pass;
+
 	std::unique_ptr<class RendererPostProcess> _renderer_post_process;
+	std::unique_ptr<class RendererComputePostProcess> _renderer_compute_post_process;
 	std::unique_ptr<class RendererGui> _renderer_gui;
 private:
 	void create_images();
 
+	VkRenderPass create_render_pass(bool is_overlay) const noexcept;
 	virtual void create_render_pass();
 	virtual void create_framebuffers();
 
+	bool is_compute_supported() const noexcept;
+	void begin_render_pass(VkCommandBuffer command_buffer, VkRenderPass render_pass) const noexcept;
+	void blit_to_swapchain(VkCommandBuffer command_buffer) const noexcept;
+
 public:
 	virtual void fill_command_buffer(VkCommandBuffer command_buffer, const struct CurrentFrameData& frame_data);
+	inline virtual const char* get_name() const noexcept { return "Post-process"; }
 
 
 	RenderUnitPostProcess(const RenderUnitPostProcessCreateInfo& create_info);
@@ -4,6 +4,8 @@
 #include "RendererLight.h"
 #include "RendererGui.h"
 #include "RenderUnitSolid.h"
+#include "GpuProfiler.h"
+#include "ObjectPicker.h"
 #include <array>
 
 RenderUnitSolid::RenderUnitSolid(const RenderUnitSolidCreateInfo& unit_create_info) :
@@ -12,22 +14,29 @@ RenderUnitSolid::RenderUnitSolid(const RenderUnitSolidCreateInfo& unit_create_in
 	_depth_image_view(unit_create_info.depth_image_view),
 	_hdr_image(unit_create_info.hdr_image),
 	_hdr_image_view(unit_create_info.hdr_image_view),
-	_bright_image(unit_create_info.bright_image){
+	_object_id_image(unit_create_info.object_id_image),
+	_object_id_image_view(unit_create_info.object_id_image_view){
 	create_render_pass();
 	create_framebuffers();
 	create_descriptor_tools(unit_create_info);
 
 	RendererSolidCreateInfo renderer_solid_create_info{
 		_render_pass,
+		get_color_attachment_count(),
 		unit_create_info.global_UBO_descriptor_set_layout,
 		unit_create_info.material_manager,
-		unit_create_info.scene
+		unit_create_info.environment_lighting,
+		unit_create_info.scene,
+		unit_create_info.camera,
+		unit_create_info.gui_info
 	};
 
 	RendererLightSourceCreateInfo renderer_light_create_info{
 		unit_create_info.scene,
+		unit_create_info.camera,
 		unit_create_info.global_UBO_descriptor_set_layout,
-		_render_pass
+		_render_pass,
+		get_color_attachment_count()
 	};
 
 	_renderer_solid = new RendererSolid(renderer_solid_create_info);
@@ -43,10 +52,11 @@ RenderUnitSolid::~RenderUnitSolid() {
 }
 
 void RenderUnitSolid::create_render_pass() {
-	//write color to the hdr color attachment
-	//write bright color to the bright hdr color attachment
+	//write color to the hdr color attachment,
+	//bloom thresholds it afterwards,
+	//the object ids are copied to the host when picking
 
-	std::array<VkAttachmentDescription, 3> attachments{};
+	std::vector<VkAttachmentDescription> attachments(_object_id_image ? 3 : 2);
 	//hdr color attachment
 	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	attachments[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -67,35 +77,30 @@ void RenderUnitSolid::create_render_pass() {
 	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
-	//bright hdr color attachment
-	attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[2].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	attachments[2].format = _bright_image->get_format();
-	attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+	std::array<VkAttachmentReference, 2> color_attachment_references{};
+	color_attachment_references[0].attachment = 0;
+	color_attachment_references[0].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	if (_object_id_image) {
+		//object id attachment, 0 where nothing is drawn
+		attachments[2] = attachments[0];
+		attachments[2].format = _object_id_image->get_format();
+		attachments[2].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 
-	VkAttachmentReference color_attachment_reference{};
-	color_attachment_reference.attachment = 0;
-	color_attachment_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		color_attachment_references[1].attachment = 2;
+		color_attachment_references[1].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	}
 
 	VkAttachmentReference depth_attachment_reference{};
 	depth_attachment_reference.attachment = 1;
 	depth_attachment_reference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-	VkAttachmentReference bright_color_attachment_reference{};
-	bright_color_attachment_reference.attachment = 2;
-	bright_color_attachment_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	
-	VkAttachmentReference references[] = { color_attachment_reference, bright_color_attachment_reference };
 	VkSubpassDescription subpass{};
-	subpass.colorAttachmentCount = 2;
-	subpass.pColorAttachments = references;
+	subpass.colorAttachmentCount = get_color_attachment_count();
+	subpass.pColorAttachments = color_attachment_references.data();
 	subpass.pDepthStencilAttachment = &depth_attachment_reference;
 
-	std::array<VkSubpassDependency,3> dependency{};
+	std::array<VkSubpassDependency,4> dependency{};
 	dependency[0].srcSubpass = VK_SUBPASS_EXTERNAL;
 	dependency[0].dstSubpass = 0;
 	dependency[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -118,7 +123,14 @@ void RenderUnitSolid::create_render_pass() {
 	dependency[2].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
 	dependency[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 	dependency[2].dstAccessMask = VK_ACCESS_SHADER_READ_BIT ;
-	dependency[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+	//bloom samples the hdr image outside of the pixel, no by region flag
+
+	dependency[3].srcSubpass = 0;
+	dependency[3].dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependency[3].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency[3].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	dependency[3].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency[3].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
 	VkRenderPassCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -127,7 +139,8 @@ void RenderUnitSolid::create_render_pass() {
 	create_info.attachmentCount = attachments.size();
 	create_info.pAttachments = attachments.data();
 	create_info.pDependencies = dependency.data();
-	create_info.dependencyCount = dependency.size();
+	//the transfer dependency only guards the object id readback
+	create_info.dependencyCount = _object_id_image ? dependency.size() : dependency.size() - 1;
 
 	VK_ASSERT(vkCreateRenderPass(Core::get_device(), &create_info, nullptr, &_render_pass), "vkCreateRenderPass(), RenderUnitSolid - FAILED");
 	LOG_STATUS("Created RenderUnitSolid render pass.");
@@ -136,9 +149,11 @@ void RenderUnitSolid::create_render_pass() {
 void RenderUnitSolid::create_framebuffers() {
 	std::vector<VkImageView> attachments = { 
 		_hdr_image_view->get_image_view(),
-		_depth_image_view->get_image_view(),
-		_bright_image->get_image_view()
+		_depth_image_view->get_image_view()
 	};
+	if (_object_id_image_view) {
+		attachments.push_back(_object_id_image_view->get_image_view());
+	}
 
 	_framebuffer = new VulkanFramebuffer(Core::get_swapchain_width(), Core::get_swapchain_height(), attachments, _render_pass);
 	LOG_STATUS("Created RenderUnitSolid framebuffers.");
@@ -167,11 +182,11 @@ void RenderUnitSolid::fill_command_buffer(VkCommandBuffer command_buffer, const
 	std::array<VkClearValue,3> clear_values{};
 	clear_values[0].color = {0.0f,0.0f,0.0f};
 	clear_values[1].depthStencil = { 1.f, 0 };
-	clear_values[2].color = { 0.0f,0.0f,0.0f };
+	clear_values[2].color.uint32[0] = OBJECT_ID_NONE;
 
 	VkRenderPassBeginInfo begin_info{};
 	begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	begin_info.clearValueCount = clear_values.size();
+	begin_info.clearValueCount = _object_id_image ? clear_values.size() : clear_values.size() - 1;
 	begin_info.pClearValues = clear_values.data();
 	begin_info.framebuffer = _framebuffer->get_framebuffer();
 	begin_info.renderPass = _render_pass;
@@ -194,7 +209,13 @@ void RenderUnitSolid::fill_command_buffer(VkCommandBuffer command_buffer, const
 
 	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline_layout, 0, 1, &frame_data.global_UBO, 0, 0);
 	vkCmdPushConstants(command_buffer, _pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(glm::vec3), &camera_pos);
-	_renderer_solid->fill_command_buffer(command_buffer);
-	_renderer_light->fill_command_buffer(command_buffer);
+	{
+		GpuScope scope(command_buffer, "Meshes");
+		_renderer_solid->fill_command_buffer(command_buffer);
+	}
+	{
+		GpuScope scope(command_buffer, "Lights");
+		_renderer_light->fill_command_buffer(command_buffer);
+	}
 	vkCmdEndRenderPass(command_buffer);
 }
\ No newline at end of file
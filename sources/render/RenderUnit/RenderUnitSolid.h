@@ -6,11 +6,15 @@ struct RenderUnitSolidCreateInfo {
 	const std::shared_ptr<class Scene>& scene;
 	const std::shared_ptr<class MaterialManager>& material_manager;
 	const class CameraBase& camera;
+	struct GuiInfo& gui_info;
 	const std::shared_ptr<VulkanImage>& depth_image;
 	const std::shared_ptr<VulkanImageView>& depth_image_view;
 	const std::shared_ptr<VulkanImage>& hdr_image;
 	const std::shared_ptr<VulkanImageView>& hdr_image_view;
-	const std::shared_ptr<VulkanTexture2D>& bright_image;
+	//the object id attachment is left out if nullptr
+	const std::shared_ptr<VulkanImage>& object_id_image;
+	const std::shared_ptr<VulkanImageView>& object_id_image_view;
+	const std::shared_ptr<class EnvironmentLighting>& environment_lighting;
 	VkDescriptorSetLayout global_UBO_descriptor_set_layout;
 };
 
@@ -25,7 +29,8 @@ private:
 	std::shared_ptr<VulkanImageView> _depth_image_view;
 	std::shared_ptr<VulkanImage> _hdr_image;
 	std::shared_ptr<VulkanImageView> _hdr_image_view;
-	std::shared_ptr<VulkanTexture2D> _bright_image;
+	std::shared_ptr<VulkanImage> _object_id_image;
+	std::shared_ptr<VulkanImageView> _object_id_image_view;
 
 	VkPipelineLayout _pipeline_layout;
 
@@ -33,11 +38,14 @@ private:
 	virtual void create_render_pass();
 	virtual void create_framebuffers();
 	void create_descriptor_tools(const RenderUnitSolidCreateInfo& unit_create_info);
+	//hdr color and the object id if enabled
+	inline uint32_t get_color_attachment_count() const noexcept { return _object_id_image ? 2 : 1; }
 
 public:
 	RenderUnitSolid(const RenderUnitSolidCreateInfo& create_info);
 
 	virtual void fill_command_buffer(VkCommandBuffer command_buffer, const struct CurrentFrameData& frame_data);
+	inline virtual const char* get_name() const noexcept { return "Solid"; }
 
 	~RenderUnitSolid();
 };
\ No newline at end of file
@@ -1,19 +1,31 @@
 #pragma once
 #include "Core.h"
+#include "ShaderManager.h"
 
 class RendererBase {
 protected:
 	VkDescriptorPool _descriptor_pool;
+	uint32_t _shader_subscription = 0;
 
 protected:
 	RendererBase() :
 		_descriptor_pool(VK_NULL_HANDLE) {}
 
+	//reload_pipelines() is called between frames when one of the shaders is recompiled
+	void watch_shaders(const std::vector<std::string>& spv_paths) {
+		_shader_subscription = ShaderManager::subscribe(spv_paths, [this] { reload_pipelines(); });
+	}
+	//retire the old pipelines with ShaderManager::retire(), the recorded frames may still use them
+	virtual void reload_pipelines() {}
+
 public:
 
 	virtual void fill_command_buffer(VkCommandBuffer command_buffer) = 0;
 
 	virtual ~RendererBase() {
+		if (_shader_subscription != 0) {
+			ShaderManager::unsubscribe(_shader_subscription);
+		}
 		vkDestroyDescriptorPool(Core::get_device(), _descriptor_pool, nullptr);
 	}
 };
@@ -0,0 +1,207 @@
+#include "RendererBloom.h"
+#include "VulkanDataObjects.h"
+#include "PipelineCache.h"
+
+const std::string quad_shader_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/quad.spv";
+const std::string bloom_downsample_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/bloom_downsample.spv";
+const std::string bloom_upsample_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/bloom_upsample.spv";
+
+RendererBloom::RendererBloom(const RendererBloomCreateInfo& create_info) :
+	_settings(create_info.settings),
+	_downsample_render_pass(create_info.downsample_render_pass),
+	_upsample_render_pass(create_info.upsample_render_pass) {
+	create_descriptor_tools(create_info);
+	_graphics_pipeline = create_graphics_pipeline(_downsample_render_pass, bloom_downsample_path.c_str(), false);
+	_upsample_pipeline = create_graphics_pipeline(_upsample_render_pass, bloom_upsample_path.c_str(), true);
+	watch_shaders({ quad_shader_path, bloom_downsample_path, bloom_upsample_path });
+	LOG_STATUS("Created RendererBloom.");
+}
+
+void RendererBloom::reload_pipelines() {
+	ShaderManager::retire(_graphics_pipeline);
+	ShaderManager::retire(_upsample_pipeline);
+	_graphics_pipeline = create_graphics_pipeline(_downsample_render_pass, bloom_downsample_path.c_str(), false);
+	_upsample_pipeline = create_graphics_pipeline(_upsample_render_pass, bloom_upsample_path.c_str(), true);
+}
+
+RendererBloom::~RendererBloom() {
+	vkDestroyPipeline(Core::get_device(), _upsample_pipeline, nullptr);
+	vkDestroySampler(Core::get_device(), _sampler, nullptr);
+	vkDestroyDescriptorSetLayout(Core::get_device(), _descriptor_set_layout, nullptr);
+}
+
+VkPipeline RendererBloom::create_graphics_pipeline(VkRenderPass render_pass, const char* fragment_shader_path, bool is_additive) noexcept {
+	VkShaderModule vertex_shader = utils::create_shader_module(quad_shader_path.c_str()),
+		fragment_shader = utils::create_shader_module(fragment_shader_path);
+
+	VkPipelineShaderStageCreateInfo shader_stages[2]{
+		utils::set_pipeline_shader_stage(vertex_shader,VK_SHADER_STAGE_VERTEX_BIT),
+		utils::set_pipeline_shader_stage(fragment_shader,VK_SHADER_STAGE_FRAGMENT_BIT)
+	};
+
+	auto input_assembly = utils::set_pipeline_input_assembly_state(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+	std::vector<VkVertexInputAttributeDescription> attributes{};
+	std::vector<VkVertexInputBindingDescription>bindings{};
+	auto vertex_input = utils::set_pipeline_vertex_input_state(attributes, bindings);
+	auto viewport = utils::set_pipeline_viewport_state(1, 1);
+	std::vector<VkDynamicState> dynamic_states{ VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VIEWPORT };
+	auto dynamic = utils::set_pipeline_dynamic_state(dynamic_states);
+	auto rasterization = utils::set_pipeline_rasterization_state(VK_CULL_MODE_BACK_BIT);
+	auto multisample = utils::set_pipeline_multisample_state();
+	auto depth = utils::set_pipeline_depth_stencil_state(VK_FALSE, VK_FALSE);
+	auto color_blend_attachment = utils::set_pipeline_color_blend_attachment_state();
+	if (is_additive) {
+		color_blend_attachment.blendEnable = VK_TRUE;
+		color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+		color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+		color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	}
+	std::vector<VkPipelineColorBlendAttachmentState> color_blend_attachments{ color_blend_attachment };
+	auto color_blend = utils::set_pipeline_color_blend_state(color_blend_attachments);
+
+	VkGraphicsPipelineCreateInfo create_info{};
+	create_info.layout = _pipeline_layout;
+	create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	create_info.subpass = 0;
+	create_info.renderPass = render_pass;
+	create_info.pStages = shader_stages;
+	create_info.stageCount = 2;
+
+	create_info.pInputAssemblyState = &input_assembly;
+	create_info.pVertexInputState = &vertex_input;
+	create_info.pViewportState = &viewport;
+	create_info.pTessellationState = nullptr;
+	create_info.pDynamicState = &dynamic;
+	create_info.pRasterizationState = &rasterization;
+	create_info.pMultisampleState = &multisample;
+	create_info.pDepthStencilState = &depth;
+	create_info.pColorBlendState = &color_blend;
+
+	VkPipeline pipeline = PipelineCache::create_graphics_pipeline(create_info, "RendererBloom");
+
+	vkDestroyShaderModule(Core::get_device(), vertex_shader, nullptr);
+	vkDestroyShaderModule(Core::get_device(), fragment_shader, nullptr);
+
+	return pipeline;
+}
+
+void RendererBloom::create_descriptor_tools(const RendererBloomCreateInfo& renderer_create_info) noexcept {
+	{
+		//clamp so the edges do not bloom from the opposite side
+		VkSamplerCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.magFilter = VK_FILTER_LINEAR;
+		create_info.minFilter = VK_FILTER_LINEAR;
+		create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		create_info.maxLod = 0.f;
+		create_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+		VK_ASSERT(vkCreateSampler(Core::get_device(), &create_info, nullptr, &_sampler), "vkCreateSampler(), RendererBloom - FAILED");
+	}
+
+	{
+		auto binding = get_bindings();
+		VkDescriptorSetLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		create_info.bindingCount = 1;
+		create_info.pBindings = &binding;
+		VK_ASSERT(vkCreateDescriptorSetLayout(Core::get_device(), &create_info, nullptr, &_descriptor_set_layout), "vkCreateDescriptorSetLayout(), RendererBloom - FAILED");
+	}
+
+	{
+		std::vector<VkImageView> sources{ renderer_create_info.hdr_image_view->get_image_view() };
+		for (const auto& view : renderer_create_info.mip_views) {
+			sources.push_back(view->get_image_view());
+		}
+		const uint32_t set_count = sources.size();
+
+		VkDescriptorPoolSize pool_size{};
+		pool_size.descriptorCount = set_count;
+		pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+		VkDescriptorPoolCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		create_info.pPoolSizes = &pool_size;
+		create_info.poolSizeCount = 1;
+		create_info.maxSets = set_count;
+		VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &create_info, nullptr, &_descriptor_pool), "vkCreateDescriptorPool(), RendererBloom - FAILED");
+
+		_descriptor_sets.resize(set_count);
+		std::vector<VkDescriptorSetLayout> layouts(set_count, _descriptor_set_layout);
+		VkDescriptorSetAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		alloc_info.descriptorPool = _descriptor_pool;
+		alloc_info.descriptorSetCount = set_count;
+		alloc_info.pSetLayouts = layouts.data();
+		VK_ASSERT(vkAllocateDescriptorSets(Core::get_device(), &alloc_info, _descriptor_sets.data()), "vkAllocateDescriptorSets(), RendererBloom - FAILED");
+
+		std::vector<VkDescriptorImageInfo> image_infos(set_count);
+		std::vector<VkWriteDescriptorSet> writes(set_count);
+		for (uint32_t i = 0; i < set_count; i++) {
+			image_infos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			image_infos[i].imageView = sources[i];
+			image_infos[i].sampler = _sampler;
+
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writes[i].dstArrayElement = 0;
+			writes[i].dstBinding = 0;
+			writes[i].dstSet = _descriptor_sets[i];
+			writes[i].pImageInfo = &image_infos[i];
+		}
+		vkUpdateDescriptorSets(Core::get_device(), writes.size(), writes.data(), 0, 0);
+	}
+
+	{
+		VkPushConstantRange push_range{};
+		push_range.offset = 0;
+		push_range.size = sizeof(PushConstants);
+		push_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkPipelineLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		create_info.setLayoutCount = 1;
+		create_info.pSetLayouts = &_descriptor_set_layout;
+		create_info.pPushConstantRanges = &push_range;
+		create_info.pushConstantRangeCount = 1;
+		VK_ASSERT(vkCreatePipelineLayout(Core::get_device(), &create_info, nullptr, &_pipeline_layout), "vkCreatePipelineLayout(), RendererBloom - FAILED.");
+	}
+}
+
+VkDescriptorSetLayoutBinding RendererBloom::get_bindings() noexcept {
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorCount = 1;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	return binding;
+}
+
+void RendererBloom::draw(VkCommandBuffer command_buffer, VkPipeline pipeline, VkDescriptorSet source, bool is_prefilter) noexcept {
+	PushConstants push{
+		_settings.threshold,
+		std::max(_settings.knee, 0.f),
+		_settings.radius,
+		is_prefilter
+	};
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline_layout, 0, 1, &source, 0, 0);
+	vkCmdPushConstants(command_buffer, _pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstants), &push);
+	vkCmdDraw(command_buffer, 6, 1, 0, 0);
+}
+
+void RendererBloom::downsample(VkCommandBuffer command_buffer, uint32_t mip) noexcept {
+	draw(command_buffer, _graphics_pipeline, _descriptor_sets[mip], mip == 0);
+}
+
+void RendererBloom::upsample(VkCommandBuffer command_buffer, uint32_t mip) noexcept {
+	draw(command_buffer, _upsample_pipeline, _descriptor_sets[mip + 2], false);
+}
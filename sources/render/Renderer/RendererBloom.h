@@ -0,0 +1,63 @@
+#pragma once
+#include "RendererBase.h"
+
+//runtime bloom parameters, edited in the gui
+struct BloomSettings {
+	//mips of the chain used this frame, clamped to the created chain
+	int iterations = 6;
+	int max_iterations = 0;
+	float threshold = 1.f;
+	float knee = 0.5f;
+	//tent radius of the upsample in source texels
+	float radius = 1.f;
+	float intensity = 0.2f;
+};
+
+struct RendererBloomCreateInfo {
+	VkRenderPass downsample_render_pass;
+	VkRenderPass upsample_render_pass;
+	const BloomSettings& settings;
+	const std::shared_ptr<class VulkanImageView>& hdr_image_view;
+	const std::vector<std::shared_ptr<class VulkanImageView>>& mip_views;
+};
+
+class RendererBloom : public RendererBaseExt {
+private:
+	struct PushConstants {
+		float threshold;
+		float knee;
+		float radius;
+		int32_t is_prefilter;
+	};
+
+	const BloomSettings& _settings;
+
+	//_graphics_pipeline downsamples, the upsample pipeline adds to the target
+	VkPipeline _upsample_pipeline;
+	VkRenderPass _downsample_render_pass;
+	VkRenderPass _upsample_render_pass;
+	VkSampler _sampler;
+	VkDescriptorSetLayout _descriptor_set_layout;
+	//the hdr image, then every mip of the chain
+	std::vector<VkDescriptorSet> _descriptor_sets;
+
+private:
+	void create_descriptor_tools(const RendererBloomCreateInfo& renderer_create_info) noexcept;
+	VkPipeline create_graphics_pipeline(VkRenderPass render_pass, const char* fragment_shader_path, bool is_additive) noexcept;
+	virtual void reload_pipelines();
+	void draw(VkCommandBuffer command_buffer, VkPipeline pipeline, VkDescriptorSet source, bool is_prefilter) noexcept;
+public:
+	RendererBloom(const RendererBloomCreateInfo& create_info);
+
+	//the chain is recorded pass by pass with downsample() and upsample()
+	virtual void fill_command_buffer(VkCommandBuffer command_buffer) {}
+
+	//write mip from the previous one, mip 0 is thresholded from the hdr image
+	void downsample(VkCommandBuffer command_buffer, uint32_t mip) noexcept;
+	//add mip + 1 to mip
+	void upsample(VkCommandBuffer command_buffer, uint32_t mip) noexcept;
+
+	static VkDescriptorSetLayoutBinding get_bindings() noexcept;
+
+	~RendererBloom();
+};
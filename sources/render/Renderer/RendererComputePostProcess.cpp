@@ -0,0 +1,306 @@
+#include "RendererComputePostProcess.h"
+#include "VulkanDataObjects.h"
+#include "CommandManager.h"
+#include "PipelineCache.h"
+#include <array>
+#include <algorithm>
+
+const std::string post_blur_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/post_blur.spv";
+const std::string post_composite_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/post_composite.spv";
+
+//must match post_blur.comp
+constexpr uint32_t BLUR_TILE_SIZE = 256;
+constexpr uint32_t BLUR_MAX_RADIUS = 16;
+constexpr uint32_t COMPOSITE_GROUP_SIZE = 8;
+
+const VkImageSubresourceRange color_subresource_range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+RendererComputePostProcess::RendererComputePostProcess(const RendererComputePostProcessCreateInfo& create_info) :
+	_bloom_settings(create_info.bloom_settings),
+	_settings(create_info.settings) {
+	create_images(create_info);
+	create_descriptor_tools(create_info);
+	_blur_pipeline = create_compute_pipeline(_blur_pipeline_layout, post_blur_path.c_str());
+	_composite_pipeline = create_compute_pipeline(_composite_pipeline_layout, post_composite_path.c_str());
+	watch_shaders({ post_blur_path, post_composite_path });
+	LOG_STATUS("Created RendererComputePostProcess.");
+}
+
+void RendererComputePostProcess::reload_pipelines() {
+	ShaderManager::retire(_blur_pipeline);
+	ShaderManager::retire(_composite_pipeline);
+	_blur_pipeline = create_compute_pipeline(_blur_pipeline_layout, post_blur_path.c_str());
+	_composite_pipeline = create_compute_pipeline(_composite_pipeline_layout, post_composite_path.c_str());
+}
+
+RendererComputePostProcess::~RendererComputePostProcess() {
+	vkDestroyPipeline(Core::get_device(), _blur_pipeline, nullptr);
+	vkDestroyPipeline(Core::get_device(), _composite_pipeline, nullptr);
+	vkDestroyPipelineLayout(Core::get_device(), _blur_pipeline_layout, nullptr);
+	vkDestroyPipelineLayout(Core::get_device(), _composite_pipeline_layout, nullptr);
+	vkDestroyDescriptorSetLayout(Core::get_device(), _blur_descriptor_set_layout, nullptr);
+	vkDestroyDescriptorSetLayout(Core::get_device(), _composite_descriptor_set_layout, nullptr);
+	vkDestroySampler(Core::get_device(), _sampler, nullptr);
+}
+
+void RendererComputePostProcess::create_images(const RendererComputePostProcessCreateInfo& renderer_create_info) {
+	VulkanImageCreateInfo image_create_info{};
+	image_create_info.width = renderer_create_info.bloom_image->get_width();
+	image_create_info.height = renderer_create_info.bloom_image->get_height();
+	image_create_info.format = VK_FORMAT_R16G16B16A16_SFLOAT;//storage support is mandatory
+	image_create_info.array_layers = 1;
+	image_create_info.mip_levels = 1;
+	image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+	image_create_info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	image_create_info.memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	VulkanImageViewCreateInfo view_create_info{};
+	view_create_info.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	view_create_info.layer_count = 1;
+	view_create_info.mip_level_count = 1;
+	view_create_info.type = VK_IMAGE_VIEW_TYPE_2D;
+
+	for (uint32_t i = 0; i < 2; i++) {
+		_blur_images[i] = std::shared_ptr<VulkanImage>(new VulkanImage(image_create_info));
+		_blur_image_views[i] = std::shared_ptr<VulkanImageView>(new VulkanImageView(*_blur_images[i], view_create_info));
+	}
+
+	//blitted to the swapchain, the blit converts to its format
+	image_create_info.width = Core::get_swapchain_width();
+	image_create_info.height = Core::get_swapchain_height();
+	image_create_info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	_output_image = std::shared_ptr<VulkanImage>(new VulkanImage(image_create_info));
+	_output_image_view = std::shared_ptr<VulkanImageView>(new VulkanImageView(*_output_image, view_create_info));
+	LOG_STATUS("Created RendererComputePostProcess images.");
+}
+
+void RendererComputePostProcess::create_descriptor_tools(const RendererComputePostProcessCreateInfo& renderer_create_info) {
+	{
+		VkSamplerCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.magFilter = VK_FILTER_LINEAR;
+		create_info.minFilter = VK_FILTER_LINEAR;
+		create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		create_info.maxLod = 0.f;
+		create_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+		VK_ASSERT(vkCreateSampler(Core::get_device(), &create_info, nullptr, &_sampler), "vkCreateSampler(), RendererComputePostProcess - FAILED");
+	}
+
+	{
+		//source and target
+		std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+		bindings[0].binding = 0;
+		bindings[0].descriptorCount = 1;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		bindings[1].binding = 1;
+		bindings[1].descriptorCount = 1;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		VkDescriptorSetLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		create_info.bindingCount = bindings.size();
+		create_info.pBindings = bindings.data();
+		VK_ASSERT(vkCreateDescriptorSetLayout(Core::get_device(), &create_info, nullptr, &_blur_descriptor_set_layout), "vkCreateDescriptorSetLayout(), RendererComputePostProcess - FAILED");
+	}
+
+	{
+		//hdr color, bloom and target
+		std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+		for (uint32_t i = 0; i < bindings.size(); i++) {
+			bindings[i].binding = i;
+			bindings[i].descriptorCount = 1;
+			bindings[i].descriptorType = i < 2 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		VkDescriptorSetLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		create_info.bindingCount = bindings.size();
+		create_info.pBindings = bindings.data();
+		VK_ASSERT(vkCreateDescriptorSetLayout(Core::get_device(), &create_info, nullptr, &_composite_descriptor_set_layout), "vkCreateDescriptorSetLayout(), RendererComputePostProcess - FAILED");
+	}
+
+	{
+		std::array<VkDescriptorPoolSize, 2> pool_sizes{};
+		pool_sizes[0].descriptorCount = 6;
+		pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		pool_sizes[1].descriptorCount = 4;
+		pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+		VkDescriptorPoolCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		create_info.pPoolSizes = pool_sizes.data();
+		create_info.poolSizeCount = pool_sizes.size();
+		create_info.maxSets = 4;
+		VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &create_info, nullptr, &_descriptor_pool), "vkCreateDescriptorPool(), RendererComputePostProcess - FAILED");
+
+		VkDescriptorSetLayout blur_layouts[2] = { _blur_descriptor_set_layout, _blur_descriptor_set_layout };
+		VkDescriptorSetAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		alloc_info.descriptorPool = _descriptor_pool;
+		alloc_info.descriptorSetCount = 2;
+		alloc_info.pSetLayouts = blur_layouts;
+		VK_ASSERT(vkAllocateDescriptorSets(Core::get_device(), &alloc_info, _blur_descriptor_sets), "vkAllocateDescriptorSets(), RendererComputePostProcess - FAILED");
+
+		VkDescriptorSetLayout composite_layouts[2] = { _composite_descriptor_set_layout, _composite_descriptor_set_layout };
+		alloc_info.pSetLayouts = composite_layouts;
+		VK_ASSERT(vkAllocateDescriptorSets(Core::get_device(), &alloc_info, _composite_descriptor_sets), "vkAllocateDescriptorSets(), RendererComputePostProcess - FAILED");
+	}
+
+	{
+		auto sampled = [this](VkImageView view, VkImageLayout layout) {
+			VkDescriptorImageInfo info{};
+			info.imageLayout = layout;
+			info.imageView = view;
+			info.sampler = _sampler;
+			return info;
+		};
+		auto storage = [](VkImageView view) {
+			VkDescriptorImageInfo info{};
+			info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			info.imageView = view;
+			info.sampler = VK_NULL_HANDLE;
+			return info;
+		};
+
+		const VkImageView hdr_view = renderer_create_info.hdr_color_image_view->get_image_view();
+		const VkImageView bloom_view = renderer_create_info.bloom_image_view->get_image_view();
+		const VkImageView blur_views[2] = { _blur_image_views[0]->get_image_view(), _blur_image_views[1]->get_image_view() };
+
+		std::array<VkDescriptorImageInfo, 10> infos{
+			//horizontal blur
+			sampled(bloom_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			storage(blur_views[0]),
+			//vertical blur
+			sampled(blur_views[0], VK_IMAGE_LAYOUT_GENERAL),
+			storage(blur_views[1]),
+			//composite with the blurred bloom
+			sampled(hdr_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			sampled(blur_views[1], VK_IMAGE_LAYOUT_GENERAL),
+			storage(_output_image_view->get_image_view()),
+			//composite with the bloom as it is
+			sampled(hdr_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			sampled(bloom_view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+			storage(_output_image_view->get_image_view())
+		};
+		const VkDescriptorSet sets[10] = {
+			_blur_descriptor_sets[0], _blur_descriptor_sets[0],
+			_blur_descriptor_sets[1], _blur_descriptor_sets[1],
+			_composite_descriptor_sets[0], _composite_descriptor_sets[0], _composite_descriptor_sets[0],
+			_composite_descriptor_sets[1], _composite_descriptor_sets[1], _composite_descriptor_sets[1]
+		};
+		const uint32_t bindings[10] = { 0, 1, 0, 1, 0, 1, 2, 0, 1, 2 };
+
+		std::array<VkWriteDescriptorSet, 10> writes{};
+		for (uint32_t i = 0; i < writes.size(); i++) {
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = infos[i].sampler == VK_NULL_HANDLE ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writes[i].dstArrayElement = 0;
+			writes[i].dstBinding = bindings[i];
+			writes[i].dstSet = sets[i];
+			writes[i].pImageInfo = &infos[i];
+		}
+		vkUpdateDescriptorSets(Core::get_device(), writes.size(), writes.data(), 0, 0);
+	}
+
+	{
+		VkPushConstantRange push_range{};
+		push_range.offset = 0;
+		push_range.size = sizeof(BlurPushConstants);
+		push_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		VkPipelineLayoutCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		create_info.setLayoutCount = 1;
+		create_info.pSetLayouts = &_blur_descriptor_set_layout;
+		create_info.pPushConstantRanges = &push_range;
+		create_info.pushConstantRangeCount = 1;
+		VK_ASSERT(vkCreatePipelineLayout(Core::get_device(), &create_info, nullptr, &_blur_pipeline_layout), "vkCreatePipelineLayout(), RendererComputePostProcess - FAILED.");
+
+		push_range.size = sizeof(float);
+		create_info.pSetLayouts = &_composite_descriptor_set_layout;
+		VK_ASSERT(vkCreatePipelineLayout(Core::get_device(), &create_info, nullptr, &_composite_pipeline_layout), "vkCreatePipelineLayout(), RendererComputePostProcess - FAILED.");
+	}
+}
+
+VkPipeline RendererComputePostProcess::create_compute_pipeline(VkPipelineLayout layout, const char* shader_path) noexcept {
+	VkShaderModule compute_shader = utils::create_shader_module(shader_path);
+
+	VkComputePipelineCreateInfo create_info{};
+	create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	create_info.layout = layout;
+	create_info.stage = utils::set_pipeline_shader_stage(compute_shader, VK_SHADER_STAGE_COMPUTE_BIT);
+
+	VkPipeline pipeline = PipelineCache::create_compute_pipeline(create_info, "RendererComputePostProcess");
+
+	vkDestroyShaderModule(Core::get_device(), compute_shader, nullptr);
+	return pipeline;
+}
+
+void RendererComputePostProcess::blur(VkCommandBuffer command_buffer, uint32_t pass, uint32_t radius) noexcept {
+	const VulkanImage& target = *_blur_images[pass];
+	//the previous frame may still read the target
+	CommandManager::transition_image_layout(command_buffer, target,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, VK_ACCESS_SHADER_WRITE_BIT,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+		color_subresource_range);
+
+	BlurPushConstants push{};
+	push.direction[0] = pass == 0 ? 1 : 0;
+	push.direction[1] = pass == 0 ? 0 : 1;
+	push.radius = radius;
+
+	const uint32_t line_length = pass == 0 ? target.get_width() : target.get_height();
+	const uint32_t line_count = pass == 0 ? target.get_height() : target.get_width();
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _blur_pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _blur_pipeline_layout, 0, 1, &_blur_descriptor_sets[pass], 0, 0);
+	vkCmdPushConstants(command_buffer, _blur_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BlurPushConstants), &push);
+	vkCmdDispatch(command_buffer, (line_length + BLUR_TILE_SIZE - 1) / BLUR_TILE_SIZE, line_count, 1);
+
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+}
+
+void RendererComputePostProcess::fill_command_buffer(VkCommandBuffer command_buffer) {
+	//hdr color and bloom were written by render passes that only wait for fragment shaders
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+	const uint32_t radius = std::clamp(_settings.blur_radius, 0, static_cast<int>(BLUR_MAX_RADIUS));
+	if (radius > 0) {
+		blur(command_buffer, 0, radius);
+		blur(command_buffer, 1, radius);
+	}
+
+	//the previous frame blit may still read the output
+	CommandManager::transition_image_layout(command_buffer, *_output_image,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, VK_ACCESS_SHADER_WRITE_BIT,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+		color_subresource_range);
+
+	const VkDescriptorSet composite_set = _composite_descriptor_sets[radius > 0 ? 0 : 1];
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _composite_pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _composite_pipeline_layout, 0, 1, &composite_set, 0, 0);
+	vkCmdPushConstants(command_buffer, _composite_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(float), &_bloom_settings.intensity);
+	vkCmdDispatch(command_buffer,
+		(_output_image->get_width() + COMPOSITE_GROUP_SIZE - 1) / COMPOSITE_GROUP_SIZE,
+		(_output_image->get_height() + COMPOSITE_GROUP_SIZE - 1) / COMPOSITE_GROUP_SIZE,
+		1);
+
+	CommandManager::transition_image_layout(command_buffer, *_output_image,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+		VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		color_subresource_range);
+}
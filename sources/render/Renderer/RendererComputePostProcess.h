@@ -0,0 +1,70 @@
+#pragma once
+#include "RendererBloom.h"
+
+//GPU profiler scopes of each post-process path
+constexpr const char* POST_PROCESS_FRAGMENT_SCOPE = "Fragment post-process";
+constexpr const char* POST_PROCESS_COMPUTE_SCOPE = "Compute post-process";
+
+//post-process path switch, edited in the gui
+struct PostProcessSettings {
+	bool use_compute = false;
+	//the swapchain must accept transfers and blits
+	bool is_compute_supported = false;
+	//shared memory gaussian over the bloom, 0 disables it
+	int blur_radius = 4;
+};
+
+struct RendererComputePostProcessCreateInfo {
+	const BloomSettings& bloom_settings;
+	const PostProcessSettings& settings;
+	const std::shared_ptr<class VulkanImageView>& hdr_color_image_view;
+	const std::shared_ptr<class VulkanImage>& bloom_image;
+	const std::shared_ptr<class VulkanImageView>& bloom_image_view;
+};
+
+//blurs the bloom and tone maps in compute, the result is left in the transfer source layout
+class RendererComputePostProcess : public RendererBase {
+private:
+	struct BlurPushConstants {
+		int32_t direction[2];
+		int32_t radius;
+	};
+
+	const BloomSettings& _bloom_settings;
+	const PostProcessSettings& _settings;
+
+	//horizontal pass writes the first one, vertical pass the second one
+	std::shared_ptr<VulkanImage> _blur_images[2];
+	std::shared_ptr<VulkanImageView> _blur_image_views[2];
+	std::shared_ptr<VulkanImage> _output_image;
+	std::shared_ptr<VulkanImageView> _output_image_view;
+	VkSampler _sampler;
+
+	VkDescriptorSetLayout _blur_descriptor_set_layout;
+	VkDescriptorSetLayout _composite_descriptor_set_layout;
+	//horizontal and vertical blur
+	VkDescriptorSet _blur_descriptor_sets[2];
+	//with the blurred bloom and with the bloom as it is
+	VkDescriptorSet _composite_descriptor_sets[2];
+
+	VkPipelineLayout _blur_pipeline_layout;
+	VkPipelineLayout _composite_pipeline_layout;
+	VkPipeline _blur_pipeline;
+	VkPipeline _composite_pipeline;
+
+private:
+	void create_images(const RendererComputePostProcessCreateInfo& renderer_create_info);
+	void create_descriptor_tools(const RendererComputePostProcessCreateInfo& renderer_create_info);
+	VkPipeline create_compute_pipeline(VkPipelineLayout layout, const char* shader_path) noexcept;
+	virtual void reload_pipelines();
+	void blur(VkCommandBuffer command_buffer, uint32_t pass, uint32_t radius) noexcept;
+
+public:
+	RendererComputePostProcess(const RendererComputePostProcessCreateInfo& create_info);
+
+	virtual void fill_command_buffer(VkCommandBuffer command_buffer);
+
+	inline const VulkanImage& get_output_image() const noexcept { return *_output_image; }
+
+	~RendererComputePostProcess();
+};
@@ -5,6 +5,9 @@
 #include "Window.h"
 #include "Scene.h"
 #include "MaterialManager.h"
+#include "GpuProfiler.h"
+#include "FrameStatistics.h"
+#include "CpuProfiler.h"
 
 GuiInfo::GuiInfo(float delta_time_, Scene& scene_, const std::shared_ptr<MaterialManager>& material_manager_) :
 	delta_time(delta_time_), scene(scene_), material_manager(material_manager_) {}
@@ -31,7 +34,7 @@ RendererGui::RendererGui(const Window& window, VkRenderPass render_pass, GuiInfo
 	init_info.QueueFamily = Core::get_graphics_queue_family_index();
 	init_info.MinImageCount = capabilities.minImageCount;
 	init_info.RenderPass = render_pass;
-	init_info.Subpass = 1;
+	init_info.Subpass = 0;
 
 	ImGui_ImplVulkan_Init(&init_info);
 	LOG_STATUS("Created RendererGui.");
@@ -60,6 +63,18 @@ void RendererGui::fill_command_buffer(VkCommandBuffer command_buffer) {
 	ImGui::SetNextWindowPos(ImVec2(0.f, 0.f));
 	ImGui::Begin("Information", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_MenuBar );
 	ImGui::Text("FPS: %f \nms: %f", 1000.0f/_gui_info.delta_time, _gui_info.delta_time);
+	ImGui::Text("Draw calls: %u \nTriangles: %u \nPipeline binds: %u \nDescriptor binds: %u \nVertex buffer binds: %u",
+		_gui_info.render_queue_statistics.draw_calls,
+		_gui_info.render_queue_statistics.triangles,
+		_gui_info.render_queue_statistics.pipeline_binds,
+		_gui_info.render_queue_statistics.descriptor_binds,
+		_gui_info.render_queue_statistics.vertex_buffer_binds);
+
+	const TextureStreamingStatistics& streaming = TextureStreamingManager::get_statistics();
+	ImGui::Text("Streamed textures: %u \nTexture memory: %.1f / %.1f MB \nPending requests: %u \nStreamed mips: %u, evicted mips: %u",
+		streaming.textures,
+		streaming.resident_bytes / (1024.f * 1024.f), streaming.budget_bytes / (1024.f * 1024.f),
+		streaming.pending_requests, streaming.streamed_mips, streaming.evicted_mips);
 
 	ImGui::Separator();
 	ImGui::Checkbox("Show scene info", &_gui_info.show_scene_info);
@@ -73,6 +88,44 @@ void RendererGui::fill_command_buffer(VkCommandBuffer command_buffer) {
 		_gui_info.material_manager->show_materials_gui_info();
 	}
 
+	ImGui::Separator();
+	ImGui::Checkbox("Show bloom settings", &_gui_info.show_bloom_settings);
+	if (_gui_info.show_bloom_settings) {
+		BloomSettings& bloom = _gui_info.bloom;
+		ImGui::SliderInt("Iterations", &bloom.iterations, 1, bloom.max_iterations);
+		ImGui::DragFloat("Threshold", &bloom.threshold, 0.01f, 0.f, 100.f);
+		ImGui::DragFloat("Knee", &bloom.knee, 0.01f, 0.f, 10.f);
+		ImGui::DragFloat("Radius", &bloom.radius, 0.01f, 0.f, 4.f);
+		ImGui::DragFloat("Intensity", &bloom.intensity, 0.005f, 0.f, 10.f);
+	}
+
+	ImGui::Separator();
+	PostProcessSettings& post_process = _gui_info.post_process;
+	if (post_process.is_compute_supported) {
+		ImGui::Checkbox("Compute post-process", &post_process.use_compute);
+		ImGui::SliderInt("Bloom blur radius", &post_process.blur_radius, 0, 16);
+	}
+	ImGui::Text("Post-process GPU time \nfragment: %.3f ms \ncompute: %.3f ms",
+		GpuProfiler::get_last_time(POST_PROCESS_FRAGMENT_SCOPE), GpuProfiler::get_last_time(POST_PROCESS_COMPUTE_SCOPE));
+
+	ImGui::Separator();
+	ImGui::Checkbox("Show frame statistics", &_gui_info.show_frame_statistics);
+	if (_gui_info.show_frame_statistics) {
+		FrameStatistics::show_gui();
+	}
+
+	ImGui::Separator();
+	ImGui::Checkbox("Show GPU profiler", &_gui_info.show_gpu_profiler);
+	if (_gui_info.show_gpu_profiler) {
+		GpuProfiler::show_gui();
+	}
+#ifdef CPU_PROFILER
+	ImGui::Checkbox("Show CPU profiler", &_gui_info.show_cpu_profiler);
+	if (_gui_info.show_cpu_profiler) {
+		CpuProfiler::show_gui();
+	}
+#endif
+
 	ImGui::End();
 
 	ImGui::EndFrame();
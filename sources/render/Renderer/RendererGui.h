@@ -1,6 +1,8 @@
 #pragma once
 
 #include "RendererBase.h"
+#include "RenderQueue.h"
+#include "RendererComputePostProcess.h"
 #include <memory>
 
 struct GuiInfo {
@@ -9,6 +11,13 @@ struct GuiInfo {
 	bool show_scene_info = false;
 	std::shared_ptr<class MaterialManager> material_manager;
 	bool show_material_info = false;
+	RenderQueueStatistics render_queue_statistics;
+	bool show_bloom_settings = false;
+	BloomSettings bloom;
+	PostProcessSettings post_process;
+	bool show_frame_statistics = false;
+	bool show_gpu_profiler = false;
+	bool show_cpu_profiler = false;
 	GuiInfo(float delta_time_, Scene& scene_, const std::shared_ptr<MaterialManager>& material_manager_);
 };
 
@@ -1,23 +1,113 @@
 #include "RendererLight.h"
 #include "Scene.h"
+#include "PipelineCache.h"
+#include "Camera.h"
+#include "CpuProfiler.h"
 #include <array>
 
 const std::string vertex_shader_spv_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/light_source_vert.spv";
 const std::string fragment_shader_spv_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/light_source_frag.spv";
 
 RendererLightSource::RendererLightSource(const RendererLightSourceCreateInfo& renderer_create_info) :
-	_scene(renderer_create_info.scene) {
+	_scene(renderer_create_info.scene),
+	_camera(renderer_create_info.camera),
+	_render_pass(renderer_create_info.render_pass),
+	_color_attachment_count(renderer_create_info.color_attachment_count) {
+	create_buffers();
 	create_descriptor_tools(renderer_create_info);
-	create_graphics_pipeline(renderer_create_info);
+	create_graphics_pipeline();
+	watch_shaders({ vertex_shader_spv_path, fragment_shader_spv_path });
 	LOG_STATUS("Created RendererLightSource.");
 }
 
+void RendererLightSource::reload_pipelines() {
+	ShaderManager::retire(_graphics_pipeline);
+	create_graphics_pipeline();
+}
+
+RendererLightSource::~RendererLightSource() {
+	vkDestroyDescriptorSetLayout(Core::get_device(), _descriptor_set_layout, nullptr);
+	for (VulkanBuffer* buffer : _light_buffers) {
+		delete buffer;
+	}
+}
+
 void RendererLightSource::fill_command_buffer(VkCommandBuffer command_buffer) {
+	PROFILE_FUNCTION();
+	const float aspect = static_cast<float>(Core::get_swapchain_width()) / static_cast<float>(Core::get_swapchain_height());
+	_scene->get_visible_lights(Frustum(CameraBase::get_projection_matrix(aspect) * _camera.get_view_matrix()), _visible_lights);
+	if (_visible_lights.empty()) {
+		return;
+	}
+
+	//the frame fence was waited, the host writes are visible to the submission
+	memcpy(_light_buffer_ptrs[Core::get_current_frame()], _visible_lights.data(), _visible_lights.size() * sizeof(PointLightData));
+
 	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphics_pipeline);
-	_scene->draw_light(command_buffer, _pipeline_layout);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+		_pipeline_layout, 1, 1, &_descriptor_sets[Core::get_current_frame()], 0, 0);
+	vkCmdDraw(command_buffer, 6, _visible_lights.size(), 0, 0);
+}
+
+void RendererLightSource::create_buffers() {
+	const uint32_t image_count = Core::get_swapchain_image_count();
+	_light_buffers.reserve(image_count);
+	_light_buffer_ptrs.reserve(image_count);
+	for (uint32_t i = 0; i < image_count; i++) {
+		_light_buffers.push_back(new VulkanBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			sizeof(PointLightData) * LIGHT_SOURCE_LIMIT,
+			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+		_light_buffer_ptrs.push_back(_light_buffers.back()->map_memory(0, VK_WHOLE_SIZE));
+	}
 }
 
 void RendererLightSource::create_descriptor_tools(const RendererLightSourceCreateInfo& renderer_create_info) {
+	const uint32_t image_count = Core::get_swapchain_image_count();
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorCount = 1;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+	VkDescriptorSetLayoutCreateInfo layout_create_info{};
+	layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layout_create_info.bindingCount = 1;
+	layout_create_info.pBindings = &binding;
+	VK_ASSERT(vkCreateDescriptorSetLayout(Core::get_device(), &layout_create_info, nullptr, &_descriptor_set_layout), "vkCreateDescriptorSetLayout(), RendererLightSource - FAILED");
+
+	VkDescriptorPoolSize pool_size{};
+	pool_size.descriptorCount = image_count;
+	pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	VkDescriptorPoolCreateInfo pool_create_info{};
+	pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	pool_create_info.pPoolSizes = &pool_size;
+	pool_create_info.poolSizeCount = 1;
+	pool_create_info.maxSets = image_count;
+	VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &pool_create_info, nullptr, &_descriptor_pool), "vkCreateDescriptorPool(), RendererLightSource - FAILED");
+
+	_descriptor_sets.resize(image_count);
+	std::vector<VkDescriptorSetLayout> set_layouts(image_count, _descriptor_set_layout);
+	VkDescriptorSetAllocateInfo alloc_info{};
+	alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	alloc_info.descriptorPool = _descriptor_pool;
+	alloc_info.descriptorSetCount = image_count;
+	alloc_info.pSetLayouts = set_layouts.data();
+	VK_ASSERT(vkAllocateDescriptorSets(Core::get_device(), &alloc_info, _descriptor_sets.data()), "vkAllocateDescriptorSets() - FAILED");
+
+	std::vector<VkDescriptorBufferInfo> buffer_infos(image_count);
+	std::vector<VkWriteDescriptorSet> write_descriptors(image_count);
+	for (uint32_t i = 0; i < image_count; i++) {
+		buffer_infos[i] = _light_buffers[i]->get_info(0, VK_WHOLE_SIZE);
+		write_descriptors[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write_descriptors[i].dstSet = _descriptor_sets[i];
+		write_descriptors[i].dstBinding = 0;
+		write_descriptors[i].dstArrayElement = 0;
+		write_descriptors[i].descriptorCount = 1;
+		write_descriptors[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write_descriptors[i].pBufferInfo = &buffer_infos[i];
+	}
+	vkUpdateDescriptorSets(Core::get_device(), write_descriptors.size(), write_descriptors.data(), 0, 0);
+
 	VkPushConstantRange push_range{};
 	push_range.offset = 0;
 	push_range.size = sizeof(glm::vec3);
@@ -25,7 +115,7 @@ void RendererLightSource::create_descriptor_tools(const RendererLightSourceCreat
 
 	VkDescriptorSetLayout layouts[2] = {
 		renderer_create_info.global_UBO_descriptor_set_layout,
-		_scene->get_descriptor_set_layout()
+		_descriptor_set_layout
 	};
 	VkPipelineLayoutCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -37,7 +127,7 @@ void RendererLightSource::create_descriptor_tools(const RendererLightSourceCreat
 	LOG_STATUS("Created RendererLightSource pipeline layout.");
 }
 
-void RendererLightSource::create_graphics_pipeline(const RendererLightSourceCreateInfo& renderer_create_info) {
+void RendererLightSource::create_graphics_pipeline() {
 	VkShaderModule vertex_shader = utils::create_shader_module(vertex_shader_spv_path.c_str()),
 		fragment_shader = utils::create_shader_module(fragment_shader_spv_path.c_str());
 
@@ -57,16 +147,18 @@ void RendererLightSource::create_graphics_pipeline(const RendererLightSourceCrea
 	auto dynamic = utils::set_pipeline_dynamic_state(dynamic_states);
 	auto rasterization = utils::set_pipeline_rasterization_state(VK_CULL_MODE_NONE);
 	auto multisample = utils::set_pipeline_multisample_state();
-	auto depth = utils::set_pipeline_depth_stencil_state();
+	//the sprites are hidden behind the meshes
+	auto depth = utils::set_pipeline_depth_stencil_state(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS);
 	auto color_blend_attachment = utils::set_pipeline_color_blend_attachment_state();
-	std::vector<VkPipelineColorBlendAttachmentState> color_blend_attachments(2,color_blend_attachment);
+	//the light sources clear the object id under them
+	std::vector<VkPipelineColorBlendAttachmentState> color_blend_attachments(_color_attachment_count, color_blend_attachment);
 	auto color_blend = utils::set_pipeline_color_blend_state(color_blend_attachments);
 
 	VkGraphicsPipelineCreateInfo create_info{};
 	create_info.layout = _pipeline_layout;
 	create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	create_info.subpass = 0;
-	create_info.renderPass = renderer_create_info.render_pass;
+	create_info.renderPass = _render_pass;
 	create_info.pStages = shader_stages.data();
 	create_info.stageCount = shader_stages.size();
 
@@ -80,7 +172,7 @@ void RendererLightSource::create_graphics_pipeline(const RendererLightSourceCrea
 	create_info.pDepthStencilState = &depth;
 	create_info.pColorBlendState = &color_blend;
 
-	VK_ASSERT(vkCreateGraphicsPipelines(Core::get_device(), nullptr, 1, &create_info, nullptr, &_graphics_pipeline), "vkCreateGraphicsPipelines() RendererLightSource - FAILED");
+	_graphics_pipeline = PipelineCache::create_graphics_pipeline(create_info, "RendererLightSource");
 	LOG_STATUS("Created RendererLightSource graphics pipeline.");
 
 	vkDestroyShaderModule(Core::get_device(), vertex_shader, nullptr);
@@ -1,21 +1,39 @@
 #pragma once
 
 #include "RendererBase.h"
+#include "SceneObject.h"
 
 struct RendererLightSourceCreateInfo {
 	const std::shared_ptr<class Scene>& scene;
+	const class CameraBase& camera;
 	VkDescriptorSetLayout global_UBO_descriptor_set_layout;
 	VkRenderPass render_pass;
+	uint32_t color_attachment_count;
 };
 
+//draws a depth tested sprite of 6 vertices per light in the frustum,
+//the culled lights are written to a mapped storage buffer of the frame and drawn as instances
 class RendererLightSource : public RendererBaseExt{
 private:
 	const std::shared_ptr<class Scene>& _scene;
+	const class CameraBase& _camera;
+	VkRenderPass _render_pass;
+	uint32_t _color_attachment_count;
+
+	VkDescriptorSetLayout _descriptor_set_layout;
+	std::vector<VkDescriptorSet> _descriptor_sets;
+	std::vector<VulkanBuffer*> _light_buffers;
+	std::vector<char*> _light_buffer_ptrs;
+	std::vector<PointLightData> _visible_lights;
 private:
+	void create_buffers();
 	void create_descriptor_tools(const RendererLightSourceCreateInfo& renderer_create_info);
-	void create_graphics_pipeline(const RendererLightSourceCreateInfo& renderer_create_info);
+	void create_graphics_pipeline();
+	virtual void reload_pipelines();
 public:
 	RendererLightSource(const RendererLightSourceCreateInfo& renderer_create_info);
 
 	virtual void fill_command_buffer(VkCommandBuffer command_buffer);
+
+	~RendererLightSource();
 };
\ No newline at end of file
@@ -1,16 +1,27 @@
 #include "RendererPostProcess.h"
 #include "VulkanDataObjects.h"
+#include "PipelineCache.h"
+#include <array>
 
 const std::string quad_shader_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/quad.spv";
 const std::string post_process_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/post_process.spv";
 
-RendererPostProcess::RendererPostProcess(const RendererPostProcessCreateInfo& renderer_create_info) {
+RendererPostProcess::RendererPostProcess(const RendererPostProcessCreateInfo& renderer_create_info) :
+	_bloom_settings(renderer_create_info.bloom_settings),
+	_render_pass(renderer_create_info.render_pass) {
 	create_descriptor_tools(renderer_create_info);
-	create_graphics_pipeline(renderer_create_info);
+	create_graphics_pipeline();
+	watch_shaders({ quad_shader_path, post_process_path });
 	LOG_STATUS("Created RendererPostProcess.");
 }
 
+void RendererPostProcess::reload_pipelines() {
+	ShaderManager::retire(_graphics_pipeline);
+	create_graphics_pipeline();
+}
+
 RendererPostProcess::~RendererPostProcess() {
+	vkDestroySampler(Core::get_device(), _bloom_sampler, nullptr);
 	vkDestroyDescriptorSetLayout(Core::get_device(), _descriptor_set_layout, nullptr);
 }
 
@@ -31,6 +42,21 @@ std::vector<VkDescriptorSetLayoutBinding> RendererPostProcess::get_bindings() no
 }
 
 void RendererPostProcess::create_descriptor_tools(const RendererPostProcessCreateInfo& renderer_create_info) {
+	{
+		//bloom is half resolution, filter it up
+		VkSamplerCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		create_info.magFilter = VK_FILTER_LINEAR;
+		create_info.minFilter = VK_FILTER_LINEAR;
+		create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		create_info.maxLod = 0.f;
+		create_info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+		VK_ASSERT(vkCreateSampler(Core::get_device(), &create_info, nullptr, &_bloom_sampler), "vkCreateSampler(), RendererPostProcess - FAILED");
+	}
+
 	{
 		auto bindings = get_bindings();
 		VkDescriptorSetLayoutCreateInfo create_info{};
@@ -41,14 +67,16 @@ void RendererPostProcess::create_descriptor_tools(const RendererPostProcessCreat
 	}
 
 	{
-		VkDescriptorPoolSize pool_size{};
-		pool_size.descriptorCount = 1;
-		pool_size.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		std::array<VkDescriptorPoolSize, 2> pool_sizes{};
+		pool_sizes[0].descriptorCount = 1;
+		pool_sizes[0].type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		pool_sizes[1].descriptorCount = 1;
+		pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 
 		VkDescriptorPoolCreateInfo create_info{};
 		create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		create_info.pPoolSizes = &pool_size;
-		create_info.poolSizeCount = 1;
+		create_info.pPoolSizes = pool_sizes.data();
+		create_info.poolSizeCount = pool_sizes.size();
 		create_info.maxSets = 1;
 		VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &create_info, nullptr, &_descriptor_pool), "vkCreateDescriptorPool(), RendererPostProcess - FAILED");
 
@@ -64,7 +92,10 @@ void RendererPostProcess::create_descriptor_tools(const RendererPostProcessCreat
 		color_image_info.imageView = renderer_create_info.hdr_color_image_view->get_image_view();
 		color_image_info.sampler = VK_NULL_HANDLE;
 
-		auto bright_color_image_info = renderer_create_info.staging_color_image->get_info(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		VkDescriptorImageInfo bloom_image_info{};
+		bloom_image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		bloom_image_info.imageView = renderer_create_info.bloom_image_view->get_image_view();
+		bloom_image_info.sampler = _bloom_sampler;
 
 		VkWriteDescriptorSet write[2]{};
 		write[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -81,23 +112,28 @@ void RendererPostProcess::create_descriptor_tools(const RendererPostProcessCreat
 		write[1].dstArrayElement = 0;
 		write[1].dstBinding = 1;
 		write[1].dstSet = _descriptor_set;
-		write[1].pImageInfo = &bright_color_image_info;
+		write[1].pImageInfo = &bloom_image_info;
 
 		vkUpdateDescriptorSets(Core::get_device(), 2, write, 0, 0);
 	}
 
 	{
+		VkPushConstantRange push_range{};
+		push_range.offset = 0;
+		push_range.size = sizeof(float);
+		push_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
 		VkPipelineLayoutCreateInfo create_info{};
 		create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		create_info.setLayoutCount = 1;
 		create_info.pSetLayouts = &_descriptor_set_layout;
-		create_info.pPushConstantRanges = nullptr;
-		create_info.pushConstantRangeCount = 0;
+		create_info.pPushConstantRanges = &push_range;
+		create_info.pushConstantRangeCount = 1;
 		VK_ASSERT(vkCreatePipelineLayout(Core::get_device(), &create_info, nullptr, &_pipeline_layout), "vkCreatePipelineLayout(), RendererPostProcess - FAILED.");
 	}
 }
 
-void RendererPostProcess::create_graphics_pipeline(const RendererPostProcessCreateInfo& renderer_create_info) noexcept {
+void RendererPostProcess::create_graphics_pipeline() noexcept {
 	VkShaderModule vertex_shader = utils::create_shader_module(quad_shader_path.c_str()),
 		fragment_shader = utils::create_shader_module(post_process_path.c_str());
 
@@ -124,8 +160,7 @@ void RendererPostProcess::create_graphics_pipeline(const RendererPostProcessCrea
 	create_info.layout = _pipeline_layout;
 	create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	create_info.subpass = 0;
-	create_info.renderPass = renderer_create_info.render_pass;
-	create_info.subpass = 1;
+	create_info.renderPass = _render_pass;
 	create_info.pStages = shader_stages;
 	create_info.stageCount = 2;
 
@@ -139,7 +174,7 @@ void RendererPostProcess::create_graphics_pipeline(const RendererPostProcessCrea
 	create_info.pDepthStencilState = &depth;
 	create_info.pColorBlendState = &color_blend;
 
-	VK_ASSERT(vkCreateGraphicsPipelines(Core::get_device(), nullptr, 1, &create_info, nullptr, &_graphics_pipeline), "vkCreateGraphicsPipelines() RendererBlur - FAILED");
+	_graphics_pipeline = PipelineCache::create_graphics_pipeline(create_info, "RendererPostProcess");
 
 	vkDestroyShaderModule(Core::get_device(), vertex_shader, nullptr);
 	vkDestroyShaderModule(Core::get_device(), fragment_shader, nullptr);
@@ -148,5 +183,6 @@ void RendererPostProcess::create_graphics_pipeline(const RendererPostProcessCrea
 void RendererPostProcess::fill_command_buffer(VkCommandBuffer command_buffer) {
 	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphics_pipeline);
 	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline_layout, 0, 1, &_descriptor_set, 0, 0);
+	vkCmdPushConstants(command_buffer, _pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(float), &_bloom_settings.intensity);
 	vkCmdDraw(command_buffer, 6, 1, 0, 0);
 }
\ No newline at end of file
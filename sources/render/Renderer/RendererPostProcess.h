@@ -1,19 +1,25 @@
 #pragma once
-#include "RendererBase.h"
+#include "RendererBloom.h"
 
 struct RendererPostProcessCreateInfo {
 	VkRenderPass render_pass;
+	const BloomSettings& bloom_settings;
 	const std::shared_ptr<class VulkanImageView>& hdr_color_image_view;
-	const std::shared_ptr<class VulkanTexture2D>& staging_color_image;
+	const std::shared_ptr<class VulkanImageView>& bloom_image_view;
 };
 
 class RendererPostProcess : public RendererBaseExt {
-	//hdr color input attachment
+	const BloomSettings& _bloom_settings;
+
+	//hdr color input attachment and bloom combined image sampler
 	VkDescriptorSetLayout _descriptor_set_layout;
 	VkDescriptorSet _descriptor_set;
+	VkSampler _bloom_sampler;
+	VkRenderPass _render_pass;
 private:
 	void create_descriptor_tools(const RendererPostProcessCreateInfo& renderer_create_info);
-	void create_graphics_pipeline(const RendererPostProcessCreateInfo& renderer_create_info) noexcept;
+	void create_graphics_pipeline() noexcept;
+	virtual void reload_pipelines();
 
 public:
 	RendererPostProcess(const RendererPostProcessCreateInfo& renderer_create_info);
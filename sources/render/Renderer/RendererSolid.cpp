@@ -5,17 +5,57 @@
 #include "RenderManager.h"
 #include "RendererGui.h"
 #include "MaterialManager.h"
+#include "EnvironmentLighting.h"
+#include "Camera.h"
+#include "PipelineCache.h"
+#include "CpuProfiler.h"
 #include <array>
 
 const std::string vertex_shader_spv_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/solid_vert.spv";
 const std::string fragment_shader_spv_path = std::string(RENDERER_DIRECTORY) + "/shaders/spir-v/solid_frag.spv";
 
-RendererSolid::RendererSolid(const RendererSolidCreateInfo& create_info) : _scene(create_info.scene){
+SolidPermutation::SolidPermutation(uint32_t material_features, uint32_t point_light_count_) noexcept :
+	albedo_texture((material_features & MATERIAL_FEATURE_ALBEDO_TEXTURE) != 0),
+	metallic_texture((material_features & MATERIAL_FEATURE_METALLIC_TEXTURE) != 0),
+	roughness_texture((material_features & MATERIAL_FEATURE_ROUGHNESS_TEXTURE) != 0),
+	normal_map((material_features & MATERIAL_FEATURE_NORMAL_MAP) != 0),
+	point_light_count(point_light_count_) {}
+
+uint32_t SolidPermutation::get_key() const noexcept {
+	return albedo_texture | (metallic_texture << 1) | (roughness_texture << 2) | (normal_map << 3) | (point_light_count << 4);
+}
+
+RendererSolid::RendererSolid(const RendererSolidCreateInfo& create_info) :
+	_scene(create_info.scene),
+	_material_manager(create_info.material_manager),
+	_camera(create_info.camera),
+	_gui_info(create_info.gui_info),
+	_environment_lighting(create_info.environment_lighting),
+	_render_pass(create_info.render_pass),
+	_color_attachment_count(create_info.color_attachment_count),
+	_vertex_shader(utils::create_shader_module(vertex_shader_spv_path.c_str())),
+	_fragment_shader(utils::create_shader_module(fragment_shader_spv_path.c_str())) {
 	create_descriptor_tools(create_info);
-	create_pipeline(create_info);
+	//the permutations of the materials loaded so far are created with the other pipelines
+	update_material_pipelines();
+	watch_shaders({ vertex_shader_spv_path, fragment_shader_spv_path });
 	LOG_STATUS("Created RendererSolid.");
 }
 
+void RendererSolid::reload_pipelines() {
+	for (const auto& [key, material_pipeline] : _permutations) {
+		ShaderManager::retire(material_pipeline.pipeline);
+	}
+	_permutations.clear();
+	_material_pipelines.clear();
+
+	vkDestroyShaderModule(Core::get_device(), _vertex_shader, nullptr);
+	vkDestroyShaderModule(Core::get_device(), _fragment_shader, nullptr);
+	_vertex_shader = utils::create_shader_module(vertex_shader_spv_path.c_str());
+	_fragment_shader = utils::create_shader_module(fragment_shader_spv_path.c_str());
+	update_material_pipelines();
+}
+
 void RendererSolid::create_descriptor_tools(const RendererSolidCreateInfo& renderer_create_info) {
 	{
 		std::array<VkDescriptorPoolSize, 1> pool_sizes{};
@@ -37,15 +77,16 @@ void RendererSolid::create_descriptor_tools(const RendererSolidCreateInfo& rende
 		push_range.size = sizeof(glm::vec3);
 		push_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-		VkDescriptorSetLayout layouts[3] = { 
+		VkDescriptorSetLayout layouts[4] = { 
 			renderer_create_info.render_unit_set_layout,
 			_scene->get_descriptor_set_layout(),
-			renderer_create_info.material_manager->get_descriptor_set_layout()
+			renderer_create_info.material_manager->get_descriptor_set_layout(),
+			_environment_lighting->get_descriptor_set_layout()
 		};
 		VkPipelineLayoutCreateInfo create_info{};
 		create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		create_info.pSetLayouts = layouts;
-		create_info.setLayoutCount = 3;
+		create_info.setLayoutCount = 4;
 		create_info.pPushConstantRanges = &push_range;
 		create_info.pushConstantRangeCount = 1;
 		VK_ASSERT(vkCreatePipelineLayout(Core::get_device(), &create_info, nullptr, &_pipeline_layout), "vkCreatePipelineLayout() RendererSolid - FAILED");
@@ -53,14 +94,26 @@ void RendererSolid::create_descriptor_tools(const RendererSolidCreateInfo& rende
 	}
 }
 
-void RendererSolid::create_pipeline(const RendererSolidCreateInfo& renderer_create_info) {
-	VkShaderModule vertex_shader = utils::create_shader_module(vertex_shader_spv_path.c_str()),
-		fragment_shader = utils::create_shader_module(fragment_shader_spv_path.c_str());
+VkPipeline RendererSolid::create_pipeline(const SolidPermutation& permutation) {
+	std::array<VkSpecializationMapEntry, 5> map_entries{};
+	for (uint32_t i = 0; i < map_entries.size(); i++) {
+		map_entries[i].constantID = i;
+		map_entries[i].offset = i * sizeof(uint32_t);
+		map_entries[i].size = sizeof(uint32_t);
+	}
+	static_assert(sizeof(SolidPermutation) == sizeof(uint32_t) * 5, "SolidPermutation must match the constant ids.");
+
+	VkSpecializationInfo specialization_info{};
+	specialization_info.mapEntryCount = map_entries.size();
+	specialization_info.pMapEntries = map_entries.data();
+	specialization_info.dataSize = sizeof(SolidPermutation);
+	specialization_info.pData = &permutation;
 
 	std::array<VkPipelineShaderStageCreateInfo, 2> shader_stages{
-		utils::set_pipeline_shader_stage(vertex_shader,VK_SHADER_STAGE_VERTEX_BIT),
-		utils::set_pipeline_shader_stage(fragment_shader,VK_SHADER_STAGE_FRAGMENT_BIT)
+		utils::set_pipeline_shader_stage(_vertex_shader,VK_SHADER_STAGE_VERTEX_BIT),
+		utils::set_pipeline_shader_stage(_fragment_shader,VK_SHADER_STAGE_FRAGMENT_BIT)
 	};
+	shader_stages[1].pSpecializationInfo = &specialization_info;
 
 	auto input_assembly = utils::set_pipeline_input_assembly_state(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 	std::vector<VkVertexInputAttributeDescription> attributes = Vertex::get_attribute_description();
@@ -73,14 +126,15 @@ void RendererSolid::create_pipeline(const RendererSolidCreateInfo& renderer_crea
 	auto multisample = utils::set_pipeline_multisample_state();
 	auto depth = utils::set_pipeline_depth_stencil_state();
 	auto color_blend_attachment = utils::set_pipeline_color_blend_attachment_state();
-	std::vector<VkPipelineColorBlendAttachmentState> color_blend_attachments(2,color_blend_attachment);
+	//the object id is written as is
+	std::vector<VkPipelineColorBlendAttachmentState> color_blend_attachments(_color_attachment_count, color_blend_attachment);
 	auto color_blend = utils::set_pipeline_color_blend_state(color_blend_attachments);
 
 	VkGraphicsPipelineCreateInfo create_info{};
 	create_info.layout = _pipeline_layout;
 	create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	create_info.subpass = 0;
-	create_info.renderPass = renderer_create_info.render_pass;
+	create_info.renderPass = _render_pass;
 	create_info.pStages = shader_stages.data();
 	create_info.stageCount = shader_stages.size();
 	
@@ -94,16 +148,53 @@ void RendererSolid::create_pipeline(const RendererSolidCreateInfo& renderer_crea
 	create_info.pDepthStencilState = &depth;
 	create_info.pColorBlendState = &color_blend;
 
-	VK_ASSERT(vkCreateGraphicsPipelines(Core::get_device(), nullptr, 1, &create_info, nullptr, &_graphics_pipeline), "vkCreateGraphicsPipelines() RendererSolid - FAILED");
-	LOG_STATUS("Created RendererSolid graphics pipeline.");
+	VkPipeline pipeline = PipelineCache::create_graphics_pipeline(create_info, "RendererSolid");
+	LOG_STATUS("Created RendererSolid graphics pipeline, permutation: ", permutation.get_key());
+	return pipeline;
+}
+
+const MaterialPipeline& RendererSolid::get_permutation(const SolidPermutation& permutation) {
+	auto it = _permutations.find(permutation.get_key());
+	if (it == _permutations.end()) {
+		//ids follow the creation order, the sort key has 8 bits for them
+		MaterialPipeline material_pipeline{ create_pipeline(permutation), static_cast<uint32_t>(_permutations.size()) };
+		it = _permutations.emplace(permutation.get_key(), material_pipeline).first;
+	}
+	return it->second;
+}
 
-	vkDestroyShaderModule(Core::get_device(), vertex_shader, nullptr);
-	vkDestroyShaderModule(Core::get_device(), fragment_shader, nullptr);
+void RendererSolid::update_material_pipelines() {
+	const uint32_t material_count = _material_manager->get_material_count();
+	const uint32_t point_light_count = _scene->get_point_light_count();
+	if (material_count == _material_pipelines.size() && point_light_count == _point_light_count) {
+		return;
+	}
+
+	_point_light_count = point_light_count;
+	_material_pipelines.resize(material_count);
+	for (uint32_t i = 0; i < material_count; i++) {
+		_material_pipelines[i] = get_permutation(SolidPermutation(_material_manager->get_material_features(i), point_light_count));
+	}
 }
 
 void RendererSolid::fill_command_buffer(VkCommandBuffer command_buffer) {
-	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphics_pipeline);
-	_scene->draw_solid(command_buffer, _pipeline_layout);
+	PROFILE_FUNCTION();
+	update_material_pipelines();
+	_render_queue.clear();
+	const float aspect = static_cast<float>(Core::get_swapchain_width()) / static_cast<float>(Core::get_swapchain_height());
+	_scene->fill_render_queue(_render_queue, _material_pipelines, _camera.get_view_matrix(), CameraBase::get_projection_matrix(aspect));
+	_render_queue.sort();
+	//the render queue rebinds only the group and material sets
+	VkDescriptorSet environment_set = _environment_lighting->get_descriptor_set();
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline_layout, 3, 1, &environment_set, 0, 0);
+	_render_queue.submit(command_buffer, _pipeline_layout);
+	_gui_info.render_queue_statistics = _render_queue.get_statistics();
 }
 
-RendererSolid::~RendererSolid() {}
\ No newline at end of file
+RendererSolid::~RendererSolid() {
+	for (const auto& [key, material_pipeline] : _permutations) {
+		vkDestroyPipeline(Core::get_device(), material_pipeline.pipeline, nullptr);
+	}
+	vkDestroyShaderModule(Core::get_device(), _vertex_shader, nullptr);
+	vkDestroyShaderModule(Core::get_device(), _fragment_shader, nullptr);
+}
\ No newline at end of file
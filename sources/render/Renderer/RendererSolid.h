@@ -1,20 +1,61 @@
 #pragma once
 
 #include "RendererBase.h"
+#include "RenderQueue.h"
+#include <unordered_map>
 
 struct RendererSolidCreateInfo {
 	VkRenderPass render_pass;
+	//the object id attachment follows the hdr color
+	uint32_t color_attachment_count;
 	VkDescriptorSetLayout render_unit_set_layout;
 	const std::shared_ptr<class MaterialManager>& material_manager;
+	const std::shared_ptr<class EnvironmentLighting>& environment_lighting;
 	const std::shared_ptr<class Scene>& scene;
+	const class CameraBase& camera;
+	struct GuiInfo& gui_info;
+};
+
+//specialization constants of solid.frag in the order of their constant_id
+struct SolidPermutation {
+	VkBool32 albedo_texture;
+	VkBool32 metallic_texture;
+	VkBool32 roughness_texture;
+	VkBool32 normal_map;
+	uint32_t point_light_count;
+
+	SolidPermutation(uint32_t material_features, uint32_t point_light_count) noexcept;
+	//material features in the low 4 bits, the light count above them
+	uint32_t get_key() const noexcept;
 };
 
 class RendererSolid : public RendererBaseExt {
 private:
 	const std::shared_ptr<class Scene>& _scene;
+	const std::shared_ptr<class MaterialManager> _material_manager;
+	const class CameraBase& _camera;
+	struct GuiInfo& _gui_info;
+	const std::shared_ptr<class EnvironmentLighting> _environment_lighting;
+
+	VkRenderPass _render_pass;
+	uint32_t _color_attachment_count;
+	//kept for the permutations created later
+	VkShaderModule _vertex_shader;
+	VkShaderModule _fragment_shader;
+
+	//permutation key - pipeline and its id in the sort key, created when a material needs it
+	std::unordered_map<uint32_t, MaterialPipeline> _permutations;
+	//per material, rebuilt when materials or lights are added
+	std::vector<MaterialPipeline> _material_pipelines;
+	uint32_t _point_light_count = 0;
+
+	RenderQueue _render_queue;
 private:
 	void create_descriptor_tools(const RendererSolidCreateInfo& create_info);
-	void create_pipeline(const RendererSolidCreateInfo& create_info);
+	VkPipeline create_pipeline(const SolidPermutation& permutation);
+	const MaterialPipeline& get_permutation(const SolidPermutation& permutation);
+	void update_material_pipelines();
+	virtual void reload_pipelines();
 public:
 	RendererSolid(const RendererSolidCreateInfo& create_info);
 
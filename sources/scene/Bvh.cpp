@@ -0,0 +1,296 @@
+#include "Bvh.h"
+#include <algorithm>
+
+constexpr uint32_t BVH_BIN_COUNT = 16;
+constexpr uint32_t BVH_MAX_LEAF_SIZE = 4;
+constexpr uint32_t BVH_REBUILD_INTERVAL = 120;
+//cost of a node visit relative to an item test
+constexpr float BVH_TRAVERSAL_COST = 1.f;
+
+Aabb Aabb::transform(const glm::mat4& matrix) const noexcept {
+	if (!is_valid()) {
+		return Aabb{};
+	}
+	//Arvo: every axis of the matrix moves the bounds by its smallest and largest contribution
+	Aabb result;
+	result.min = result.max = glm::vec3(matrix[3]);
+	for (int axis = 0; axis < 3; axis++) {
+		const glm::vec3 a = glm::vec3(matrix[axis]) * min[axis];
+		const glm::vec3 b = glm::vec3(matrix[axis]) * max[axis];
+		result.min += glm::min(a, b);
+		result.max += glm::max(a, b);
+	}
+	return result;
+}
+
+Frustum::Frustum(const glm::mat4& view_projection) noexcept {
+	//Gribb and Hartmann, rows of the column major matrix
+	const glm::vec4 row0(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+	const glm::vec4 row1(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+	const glm::vec4 row2(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+	const glm::vec4 row3(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	//-1..1 depth of glm::perspective, a bit conservative for 0..1
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+	for (glm::vec4& plane : planes) {
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+FrustumTest Frustum::test(const Aabb& box) const noexcept {
+	const glm::vec3 center = box.get_center();
+	const glm::vec3 extent = box.max - center;
+	FrustumTest result = FrustumTest::INSIDE;
+	for (const glm::vec4& plane : planes) {
+		const glm::vec3 normal(plane);
+		const float distance = glm::dot(normal, center) + plane.w;
+		const float radius = glm::dot(glm::abs(normal), extent);
+		if (distance < -radius) {
+			return FrustumTest::OUTSIDE;
+		}
+		if (distance < radius) {
+			result = FrustumTest::INTERSECTS;
+		}
+	}
+	return result;
+}
+
+float intersect_ray(const Ray& ray, const glm::vec3& inverse_direction, const Aabb& box, float max_distance) noexcept {
+	const glm::vec3 t0 = (box.min - ray.origin) * inverse_direction;
+	const glm::vec3 t1 = (box.max - ray.origin) * inverse_direction;
+	const glm::vec3 t_near = glm::min(t0, t1);
+	const glm::vec3 t_far = glm::max(t0, t1);
+	const float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.f));
+	const float exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, max_distance));
+	return enter <= exit ? enter : FLT_MAX;
+}
+
+void Bvh::set_bounds(uint32_t item, const Aabb& bounds) {
+	if (item >= _item_bounds.size()) {
+		_item_bounds.resize(item + 1);
+		_item_leaves.resize(item + 1, BVH_NO_ITEM);
+	}
+	_item_bounds[item] = bounds;
+
+	//adding or removing an item changes the leaves
+	const uint32_t leaf = _item_leaves[item];
+	if (leaf == BVH_NO_ITEM || !bounds.is_valid()) {
+		_needs_rebuild |= leaf != BVH_NO_ITEM || bounds.is_valid();
+		return;
+	}
+	for (uint32_t node = leaf; node != BVH_NO_ITEM && !_node_dirty[node]; node = _nodes[node].parent) {
+		_node_dirty[node] = true;
+	}
+	_needs_refit = true;
+}
+
+void Bvh::build() {
+	_items.clear();
+	for (uint32_t i = 0; i < _item_bounds.size(); i++) {
+		if (_item_bounds[i].is_valid()) {
+			_items.push_back(i);
+		}
+	}
+	std::fill(_item_leaves.begin(), _item_leaves.end(), BVH_NO_ITEM);
+	_nodes.clear();
+	_needs_rebuild = false;
+	_needs_refit = false;
+	_refit_count = 0;
+	if (_items.empty()) {
+		_node_dirty.clear();
+		return;
+	}
+
+	_nodes.reserve(_items.size() * 2);
+	Node root{ Aabb{}, 0, static_cast<uint32_t>(_items.size()), BVH_NO_ITEM };
+	for (uint32_t item : _items) {
+		root.bounds.expand(_item_bounds[item]);
+	}
+	_nodes.push_back(root);
+	subdivide(0, 0);
+	_node_dirty.assign(_nodes.size(), false);
+}
+
+void Bvh::subdivide(uint32_t node_index, uint32_t depth) {
+	const uint32_t first = _nodes[node_index].first;
+	const uint32_t count = _nodes[node_index].count;
+	auto make_leaf = [this, node_index, first, count]() {
+		for (uint32_t i = first; i < first + count; i++) {
+			_item_leaves[_items[i]] = node_index;
+		}
+	};
+	if (count <= 1 || depth + 1 >= BVH_MAX_DEPTH) {
+		make_leaf();
+		return;
+	}
+
+	Aabb centroid_bounds;
+	for (uint32_t i = first; i < first + count; i++) {
+		centroid_bounds.expand(_item_bounds[_items[i]].get_center());
+	}
+	const glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+	const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	if (extent[axis] <= 0.f) {
+		make_leaf();
+		return;
+	}
+
+	//binned SAH along the longest centroid axis
+	struct Bin {
+		Aabb bounds;
+		uint32_t count = 0;
+	} bins[BVH_BIN_COUNT];
+	const float scale = BVH_BIN_COUNT / extent[axis];
+	auto get_bin = [&](uint32_t item) {
+		const float offset = _item_bounds[item].get_center()[axis] - centroid_bounds.min[axis];
+		return std::min(static_cast<uint32_t>(offset * scale), BVH_BIN_COUNT - 1);
+	};
+	for (uint32_t i = first; i < first + count; i++) {
+		Bin& bin = bins[get_bin(_items[i])];
+		bin.bounds.expand(_item_bounds[_items[i]]);
+		bin.count++;
+	}
+
+	float right_costs[BVH_BIN_COUNT];
+	Aabb right_bounds;
+	uint32_t right_count = 0;
+	for (uint32_t i = BVH_BIN_COUNT - 1; i > 0; i--) {
+		right_bounds.expand(bins[i].bounds);
+		right_count += bins[i].count;
+		right_costs[i] = right_bounds.get_surface_area() * right_count;
+	}
+	Aabb left_bounds;
+	uint32_t left_count = 0;
+	float best_cost = FLT_MAX;
+	uint32_t best_split = 0;
+	for (uint32_t i = 0; i + 1 < BVH_BIN_COUNT; i++) {
+		left_bounds.expand(bins[i].bounds);
+		left_count += bins[i].count;
+		if (left_count == 0 || left_count == count) {
+			continue;
+		}
+		const float cost = left_bounds.get_surface_area() * left_count + right_costs[i + 1];
+		if (cost < best_cost) {
+			best_cost = cost;
+			best_split = i;
+		}
+	}
+
+	const float node_area = _nodes[node_index].bounds.get_surface_area();
+	const float split_cost = BVH_TRAVERSAL_COST + (node_area > 0.f ? best_cost / node_area : 0.f);
+	if (best_cost == FLT_MAX || (count <= BVH_MAX_LEAF_SIZE && split_cost >= static_cast<float>(count))) {
+		make_leaf();
+		return;
+	}
+
+	const uint32_t middle = static_cast<uint32_t>(std::partition(_items.begin() + first, _items.begin() + first + count,
+		[&](uint32_t item) { return get_bin(item) <= best_split; }) - _items.begin());
+
+	const uint32_t left = static_cast<uint32_t>(_nodes.size());
+	Node left_node{ Aabb{}, first, middle - first, node_index };
+	Node right_node{ Aabb{}, middle, first + count - middle, node_index };
+	for (uint32_t i = first; i < middle; i++) {
+		left_node.bounds.expand(_item_bounds[_items[i]]);
+	}
+	for (uint32_t i = middle; i < first + count; i++) {
+		right_node.bounds.expand(_item_bounds[_items[i]]);
+	}
+	_nodes.push_back(left_node);
+	_nodes.push_back(right_node);
+	_nodes[node_index].first = left;
+	_nodes[node_index].count = 0;
+
+	subdivide(left, depth + 1);
+	subdivide(left + 1, depth + 1);
+}
+
+void Bvh::refit() noexcept {
+	//children are always after their parent
+	for (uint32_t i = static_cast<uint32_t>(_nodes.size()); i-- > 0;) {
+		if (!_node_dirty[i]) {
+			continue;
+		}
+		_node_dirty[i] = false;
+		Node& node = _nodes[i];
+		node.bounds = Aabb{};
+		if (node.count > 0) {
+			for (uint32_t item = node.first; item < node.first + node.count; item++) {
+				node.bounds.expand(_item_bounds[_items[item]]);
+			}
+		}
+		else {
+			node.bounds.expand(_nodes[node.first].bounds);
+			node.bounds.expand(_nodes[node.first + 1].bounds);
+		}
+	}
+	_needs_refit = false;
+}
+
+void Bvh::update() {
+	if (_needs_rebuild || (_needs_refit && ++_refit_count >= BVH_REBUILD_INTERVAL)) {
+		//refitted trees lose quality as the items move apart
+		build();
+	}
+	else if (_needs_refit) {
+		refit();
+	}
+}
+
+uint32_t Bvh::raycast(const Ray& ray, float& distance) const noexcept {
+	distance = FLT_MAX;
+	if (_nodes.empty()) {
+		return BVH_NO_ITEM;
+	}
+	const glm::vec3 inverse_direction = 1.f / ray.direction;
+	uint32_t closest = BVH_NO_ITEM;
+
+	//nodes with their entry distance, skipped if something closer was hit after they were pushed
+	uint32_t stack[BVH_MAX_DEPTH * 2];
+	float stack_distances[BVH_MAX_DEPTH * 2];
+	uint32_t stack_size = 0;
+	const float root_t = intersect_ray(ray, inverse_direction, _nodes[0].bounds, distance);
+	if (root_t != FLT_MAX) {
+		stack[stack_size] = 0;
+		stack_distances[stack_size++] = root_t;
+	}
+	while (stack_size > 0) {
+		stack_size--;
+		if (stack_distances[stack_size] > distance) {
+			continue;
+		}
+		const Node& node = _nodes[stack[stack_size]];
+		if (node.count > 0) {
+			for (uint32_t i = node.first; i < node.first + node.count; i++) {
+				const float t = intersect_ray(ray, inverse_direction, _item_bounds[_items[i]], distance);
+				if (t < distance) {
+					distance = t;
+					closest = _items[i];
+				}
+			}
+			continue;
+		}
+
+		//the nearer child is popped first
+		uint32_t near_child = node.first;
+		uint32_t far_child = node.first + 1;
+		float near_t = intersect_ray(ray, inverse_direction, _nodes[near_child].bounds, distance);
+		float far_t = intersect_ray(ray, inverse_direction, _nodes[far_child].bounds, distance);
+		if (far_t < near_t) {
+			std::swap(near_child, far_child);
+			std::swap(near_t, far_t);
+		}
+		if (far_t != FLT_MAX) {
+			stack[stack_size] = far_child;
+			stack_distances[stack_size++] = far_t;
+		}
+		if (near_t != FLT_MAX) {
+			stack[stack_size] = near_child;
+			stack_distances[stack_size++] = near_t;
+		}
+	}
+	return closest;
+}
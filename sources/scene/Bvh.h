@@ -0,0 +1,169 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+struct Aabb {
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	inline bool is_valid() const noexcept { return min.x <= max.x; }
+	inline glm::vec3 get_center() const noexcept { return (min + max) * 0.5f; }
+	inline float get_surface_area() const noexcept {
+		const glm::vec3 d = max - min;
+		return is_valid() ? 2.f * (d.x * d.y + d.y * d.z + d.z * d.x) : 0.f;
+	}
+	inline void expand(const glm::vec3& point) noexcept { min = glm::min(min, point); max = glm::max(max, point); }
+	inline void expand(const Aabb& box) noexcept { min = glm::min(min, box.min); max = glm::max(max, box.max); }
+	inline bool overlaps(const Aabb& box) const noexcept {
+		return min.x <= box.max.x && max.x >= box.min.x &&
+			min.y <= box.max.y && max.y >= box.min.y &&
+			min.z <= box.max.z && max.z >= box.min.z;
+	}
+	inline bool overlaps_sphere(const glm::vec3& center, float radius) const noexcept {
+		const glm::vec3 d = center - glm::clamp(center, min, max);
+		return glm::dot(d, d) <= radius * radius;
+	}
+
+	//bounds of the transformed box
+	Aabb transform(const glm::mat4& matrix) const noexcept;
+};
+
+enum class FrustumTest {
+	OUTSIDE,
+	INTERSECTS,
+	INSIDE
+};
+
+struct Frustum {
+	//xyz is the inward normal
+	glm::vec4 planes[6];
+
+	//planes of the clip space of a glm projection
+	explicit Frustum(const glm::mat4& view_projection) noexcept;
+
+	FrustumTest test(const Aabb& box) const noexcept;
+	inline bool intersects(const Aabb& box) const noexcept { return test(box) != FrustumTest::OUTSIDE; }
+};
+
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction;
+};
+
+//distance to the box along the ray, FLT_MAX if it is missed or farther than max_distance
+float intersect_ray(const Ray& ray, const glm::vec3& inverse_direction, const Aabb& box, float max_distance) noexcept;
+
+constexpr uint32_t BVH_NO_ITEM = UINT32_MAX;
+constexpr uint32_t BVH_MAX_DEPTH = 64;
+
+//bounding volume hierarchy over the bounds of items with dense ids,
+//built with the binned surface area heuristic, moved items refit their leaves and ancestors,
+//added or removed items and every BVH_REBUILD_INTERVAL refits rebuild the tree
+class Bvh {
+private:
+	struct Node {
+		Aabb bounds;
+		//children of an internal node are first and first + 1, a leaf has items [first, first + count)
+		uint32_t first;
+		uint32_t count;
+		uint32_t parent;
+	};
+
+	std::vector<Node> _nodes;
+	//item ids in the leaf order
+	std::vector<uint32_t> _items;
+	std::vector<Aabb> _item_bounds;
+	std::vector<uint32_t> _item_leaves;
+	std::vector<uint8_t> _node_dirty;
+
+	bool _needs_refit = false;
+	bool _needs_rebuild = false;
+	uint32_t _refit_count = 0;
+
+private:
+	void subdivide(uint32_t node_index, uint32_t depth);
+	void refit() noexcept;
+
+public:
+	Bvh() noexcept {}
+
+	//invalid bounds remove the item
+	void set_bounds(uint32_t item, const Aabb& bounds);
+	inline void remove(uint32_t item) { set_bounds(item, Aabb{}); }
+	inline const Aabb& get_bounds(uint32_t item) const noexcept { return _item_bounds[item]; }
+
+	void build();
+	//refit or rebuild after the changes, call before the queries
+	void update();
+
+	inline uint32_t get_node_count() const noexcept { return static_cast<uint32_t>(_nodes.size()); }
+	inline uint32_t get_item_count() const noexcept { return static_cast<uint32_t>(_items.size()); }
+
+	template<typename F>
+	void query_frustum(const Frustum& frustum, F&& callback) const {
+		if (_nodes.empty()) {
+			return;
+		}
+		//the children of a node inside the frustum are not tested
+		uint32_t stack[BVH_MAX_DEPTH * 2];
+		bool stack_inside[BVH_MAX_DEPTH * 2];
+		uint32_t stack_size = 0;
+		stack[stack_size] = 0;
+		stack_inside[stack_size++] = false;
+		while (stack_size > 0) {
+			stack_size--;
+			const Node& node = _nodes[stack[stack_size]];
+			bool is_inside = stack_inside[stack_size];
+			if (!is_inside) {
+				const FrustumTest test = frustum.test(node.bounds);
+				if (test == FrustumTest::OUTSIDE) {
+					continue;
+				}
+				is_inside = test == FrustumTest::INSIDE;
+			}
+			if (node.count > 0) {
+				for (uint32_t i = node.first; i < node.first + node.count; i++) {
+					if (is_inside || frustum.intersects(_item_bounds[_items[i]])) {
+						callback(_items[i]);
+					}
+				}
+				continue;
+			}
+			stack[stack_size] = node.first;
+			stack_inside[stack_size++] = is_inside;
+			stack[stack_size] = node.first + 1;
+			stack_inside[stack_size++] = is_inside;
+		}
+	}
+
+	template<typename F>
+	void query_sphere(const glm::vec3& center, float radius, F&& callback) const {
+		if (_nodes.empty()) {
+			return;
+		}
+		uint32_t stack[BVH_MAX_DEPTH * 2];
+		uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+		while (stack_size > 0) {
+			const Node& node = _nodes[stack[--stack_size]];
+			if (!node.bounds.overlaps_sphere(center, radius)) {
+				continue;
+			}
+			if (node.count > 0) {
+				for (uint32_t i = node.first; i < node.first + node.count; i++) {
+					if (_item_bounds[_items[i]].overlaps_sphere(center, radius)) {
+						callback(_items[i]);
+					}
+				}
+				continue;
+			}
+			stack[stack_size++] = node.first;
+			stack[stack_size++] = node.first + 1;
+		}
+	}
+
+	//the item with the closest bounds along the ray, BVH_NO_ITEM if nothing is hit
+	uint32_t raycast(const Ray& ray, float& distance) const noexcept;
+};
@@ -0,0 +1,213 @@
+#include "GeometryPool.h"
+#include "SceneObject.h"
+#include "CommandManager.h"
+#include "CpuProfiler.h"
+#include <algorithm>
+
+//compaction starts when this part of the capacity is free but outside of the largest free range
+constexpr uint32_t GEOMETRY_FRAGMENTATION_DIVISOR = 4;
+
+RangeAllocator::RangeAllocator(uint32_t capacity) noexcept :
+	_capacity(capacity),
+	_free{ GeometryRange{ 0, capacity } } {}
+
+uint32_t RangeAllocator::allocate(uint32_t size) noexcept {
+	for (auto it = _free.begin(); it != _free.end(); ++it) {
+		if (it->size < size) {
+			continue;
+		}
+		const uint32_t offset = it->offset;
+		it->offset += size;
+		it->size -= size;
+		if (it->size == 0) {
+			_free.erase(it);
+		}
+		_used += size;
+		return offset;
+	}
+	return UINT32_MAX;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size) noexcept {
+	if (size == 0) {
+		return;
+	}
+	_used -= size;
+	auto next = std::lower_bound(_free.begin(), _free.end(), offset,
+		[](const GeometryRange& range, uint32_t offset) { return range.offset < offset; });
+	const bool merges_previous = next != _free.begin() && std::prev(next)->offset + std::prev(next)->size == offset;
+	const bool merges_next = next != _free.end() && offset + size == next->offset;
+	if (merges_previous && merges_next) {
+		std::prev(next)->size += size + next->size;
+		_free.erase(next);
+	}
+	else if (merges_previous) {
+		std::prev(next)->size += size;
+	}
+	else if (merges_next) {
+		next->offset = offset;
+		next->size += size;
+	}
+	else {
+		_free.insert(next, GeometryRange{ offset, size });
+	}
+}
+
+void RangeAllocator::reset(uint32_t used) noexcept {
+	_used = used;
+	_free.clear();
+	if (used < _capacity) {
+		_free.push_back(GeometryRange{ used, _capacity - used });
+	}
+}
+
+uint32_t RangeAllocator::get_fragmented() const noexcept {
+	uint32_t largest = 0;
+	for (const GeometryRange& range : _free) {
+		largest = std::max(largest, range.size);
+	}
+	return _capacity - _used - largest;
+}
+
+GeometryPool::GeometryPool(uint32_t vertex_capacity, uint32_t index_capacity) :
+	_vertex_allocator(vertex_capacity),
+	_index_allocator(index_capacity) {
+	create_buffers(_vertex_buffer, _index_buffer);
+}
+
+GeometryPool::~GeometryPool() {
+	for (const RetiredBuffers& retired : _retired_buffers) {
+		delete retired.vertex_buffer;
+		delete retired.index_buffer;
+	}
+	delete _vertex_buffer;
+	delete _index_buffer;
+}
+
+void GeometryPool::create_buffers(VulkanBuffer*& vertex_buffer, VulkanBuffer*& index_buffer) const {
+	//transfer source for the compaction
+	vertex_buffer = new VulkanBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		static_cast<VkDeviceSize>(_vertex_allocator.get_capacity()) * sizeof(Vertex), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	index_buffer = new VulkanBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		static_cast<VkDeviceSize>(_index_allocator.get_capacity()) * sizeof(uint32_t), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+uint32_t GeometryPool::allocate(uint32_t vertex_count, uint32_t index_count) noexcept {
+	const uint32_t first_vertex = _vertex_allocator.allocate(vertex_count);
+	if (first_vertex == UINT32_MAX) {
+		return GEOMETRY_NO_ALLOCATION;
+	}
+	const uint32_t first_index = _index_allocator.allocate(index_count);
+	if (first_index == UINT32_MAX) {
+		_vertex_allocator.free(first_vertex, vertex_count);
+		return GEOMETRY_NO_ALLOCATION;
+	}
+
+	uint32_t allocation;
+	if (_free_allocations.empty()) {
+		allocation = _allocations.size();
+		_allocations.emplace_back();
+	}
+	else {
+		allocation = _free_allocations.back();
+		_free_allocations.pop_back();
+	}
+	_allocations[allocation] = Allocation{ { first_vertex, vertex_count }, { first_index, index_count }, 1 };
+	return allocation;
+}
+
+void GeometryPool::release(uint32_t allocation) noexcept {
+	if (--_allocations[allocation].references == 0) {
+		_pending_frees.push_back(PendingFree{ allocation, _frame + Core::get_swapchain_image_count() });
+	}
+}
+
+void GeometryPool::free_allocation(uint32_t allocation) noexcept {
+	const Allocation& freed = _allocations[allocation];
+	_vertex_allocator.free(freed.vertices.offset, freed.vertices.size);
+	_index_allocator.free(freed.indices.offset, freed.indices.size);
+	_allocations[allocation] = Allocation{};
+	_free_allocations.push_back(allocation);
+}
+
+bool GeometryPool::update(VkCommandBuffer command_buffer) {
+	_frame++;
+	std::erase_if(_pending_frees, [this](const PendingFree& pending) {
+		if (pending.frame > _frame) {
+			return false;
+		}
+		free_allocation(pending.allocation);
+		return true;
+		});
+	std::erase_if(_retired_buffers, [this](const RetiredBuffers& retired) {
+		if (retired.frame > _frame) {
+			return false;
+		}
+		delete retired.vertex_buffer;
+		delete retired.index_buffer;
+		return true;
+		});
+
+	//one compaction in flight at a time keeps at most two copies of the buffers
+	if (!_retired_buffers.empty() || !_pending_frees.empty() ||
+		(_vertex_allocator.get_fragmented() < _vertex_allocator.get_capacity() / GEOMETRY_FRAGMENTATION_DIVISOR &&
+		_index_allocator.get_fragmented() < _index_allocator.get_capacity() / GEOMETRY_FRAGMENTATION_DIVISOR)) {
+		return false;
+	}
+	compact(command_buffer);
+	return true;
+}
+
+void GeometryPool::compact(VkCommandBuffer command_buffer) {
+	PROFILE_FUNCTION();
+	VulkanBuffer* vertex_buffer;
+	VulkanBuffer* index_buffer;
+	create_buffers(vertex_buffer, index_buffer);
+
+	//the live allocations keep their order
+	std::vector<uint32_t> live;
+	for (uint32_t i = 0; i < _allocations.size(); i++) {
+		if (_allocations[i].references > 0) {
+			live.push_back(i);
+		}
+	}
+	std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) {
+		return _allocations[a].vertices.offset < _allocations[b].vertices.offset; });
+
+	std::vector<VkBufferCopy> vertex_copies;
+	std::vector<VkBufferCopy> index_copies;
+	vertex_copies.reserve(live.size());
+	index_copies.reserve(live.size());
+	uint32_t vertex_count = 0;
+	uint32_t index_count = 0;
+	for (uint32_t allocation : live) {
+		Allocation& moved = _allocations[allocation];
+		vertex_copies.push_back(VkBufferCopy{ moved.vertices.offset * sizeof(Vertex), vertex_count * sizeof(Vertex),
+			moved.vertices.size * sizeof(Vertex) });
+		index_copies.push_back(VkBufferCopy{ moved.indices.offset * sizeof(uint32_t), index_count * sizeof(uint32_t),
+			moved.indices.size * sizeof(uint32_t) });
+		moved.vertices.offset = vertex_count;
+		moved.indices.offset = index_count;
+		vertex_count += moved.vertices.size;
+		index_count += moved.indices.size;
+	}
+	std::erase_if(vertex_copies, [](const VkBufferCopy& copy) { return copy.size == 0; });
+	std::erase_if(index_copies, [](const VkBufferCopy& copy) { return copy.size == 0; });
+
+	//the previous frames wrote the buffers with transfers only
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+	CommandManager::copy_buffer_regions(command_buffer, *_vertex_buffer, *vertex_buffer, vertex_copies);
+	CommandManager::copy_buffer_regions(command_buffer, *_index_buffer, *index_buffer, index_copies);
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT);
+
+	_retired_buffers.push_back(RetiredBuffers{ _vertex_buffer, _index_buffer, _frame + Core::get_swapchain_image_count() });
+	_vertex_buffer = vertex_buffer;
+	_index_buffer = index_buffer;
+	_vertex_allocator.reset(vertex_count);
+	_index_allocator.reset(index_count);
+	LOG_STATUS("Compacted a geometry pool to ", vertex_count, " vertices and ", index_count, " indices.");
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "VulkanDataObjects.h"
+
+constexpr uint32_t GEOMETRY_NO_ALLOCATION = UINT32_MAX;
+
+//offset and size in elements
+struct GeometryRange {
+	uint32_t offset;
+	uint32_t size;
+};
+
+//first fit free list, freed ranges are merged with their neighbours
+class RangeAllocator {
+private:
+	uint32_t _capacity;
+	uint32_t _used = 0;
+	//sorted by the offset
+	std::vector<GeometryRange> _free;
+
+public:
+	explicit RangeAllocator(uint32_t capacity) noexcept;
+
+	//UINT32_MAX if no free range fits
+	uint32_t allocate(uint32_t size) noexcept;
+	void free(uint32_t offset, uint32_t size) noexcept;
+	//the first used elements are taken, the rest is one free range
+	void reset(uint32_t used) noexcept;
+
+	inline uint32_t get_capacity() const noexcept { return _capacity; }
+	inline uint32_t get_used() const noexcept { return _used; }
+	//free elements outside of the largest free range
+	uint32_t get_fragmented() const noexcept;
+};
+
+//vertex and index buffers of a ModelGroup, meshes are suballocated and shared by their instances,
+//freed ranges are reused once the frames in flight are done with them,
+//a fragmented pool is packed into new buffers by vkCmdCopyBuffer in the frame command buffer
+class GeometryPool {
+private:
+	struct Allocation {
+		GeometryRange vertices;
+		GeometryRange indices;
+		uint32_t references = 0;
+	};
+	struct PendingFree {
+		uint32_t allocation;
+		uint64_t frame;
+	};
+	//the frames in flight may still draw from them
+	struct RetiredBuffers {
+		VulkanBuffer* vertex_buffer;
+		VulkanBuffer* index_buffer;
+		uint64_t frame;
+	};
+
+	VulkanBuffer* _vertex_buffer;
+	VulkanBuffer* _index_buffer;
+	RangeAllocator _vertex_allocator;
+	RangeAllocator _index_allocator;
+
+	std::vector<Allocation> _allocations;
+	std::vector<uint32_t> _free_allocations;
+	std::vector<PendingFree> _pending_frees;
+	std::vector<RetiredBuffers> _retired_buffers;
+	uint64_t _frame = 0;
+
+private:
+	void create_buffers(VulkanBuffer*& vertex_buffer, VulkanBuffer*& index_buffer) const;
+	void free_allocation(uint32_t allocation) noexcept;
+	void compact(VkCommandBuffer command_buffer);
+
+public:
+	GeometryPool(uint32_t vertex_capacity, uint32_t index_capacity);
+
+	//GEOMETRY_NO_ALLOCATION if the pool is full, the allocation starts with one reference
+	uint32_t allocate(uint32_t vertex_count, uint32_t index_count) noexcept;
+	inline void add_reference(uint32_t allocation) noexcept { _allocations[allocation].references++; }
+	//the ranges are freed after the frames in flight when the last reference is released
+	void release(uint32_t allocation) noexcept;
+
+	inline uint32_t get_first_vertex(uint32_t allocation) const noexcept { return _allocations[allocation].vertices.offset; }
+	inline uint32_t get_first_index(uint32_t allocation) const noexcept { return _allocations[allocation].indices.offset; }
+
+	//call once per frame after its fence is waited, true if the allocations were moved
+	bool update(VkCommandBuffer command_buffer);
+
+	inline const VulkanBuffer& get_vertex_buffer() const noexcept { return *_vertex_buffer; }
+	inline const VulkanBuffer& get_index_buffer() const noexcept { return *_index_buffer; }
+	inline const RangeAllocator& get_vertex_allocator() const noexcept { return _vertex_allocator; }
+	inline const RangeAllocator& get_index_allocator() const noexcept { return _index_allocator; }
+
+	~GeometryPool();
+};
@@ -2,10 +2,12 @@
 #include "imgui.h"
 #include "CommandManager.h"
 #include "MaterialManager.h"
+#include "CpuProfiler.h"
+#include <algorithm>
+#include <bit>
 
-constexpr VkDeviceSize VERTEX_BUFFER_ALLOCATION_SIZE = 500000 * sizeof(Vertex);
-constexpr VkDeviceSize INDEX_BUFFER_ALLOCATION_SIZE = 500000 * sizeof(uint32_t);
-constexpr uint32_t GROUP_MODEL_LIMIT = 30;
+constexpr uint32_t GROUP_VERTEX_CAPACITY = 500000;
+constexpr uint32_t GROUP_INDEX_CAPACITY = 500000;
 constexpr uint32_t POINT_LIGHT_LIMIT = 10;
 
 Scene::Scene(const std::shared_ptr<MaterialManager>& material_manager) noexcept :
@@ -24,25 +26,66 @@ void Scene::create_buffers() {
 	}
 }
 
-void Scene::draw_solid(VkCommandBuffer command_buffer, VkPipelineLayout layout) const noexcept{
-	for (auto& group : _object_groups) {
-		group->draw(command_buffer,layout, _material_manager);
+void Scene::fill_render_queue(RenderQueue& queue, const std::vector<MaterialPipeline>& material_pipelines,
+	const glm::mat4& view, const glm::mat4& projection) noexcept {
+	{
+		PROFILE_SCOPE("Scene frustum culling");
+		std::fill(_visible.begin(), _visible.end(), 0);
+		_bvh.query_frustum(Frustum(projection * view), [this](uint32_t transform_index) { _visible[transform_index] = 1; });
 	}
+	for (uint32_t i = 0; i < _object_groups.size(); i++) {
+		_object_groups[i]->fill_render_queue(queue, material_pipelines, i, view, _visible, _material_manager);
+	}
+}
+
+Model* Scene::pick(const glm::vec3& origin, const glm::vec3& direction) const noexcept {
+	float distance;
+	const uint32_t transform_index = _bvh.raycast(Ray{ origin, direction }, distance);
+	return transform_index == BVH_NO_ITEM ? nullptr : _transform_models[transform_index];
+}
+
+void Scene::get_light_models(const PointLight& light, std::vector<Model*>& models) const {
+	_bvh.query_sphere(light.get_pos(), light.get_range(),
+		[this, &models](uint32_t transform_index) { models.push_back(_transform_models[transform_index]); });
 }
 
-void Scene::draw_light(VkCommandBuffer command_buffer, VkPipelineLayout layout) {
-	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-		layout, 1, 1, &_point_light_descriptor_sets[Core::get_current_frame()], 0, 0);
-	vkCmdDraw(command_buffer, _point_lights.size() * 6, _point_lights.size(), 0, 0);
+void Scene::get_visible_lights(const Frustum& frustum, std::vector<PointLightData>& lights) const {
+	PROFILE_FUNCTION();
+	lights.clear();
+	for (const auto& light : _point_lights) {
+		//bounds of the sprite, it faces the camera
+		const PointLightData data = light->get_data();
+		const glm::vec3 center(data.pos);
+		if (frustum.intersects(Aabb{ center - glm::vec3(data.pos.w), center + glm::vec3(data.pos.w) })) {
+			lights.push_back(data);
+		}
+	}
+}
+
+uint32_t Scene::get_point_light_count() const noexcept {
+	return std::min(static_cast<uint32_t>(_point_lights.size()), POINT_LIGHT_LIMIT);
 }
 
 void Scene::display_scene_info_gui(bool* is_window_opened) const noexcept {
 	ImGui::BeginChild("Scene info: ", ImVec2(0.f,0.f),
 		ImGuiChildFlags_AutoResizeX | ImGuiChildFlags_AutoResizeY| ImGuiChildFlags_AlwaysAutoResize,
 		ImGuiWindowFlags_NoResize);
+	if (_selected != nullptr) {
+		ImGui::Text("Selected:");
+		ImGui::PushID("selected");
+		_selected->display_gui_info();
+		ImGui::PopID();
+		ImGui::Separator();
+	}
+	std::vector<Model*> light_models;
 	for (SceneObject* object : _objects) {
 		object->display_gui_info();
 	}
+	for (const auto& light : _point_lights) {
+		light_models.clear();
+		get_light_models(*light, light_models);
+		ImGui::Text("%s lights %u objects", light->get_name().c_str(), static_cast<uint32_t>(light_models.size()));
+	}
 	ImGui::EndChild();
 }
 
@@ -60,7 +103,16 @@ void Scene::create_descriptor_tools() {
 }
 
 void Scene::update_descriptor_sets(VkCommandBuffer command_buffer) noexcept {
-	for (uint32_t i = 0; i < _point_lights.size(); i++) {
+	PROFILE_FUNCTION();
+	_transforms.update();
+	for (uint32_t transform_index : _transforms.get_changed()) {
+		_bvh.set_bounds(transform_index, _local_bounds[transform_index].transform(_transforms.get_matrix(transform_index)));
+	}
+	_bvh.update();
+	for (ModelGroup* group : _object_groups) {
+		group->update(command_buffer);
+	}
+	for (uint32_t i = 0; i < get_point_light_count(); i++) {
 		if (!_point_lights[i]->is_copied()) {
 			_point_lights[i]->set_copied();
 			copy_light_new_info(_point_lights[i], i,command_buffer);
@@ -75,31 +127,203 @@ void Scene::copy_light_new_info(const std::shared_ptr<PointLight>& light, uint32
 		0, idx * sizeof(PointLightData));
 }
 
-bool Scene::add_mesh(const std::shared_ptr<Mesh>& mesh) {
-	bool has_added = false;
-	for (auto& group : _object_groups) {
-		if (group->try_add_mesh(mesh)) {
-			has_added = true;
-			_objects.push_back(group->get_last_pushed_model());
-			break;
+Model* Scene::add_mesh(const std::shared_ptr<Mesh>& mesh, const Model* parent) {
+	MeshInstance instance;
+	instance.position = mesh->get_pos();
+	instance.rotation = mesh->get_rotation();
+	instance.size = mesh->get_size();
+	Model* model = add_meshes({ mesh }, { instance })[0];
+	if (model != nullptr && parent != nullptr) {
+		set_parent(model, parent);
+	}
+	return model;
+}
+
+std::vector<Model*> Scene::add_meshes(const std::vector<std::shared_ptr<Mesh>>& meshes, const std::vector<MeshInstance>& instances) {
+	PROFILE_FUNCTION();
+	std::vector<Model*> models(instances.size(), nullptr);
+	uint32_t instance_count = instances.size();
+	if (instance_count > _transforms.get_available()) {
+		instance_count = _transforms.get_available();
+		LOG_WARNING("Transform limit exceded. Added ", instance_count, " of ", instances.size(), " meshes.");
+	}
+
+	//every mesh of the batch is placed once, its instances share the range
+	struct Placement {
+		ModelGroup* group = nullptr;
+		uint32_t allocation = GEOMETRY_NO_ALLOCATION;
+		VkDeviceSize staging_offset = 0;
+	};
+	std::vector<Placement> placements(meshes.size());
+	VkDeviceSize staging_size = 0;
+	for (uint32_t i = 0; i < instance_count; i++) {
+		if (instances[i].mesh >= meshes.size()) {
+			LOG_WARNING("Mesh instance ", i, " refers to a missing mesh.");
+			continue;
+		}
+		Placement& placement = placements[instances[i].mesh];
+		if (placement.group != nullptr) {
+			continue;
+		}
+		const Mesh& mesh = *meshes[instances[i].mesh];
+		for (ModelGroup* group : _object_groups) {
+			placement.allocation = group->allocate(mesh);
+			if (placement.allocation != GEOMETRY_NO_ALLOCATION) {
+				placement.group = group;
+				break;
+			}
+		}
+		if (placement.group == nullptr) {
+			_object_groups.push_back(new ModelGroup(mesh, _transforms, _descriptor_set_layout, _scene_lights_buffers));
+			placement.group = _object_groups.back();
+			placement.allocation = placement.group->allocate(mesh);
+		}
+		placement.staging_offset = staging_size;
+		staging_size += mesh.get_vertices_count() * sizeof(Vertex) + mesh.get_indices_count() * sizeof(uint32_t);
+	}
+
+	//all vertices and indices go through one staging region and one submission
+	if (staging_size > 0) {
+		char* staging = static_cast<char*>(StagingBuffer::map_region(staging_size));
+		for (uint32_t i = 0; i < meshes.size(); i++) {
+			const Placement& placement = placements[i];
+			if (placement.group != nullptr) {
+				const VkDeviceSize vertex_size = meshes[i]->get_vertices_count() * sizeof(Vertex);
+				memcpy(staging + placement.staging_offset, meshes[i]->get_vertex_data(), vertex_size);
+				memcpy(staging + placement.staging_offset + vertex_size, meshes[i]->get_index_data(), meshes[i]->get_indices_count() * sizeof(uint32_t));
+			}
+		}
+
+		VkCommandBuffer cmd = CommandManager::begin_single_command_buffer();
+		for (uint32_t i = 0; i < meshes.size(); i++) {
+			const Placement& placement = placements[i];
+			if (placement.group == nullptr) {
+				continue;
+			}
+			const VkDeviceSize vertex_size = meshes[i]->get_vertices_count() * sizeof(Vertex);
+			const VkDeviceSize first_vertex = placement.group->get_first_vertex(placement.allocation);
+			const VkDeviceSize first_index = placement.group->get_first_index(placement.allocation);
+			StagingBuffer::copy_region_to_buffer(cmd, placement.group->get_vertex_buffer(),
+				placement.staging_offset, first_vertex * sizeof(Vertex), vertex_size);
+			StagingBuffer::copy_region_to_buffer(cmd, placement.group->get_index_buffer(),
+				placement.staging_offset + vertex_size, first_index * sizeof(uint32_t), meshes[i]->get_indices_count() * sizeof(uint32_t));
+		}
+
+		VkFence fence;
+		VkFenceCreateInfo fence_create_info{};
+		fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VK_ASSERT(vkCreateFence(Core::get_device(), &fence_create_info, nullptr, &fence), "vkCreateFence() - FAILED");
+		VK_ASSERT(CommandManager::end_single_command_buffer(cmd, {}, {}, {}, fence), "end_single_command_buffer() - FAILED");
+		vkWaitForFences(Core::get_device(), 1, &fence, VK_TRUE, UINT64_MAX);
+		vkDestroyFence(Core::get_device(), fence, nullptr);
+	}
+
+	_objects.reserve(_objects.size() + instance_count);
+	_local_bounds.reserve(_transforms.size() + instance_count);
+	_transform_models.reserve(_transforms.size() + instance_count);
+	_visible.reserve(_transforms.size() + instance_count);
+	std::vector<Aabb> mesh_bounds(meshes.size());
+	for (uint32_t i = 0; i < instance_count; i++) {
+		const MeshInstance& instance = instances[i];
+		if (instance.mesh >= meshes.size()) {
+			continue;
+		}
+		const Placement& placement = placements[instance.mesh];
+		const Mesh& mesh = *meshes[instance.mesh];
+		const uint32_t parent = instance.parent < i && models[instance.parent] != nullptr ?
+			models[instance.parent]->get_transform_index() : TRANSFORM_NO_PARENT;
+		const uint32_t transform_index = _transforms.create(instance.position, instance.rotation, instance.size, parent);
+
+		Model* model = placement.group->add_model(mesh, transform_index, placement.allocation);
+		if (instance.material_index >= 0) {
+			model->set_material_index(instance.material_index);
+		}
+		_objects.push_back(model);
+		models[i] = model;
+
+		//the bvh gets the world bounds after the transform update
+		if (!mesh_bounds[instance.mesh].is_valid()) {
+			mesh_bounds[instance.mesh] = mesh.get_bounds();
+		}
+		//removed transforms are reused
+		if (transform_index >= _transform_models.size()) {
+			_local_bounds.resize(transform_index + 1);
+			_transform_models.resize(transform_index + 1, nullptr);
+			_visible.resize(transform_index + 1, 0);
+		}
+		_local_bounds[transform_index] = mesh_bounds[instance.mesh];
+		_transform_models[transform_index] = model;
+	}
+	//the models hold the geometry now
+	for (const Placement& placement : placements) {
+		if (placement.group != nullptr) {
+			placement.group->release(placement.allocation);
+		}
+	}
+	LOG_STATUS("Added ", instance_count, " models in one upload of ", staging_size / 1024, " KB.");
+	return models;
+}
+
+void Scene::remove_mesh(Model* model) {
+	PROFILE_FUNCTION();
+	if (model == nullptr || get_transform_model(model->get_transform_index()) != model) {
+		LOG_WARNING("Failed to remove a model, it is not in the scene.");
+		return;
+	}
+
+	//the subtree is every model with the removed transform among its ancestors
+	const uint32_t root = model->get_transform_index();
+	std::vector<Model*> removed;
+	for (Model* candidate : _transform_models) {
+		if (candidate == nullptr) {
+			continue;
+		}
+		for (uint32_t ancestor = candidate->get_transform_index(); ancestor != TRANSFORM_NO_PARENT; ancestor = _transforms.get_parent(ancestor)) {
+			if (ancestor == root) {
+				removed.push_back(candidate);
+				break;
+			}
 		}
 	}
 
-	if (!has_added) {
-		_object_groups.push_back(new ModelGroup(mesh, _descriptor_set_layout, _scene_lights_buffers));
-		_objects.push_back(_object_groups.back()->get_last_pushed_model());
-		if (_point_light_descriptor_sets.empty()) {
-			_point_light_descriptor_sets = _object_groups.back()->get_descriptor_sets();
+	std::erase_if(_objects, [&removed](SceneObject* object) {
+		return std::find(removed.begin(), removed.end(), object) != removed.end(); });
+	for (Model* removed_model : removed) {
+		const uint32_t transform_index = removed_model->get_transform_index();
+		_bvh.remove(transform_index);
+		_transform_models[transform_index] = nullptr;
+		_local_bounds[transform_index] = Aabb{};
+		_visible[transform_index] = 0;
+		if (_selected == removed_model) {
+			_selected = nullptr;
+		}
+		for (ModelGroup* group : _object_groups) {
+			if (group->remove_model(removed_model)) {
+				break;
+			}
 		}
+		//the whole subtree goes, no live transform keeps a destroyed parent
+		_transforms.destroy(transform_index);
+	}
+	LOG_STATUS("Removed ", removed.size(), " models.");
+}
+
+bool Scene::set_parent(const Model* model, const Model* parent) noexcept {
+	if (!_transforms.set_parent(model->get_transform_index(), parent ? parent->get_transform_index() : TRANSFORM_NO_PARENT)) {
+		LOG_WARNING("Failed to parent ", model->get_name(), ", the hierarchy would have a cycle.");
+		return false;
 	}
 	return true;
 }
 
 bool Scene::add_point_light(const std::shared_ptr<PointLight>& light) {
-	if (_point_lights.size() >= POINT_LIGHT_LIMIT) {
-		LOG_STATUS("Point light limit exceded. Aborted adding the light.");
+	if (_point_lights.size() >= LIGHT_SOURCE_LIMIT) {
+		LOG_STATUS("Light source limit exceded. Aborted adding the light.");
 		return false;
 	}
+	if (_point_lights.size() == POINT_LIGHT_LIMIT) {
+		LOG_STATUS("Point light limit reached, the next lights are only drawn as light sources.");
+	}
 
 	_point_lights.push_back(light);
 	_objects.push_back(light.get());
@@ -132,15 +356,7 @@ void Scene::ModelGroup::create_descriptor_tools(VkDescriptorSetLayout layout, co
 	create_info.maxSets = image_count;
 	VK_ASSERT(vkCreateDescriptorPool(Core::get_device(), &create_info, nullptr, &_descriptor_pool), "vkCreateDescriptorPool(), RendererSolid - FAILED");
 
-	_storage_buffers.resize(image_count);
 	_descriptor_sets.resize(image_count);
-	_buffer_data_ptrs.reserve(image_count);
-	for (auto& buffer : _storage_buffers) {
-		buffer = new VulkanBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-			sizeof(glm::mat4) * GROUP_MODEL_LIMIT,
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-		_buffer_data_ptrs.push_back(buffer->map_memory(0, VK_WHOLE_SIZE));
-	}
 
 	std::vector< VkDescriptorSetLayout> layouts(image_count,layout);
 	VkDescriptorSetAllocateInfo alloc_info{};
@@ -160,7 +376,8 @@ void Scene::ModelGroup::create_descriptor_tools(VkDescriptorSetLayout layout, co
 	for (uint32_t i = 0; i < image_count; i++) {
 		write.dstSet = _descriptor_sets[i];
 
-		VkDescriptorBufferInfo storage_buffer_info = _storage_buffers[i]->get_info(0, VK_WHOLE_SIZE);
+		//every group reads the transforms of the whole scene
+		VkDescriptorBufferInfo storage_buffer_info = _transforms.get_buffers()[i]->get_info(0, VK_WHOLE_SIZE);
 		write.dstBinding = 0;
 		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 		write.pBufferInfo = &storage_buffer_info;
@@ -175,112 +392,80 @@ void Scene::ModelGroup::create_descriptor_tools(VkDescriptorSetLayout layout, co
 	vkUpdateDescriptorSets(Core::get_device(), write_descriptors.size(), write_descriptors.data(), 0, 0);
 }
 
-void Scene::ModelGroup::create_buffers(const std::shared_ptr<Mesh>& object) {
-	const VkDeviceSize vertex_size = object->get_vertices_count() * sizeof(Vertex);
-	const VkDeviceSize index_size = object->get_indices_count() * sizeof(uint32_t);
-
-	if (vertex_size < VERTEX_BUFFER_ALLOCATION_SIZE && index_size < INDEX_BUFFER_ALLOCATION_SIZE) {
-		_index_buffer = new VulkanBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			INDEX_BUFFER_ALLOCATION_SIZE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-		_vertex_buffer = new VulkanBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VERTEX_BUFFER_ALLOCATION_SIZE, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	}
-	else {
-		_index_buffer = new VulkanBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			index_size, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-		_vertex_buffer = new VulkanBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			vertex_size, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	}
-}
-
-void Scene::ModelGroup::push_model(const std::shared_ptr<Mesh>& mesh) {
-	const VkDeviceSize vertex_size = mesh->get_vertices_count() * sizeof(Vertex);
-	const VkDeviceSize index_size = mesh->get_indices_count() * sizeof(uint32_t);
-
-	vkWaitForFences(Core::get_device(), 1, &_fence, VK_TRUE, UINT64_MAX);
-	vkResetFences(Core::get_device(), 1, &_fence);
-
-	VkCommandBuffer cmd = CommandManager::begin_single_command_buffer();
-	StagingBuffer::copy_buffers(cmd, mesh->get_vertex_data(), vertex_size, *_vertex_buffer, 0, sizeof(Vertex) * _total_vertices);
-	VK_ASSERT(CommandManager::end_single_command_buffer(cmd, {}, {}, {}, _fence), "end_single_command_buffer() - FAILED");
-
-	vkWaitForFences(Core::get_device(), 1, &_fence, VK_TRUE, UINT64_MAX);
-	vkResetFences(Core::get_device(), 1, &_fence);
-
-	cmd = CommandManager::begin_single_command_buffer();
-	StagingBuffer::copy_buffers(cmd, mesh->get_index_data(), index_size, *_index_buffer, 0, sizeof(uint32_t) * _total_indices);
-	VK_ASSERT(CommandManager::end_single_command_buffer(cmd, {}, {}, {},_fence), "end_single_command_buffer() - FAILED");
-
-	std::vector<void*> ptrs;
-	ptrs.reserve(_buffer_data_ptrs.size());
-	for (char*& ptr : _buffer_data_ptrs) {
-		ptrs.push_back((void*)ptr);
-		ptr += sizeof(glm::mat4);
-	}
-	_last_pushed_model = new Model(mesh.get(), _models.size(), _total_vertices, _total_indices, ptrs);
-	_models.push_back(_last_pushed_model);
-
-	_total_vertices += mesh->get_vertices_count();
-	_total_indices += mesh->get_indices_count();
-	_empty_indices -= mesh->get_indices_count() * sizeof(uint32_t);
-	_empty_vertices -= mesh->get_vertices_count() * sizeof(Vertex);
-	_storage_buffer_space -= _descriptor_sets.size();
-
-	LOG_STATUS("Added model: ", mesh->get_name());
-}
-
-Scene::ModelGroup::ModelGroup(const std::shared_ptr<Mesh>& object, VkDescriptorSetLayout layout, const std::vector<VulkanBuffer*>& scene_lights_buffers) noexcept :
-	_total_indices(0),
-	_total_vertices(0),
-	_storage_buffer_space(GROUP_MODEL_LIMIT) {
-
-	VkFenceCreateInfo fence_create_info{};
-	fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-	VK_ASSERT(vkCreateFence(Core::get_device(), &fence_create_info, nullptr, &_fence), "vkCreateFence() - FAILED");
-
+//oversized meshes get the next power of two, the pool keeps room for more of them
+Scene::ModelGroup::ModelGroup(const Mesh& mesh, TransformSystem& transforms,
+	VkDescriptorSetLayout layout, const std::vector<VulkanBuffer*>& scene_lights_buffers) noexcept :
+	_geometry(std::max(GROUP_VERTEX_CAPACITY, std::bit_ceil(mesh.get_vertices_count())),
+		std::max(GROUP_INDEX_CAPACITY, std::bit_ceil(mesh.get_indices_count()))),
+	_transforms(transforms) {
 	create_descriptor_tools(layout, scene_lights_buffers);
-	create_buffers(object);
-	_empty_indices = _index_buffer->get_size();
-	_empty_vertices = _vertex_buffer->get_size();
-	push_model(object);
 
 	LOG_STATUS("Created new ModelGroup.");
 }
 
-bool Scene::ModelGroup::try_add_mesh(const std::shared_ptr<Mesh>& mesh) {
-	if (mesh->get_indices_count() * sizeof(uint32_t) > _empty_indices ||
-		mesh->get_vertices_count() * sizeof(Vertex) > _empty_vertices || 
-		_storage_buffer_space < _descriptor_sets.size()) {
+Model* Scene::ModelGroup::add_model(const Mesh& mesh, uint32_t transform_index, uint32_t allocation) {
+	Model* model = new Model(&mesh, _transforms, transform_index, allocation,
+		_geometry.get_first_vertex(allocation), _geometry.get_first_index(allocation));
+	_geometry.add_reference(allocation);
+	_models.push_back(model);
+	return model;
+}
+
+bool Scene::ModelGroup::remove_model(Model* model) noexcept {
+	auto it = std::find(_models.begin(), _models.end(), model);
+	if (it == _models.end()) {
 		return false;
 	}
-	push_model(mesh);
+	_geometry.release(model->get_geometry_allocation());
+	_models.erase(it);
+	delete model;
 	return true;
 }
 
-void Scene::ModelGroup::draw(VkCommandBuffer command_buffer, VkPipelineLayout layout, const std::shared_ptr<MaterialManager>& material_manager) {
-	_index_buffer->bind_index_buffer(command_buffer, 0);
-	_vertex_buffer->bind_vertex_buffer(command_buffer, 0);
-	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 1, 1, &_descriptor_sets[Core::get_current_frame()], 0, 0);
-	int32_t prev_material_idx = INT32_MIN;
-	for (auto& obj : _models) {
-		if (prev_material_idx != obj->get_material_index()) {
-			VkDescriptorSet set = material_manager->get_material_descriptor(obj);
-			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 2, 1, &set, 0, 0);
+void Scene::ModelGroup::update(VkCommandBuffer command_buffer) {
+	if (!_geometry.update(command_buffer)) {
+		return;
+	}
+	for (Model* model : _models) {
+		model->set_buffer_offsets(_geometry.get_first_vertex(model->get_geometry_allocation()),
+			_geometry.get_first_index(model->get_geometry_allocation()));
+	}
+}
+
+void Scene::ModelGroup::fill_render_queue(RenderQueue& queue, const std::vector<MaterialPipeline>& material_pipelines, uint32_t group_id,
+	const glm::mat4& view, const std::vector<uint8_t>& visible, const std::shared_ptr<MaterialManager>& material_manager) const noexcept {
+	PROFILE_SCOPE("ModelGroup::fill_render_queue");
+	DrawCommand command{};
+	command.group_descriptor_set = _descriptor_sets[Core::get_current_frame()];
+	command.vertex_buffer = &_geometry.get_vertex_buffer();
+	command.index_buffer = &_geometry.get_index_buffer();
+	for (Model* obj : _models) {
+		if (!visible[obj->get_transform_index()]) {
+			continue;
 		}
-		obj->draw(command_buffer);
+		const MaterialPipeline& material_pipeline = material_pipelines[obj->get_material_index()];
+		command.pipeline = material_pipeline.pipeline;
+		command.material_descriptor_set = material_manager->get_material_descriptor(obj);
+		command.model = obj;
+		//view space looks down -z
+		const glm::mat4& world = obj->get_world_matrix();
+		float view_depth = -(view * world[3]).z;
+
+		//projected diameter of a unit mesh with 90 degree fov, drives texture streaming
+		float radius = std::sqrt(std::max(glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+			std::max(glm::dot(glm::vec3(world[1]), glm::vec3(world[1])), glm::dot(glm::vec3(world[2]), glm::vec3(world[2])))));
+		material_manager->report_material_usage(obj->get_material_index(),
+			radius * Core::get_swapchain_height() / std::max(view_depth, 0.01f));
+
+		//materials start from -1, shift them to keep the key unsigned
+		uint64_t key = RenderQueue::make_key(material_pipeline.pipeline_id, obj->get_material_index() + 1, group_id, view_depth);
+		queue.push(key, command);
 	}
 }
 
 Scene::ModelGroup::~ModelGroup() {
-	vkDestroyFence(Core::get_device(), _fence, nullptr);
 	vkDestroyDescriptorPool(Core::get_device(), _descriptor_pool, nullptr);
-	for (auto& buffer : _storage_buffers) {
-		delete buffer;
-	}
 	for (auto& model : _models) {
 		delete model;
 	}
-	delete _vertex_buffer;
-	delete _index_buffer;
 }
\ No newline at end of file
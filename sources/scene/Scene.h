@@ -1,6 +1,11 @@
 #pragma once
 
 #include "SceneObject.h"
+#include "GeometryPool.h"
+#include "RenderQueue.h"
+
+//lights drawn as light sources, only the first POINT_LIGHT_LIMIT of them shade the meshes
+constexpr uint32_t LIGHT_SOURCE_LIMIT = 4096;
 
 class Scene {
 private:
@@ -10,45 +15,54 @@ private:
 
 	class ModelGroup {
 	private:
-		//for downloading a mesh
-		VkFence _fence;
-
 		std::vector<Model*> _models;
-		VulkanBuffer* _vertex_buffer;
-		VulkanBuffer* _index_buffer;
+		GeometryPool _geometry;
 
-		std::vector<VulkanBuffer*> _storage_buffers;
+		TransformSystem& _transforms;
 		VkDescriptorPool _descriptor_pool;
 		std::vector<VkDescriptorSet> _descriptor_sets;
-		uint32_t _storage_buffer_space;
-
-		uint32_t _total_vertices;
-		uint32_t _total_indices;
-		VkDeviceSize _empty_vertices;
-		VkDeviceSize _empty_indices;
-		std::vector<char*> _buffer_data_ptrs;
-
-		Model* _last_pushed_model = nullptr;
 	private:
 		void create_descriptor_tools(VkDescriptorSetLayout layout, const std::vector<VulkanBuffer*>& scene_lights_buffers);
-		void create_buffers(const std::shared_ptr<Mesh>& object);
-		void push_model(const std::shared_ptr<Mesh>& mesh);
 
 	public:
-		ModelGroup(const std::shared_ptr<Mesh>& object, VkDescriptorSetLayout layout, const std::vector<VulkanBuffer*>& scene_lights_buffers) noexcept;
-
-		bool try_add_mesh(const std::shared_ptr<Mesh>& object);
-		void draw(VkCommandBuffer command_buffer, VkPipelineLayout layout, const std::shared_ptr<MaterialManager>& material_manager);
-
-		inline Model* get_last_pushed_model()const noexcept { return _last_pushed_model; }
-		inline std::vector<VkDescriptorSet> get_descriptor_sets() { return _descriptor_sets; }
+		//the pool fits at least the mesh, nothing is uploaded
+		ModelGroup(const Mesh& mesh, TransformSystem& transforms,
+			VkDescriptorSetLayout layout, const std::vector<VulkanBuffer*>& scene_lights_buffers) noexcept;
+
+		//reserves the vertex and index range of the mesh, GEOMETRY_NO_ALLOCATION if it does not fit,
+		//the caller releases the reservation once its models are added
+		inline uint32_t allocate(const Mesh& mesh) noexcept {
+			return _geometry.allocate(mesh.get_vertices_count(), mesh.get_indices_count());
+		}
+		inline void release(uint32_t allocation) noexcept { _geometry.release(allocation); }
+		inline uint32_t get_first_vertex(uint32_t allocation) const noexcept { return _geometry.get_first_vertex(allocation); }
+		inline uint32_t get_first_index(uint32_t allocation) const noexcept { return _geometry.get_first_index(allocation); }
+		//the allocation has to be uploaded, the model holds a reference to it
+		Model* add_model(const Mesh& mesh, uint32_t transform_index, uint32_t allocation);
+		//false if the model is not in the group, its geometry is freed with the last instance
+		bool remove_model(Model* model) noexcept;
+		//frees and compacts the geometry, the moved models get their new offsets
+		void update(VkCommandBuffer command_buffer);
+		//models without the visible flag of their transform are skipped
+		void fill_render_queue(RenderQueue& queue, const std::vector<MaterialPipeline>& material_pipelines, uint32_t group_id,
+			const glm::mat4& view, const std::vector<uint8_t>& visible, const std::shared_ptr<MaterialManager>& material_manager) const noexcept;
+
+		inline const VulkanBuffer& get_vertex_buffer() const noexcept { return _geometry.get_vertex_buffer(); }
+		inline const VulkanBuffer& get_index_buffer() const noexcept { return _geometry.get_index_buffer(); }
+		inline const GeometryPool& get_geometry() const noexcept { return _geometry; }
 		~ModelGroup();
 	};
 
 
 	std::vector<VulkanBuffer*> _scene_lights_buffers;
+	TransformSystem _transforms;
+	//world bounds of the models by their transform index
+	Bvh _bvh;
+	std::vector<Aabb> _local_bounds;
+	std::vector<Model*> _transform_models;
+	std::vector<uint8_t> _visible;
+	Model* _selected = nullptr;
 	std::vector<std::shared_ptr<PointLight>> _point_lights;
-	std::vector<VkDescriptorSet> _point_light_descriptor_sets;
 	std::vector<ModelGroup*> _object_groups;
 
 private:
@@ -61,15 +75,41 @@ public:
 
 	inline VkDescriptorSetLayout get_descriptor_set_layout()const noexcept { return _descriptor_set_layout; }
 
-	bool add_mesh(const std::shared_ptr<Mesh>& mesh);
+	//the mesh transform is relative to the parent, nullptr if the mesh is not added
+	Model* add_mesh(const std::shared_ptr<Mesh>& mesh, const Model* parent = nullptr);
+	//models of the instances in their order, nullptr where an instance could not be added,
+	//every mesh is uploaded once and its instances share the vertices, with one submission for the batch
+	std::vector<Model*> add_meshes(const std::vector<std::shared_ptr<Mesh>>& meshes, const std::vector<MeshInstance>& instances);
+	//removes the model with its children, the geometry is reused once the frames in flight are done
+	void remove_mesh(Model* model);
+	//nullptr parent makes the model a root, false if it makes a cycle
+	bool set_parent(const Model* model, const Model* parent) noexcept;
 	bool add_point_light(const std::shared_ptr<PointLight>& light);
 
 	void display_scene_info_gui(bool* is_window_opened) const noexcept;
 
 	void update_descriptor_sets(VkCommandBuffer command_buffer) noexcept;
 
-	void draw_solid(VkCommandBuffer command_buffer, VkPipelineLayout layout) const noexcept;
-	void draw_light(VkCommandBuffer command_buffer, VkPipelineLayout layout);
+	//lights that shade the meshes
+	uint32_t get_point_light_count() const noexcept;
+	inline uint32_t get_light_source_count() const noexcept { return _point_lights.size(); }
+
+	//push a draw command for every model in the frustum, sorted later by the queue,
+	//material_pipelines is indexed by the material index
+	void fill_render_queue(RenderQueue& queue, const std::vector<MaterialPipeline>& material_pipelines,
+		const glm::mat4& view, const glm::mat4& projection) noexcept;
+
+	//the model with the closest bounds along the ray, nullptr if nothing is hit
+	Model* pick(const glm::vec3& origin, const glm::vec3& direction) const noexcept;
+	inline void select(Model* model) noexcept { _selected = model; }
+	inline Model* get_selected() const noexcept { return _selected; }
+	inline Model* get_transform_model(uint32_t transform_index) const noexcept {
+		return transform_index < _transform_models.size() ? _transform_models[transform_index] : nullptr;
+	}
+	//models with bounds in the range of the light
+	void get_light_models(const PointLight& light, std::vector<Model*>& models) const;
+	//sprite data of the lights in the frustum, at most LIGHT_SOURCE_LIMIT
+	void get_visible_lights(const Frustum& frustum, std::vector<PointLightData>& lights) const;
 
 	~Scene();
 };
\ No newline at end of file
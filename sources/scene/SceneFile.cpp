@@ -0,0 +1,588 @@
+#include "SceneFile.h"
+#include "Scene.h"
+#include "MaterialManager.h"
+#include "CpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+
+constexpr char SCENE_FILE_MAGIC[4] = { 'E', 'C', 'S', 'N' };
+//bump when the layout or Vertex changes, the cooked files have to be remade
+constexpr uint32_t SCENE_FILE_VERSION = 1;
+//materials of the scene are created after the default one
+constexpr int32_t DEFAULT_MATERIAL_INDEX = 0;
+
+static std::string resolve_path(const std::string& filename) {
+	return std::filesystem::path(filename).is_absolute() ? filename : std::string(RENDERER_DIRECTORY) + '/' + filename;
+}
+
+//only what the scene files need: no escapes other than \" \\ \/ \n \t, numbers as double
+struct JsonValue {
+	enum class Type {
+		NUL,
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		ARRAY,
+		OBJECT
+	};
+
+	Type type = Type::NUL;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> array;
+	std::vector<std::pair<std::string, JsonValue>> object;
+
+	const JsonValue* find(const char* key) const noexcept {
+		for (const auto& [name, value] : object) {
+			if (name == key) {
+				return &value;
+			}
+		}
+		return nullptr;
+	}
+};
+
+class JsonParser {
+private:
+	const char* _begin;
+	const char* _src;
+	const char* _end;
+
+private:
+	void skip_whitespace() noexcept {
+		while (_src < _end && (*_src == ' ' || *_src == '\t' || *_src == '\n' || *_src == '\r')) {
+			_src++;
+		}
+	}
+
+	bool consume(char c) noexcept {
+		skip_whitespace();
+		if (_src < _end && *_src == c) {
+			_src++;
+			return true;
+		}
+		return false;
+	}
+
+	bool consume_literal(const char* literal) noexcept {
+		const size_t length = strlen(literal);
+		if (static_cast<size_t>(_end - _src) < length || memcmp(_src, literal, length) != 0) {
+			return false;
+		}
+		_src += length;
+		return true;
+	}
+
+	bool parse_string(std::string& string) {
+		if (!consume('"')) {
+			return false;
+		}
+		while (_src < _end && *_src != '"') {
+			if (*_src == '\\') {
+				if (++_src == _end) {
+					return false;
+				}
+				switch (*_src) {
+				case 'n': string += '\n'; break;
+				case 't': string += '\t'; break;
+				case '"': case '\\': case '/': string += *_src; break;
+				default: return false;
+				}
+			}
+			else {
+				string += *_src;
+			}
+			_src++;
+		}
+		return _src++ < _end;
+	}
+
+	bool parse_number(double& number) noexcept {
+		char* number_end;
+		number = strtod(_src, &number_end);
+		if (number_end == _src || number_end > _end) {
+			return false;
+		}
+		_src = number_end;
+		return true;
+	}
+
+public:
+	JsonParser(const std::string& text) noexcept :
+		_begin(text.data()), _src(text.data()), _end(text.data() + text.size()) {}
+
+	bool parse(JsonValue& value) {
+		skip_whitespace();
+		if (_src == _end) {
+			return false;
+		}
+		switch (*_src) {
+		case '{':
+			_src++;
+			value.type = JsonValue::Type::OBJECT;
+			if (consume('}')) {
+				return true;
+			}
+			do {
+				std::pair<std::string, JsonValue> member;
+				if (!parse_string(member.first) || !consume(':') || !parse(member.second)) {
+					return false;
+				}
+				value.object.push_back(std::move(member));
+			} while (consume(','));
+			return consume('}');
+		case '[':
+			_src++;
+			value.type = JsonValue::Type::ARRAY;
+			if (consume(']')) {
+				return true;
+			}
+			do {
+				value.array.emplace_back();
+				if (!parse(value.array.back())) {
+					return false;
+				}
+			} while (consume(','));
+			return consume(']');
+		case '"':
+			value.type = JsonValue::Type::STRING;
+			return parse_string(value.string);
+		case 't':
+			value.type = JsonValue::Type::BOOLEAN;
+			value.boolean = true;
+			return consume_literal("true");
+		case 'f':
+			value.type = JsonValue::Type::BOOLEAN;
+			return consume_literal("false");
+		case 'n':
+			return consume_literal("null");
+		default:
+			value.type = JsonValue::Type::NUMBER;
+			return parse_number(value.number);
+		}
+	}
+
+	bool is_finished() noexcept {
+		skip_whitespace();
+		return _src == _end;
+	}
+
+	uint32_t get_line() const noexcept {
+		return 1 + static_cast<uint32_t>(std::count(_begin, _src, '\n'));
+	}
+};
+
+//missing values keep the default
+static bool read_json(const JsonValue* value, std::string& string) {
+	if (value == nullptr) {
+		return true;
+	}
+	if (value->type != JsonValue::Type::STRING) {
+		return false;
+	}
+	string = value->string;
+	return true;
+}
+
+template<typename T>
+static bool read_json(const JsonValue* value, T& number) {
+	if (value == nullptr) {
+		return true;
+	}
+	if (value->type != JsonValue::Type::NUMBER) {
+		return false;
+	}
+	//casting a fraction or an out of range value to an integer is undefined
+	if constexpr (std::is_integral_v<T>) {
+		if (std::floor(value->number) != value->number ||
+			value->number < static_cast<double>(std::numeric_limits<T>::min()) ||
+			value->number > static_cast<double>(std::numeric_limits<T>::max())) {
+			return false;
+		}
+	}
+	number = static_cast<T>(value->number);
+	return true;
+}
+
+static bool read_json(const JsonValue* value, glm::vec3& vector) {
+	if (value == nullptr) {
+		return true;
+	}
+	if (value->type != JsonValue::Type::ARRAY || value->array.size() != 3) {
+		return false;
+	}
+	for (uint32_t i = 0; i < 3; i++) {
+		if (!read_json(&value->array[i], vector[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static const std::vector<JsonValue>& get_json_array(const JsonValue& root, const char* key) {
+	static const std::vector<JsonValue> empty;
+	const JsonValue* value = root.find(key);
+	return value != nullptr && value->type == JsonValue::Type::ARRAY ? value->array : empty;
+}
+
+bool SceneDescription::load(const std::string& filename) {
+	PROFILE_FUNCTION();
+	const std::string path = resolve_path(filename);
+	const bool is_loaded = std::filesystem::path(path).extension() == ".escene" ? load_binary(path) : load_json(path);
+	if (is_loaded) {
+		LOG_STATUS("Loaded scene ", filename, ": ", _meshes.size(), " meshes, ", _instances.size(), " instances, ",
+			_materials.size(), " materials, ", _lights.size(), " lights.");
+	}
+	return is_loaded;
+}
+
+bool SceneDescription::load_json(const std::string& filename) {
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		LOG_WARNING("Failed to open the scene ", filename);
+		return false;
+	}
+	const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	JsonValue root;
+	JsonParser parser(text);
+	if (!parser.parse(root) || !parser.is_finished() || root.type != JsonValue::Type::OBJECT) {
+		LOG_WARNING("Failed to parse the scene ", filename, " at line ", parser.get_line());
+		return false;
+	}
+
+	for (const JsonValue& value : get_json_array(root, "materials")) {
+		SceneMaterialDescription material;
+		bool is_valid = read_json(value.find("name"), material.name);
+		//the values are either texture paths or constants
+		const JsonValue* albedo = value.find("albedo");
+		if (albedo != nullptr && albedo->type == JsonValue::Type::STRING) {
+			const char* keys[4] = { "albedo", "metallic", "roughness", "normal" };
+			for (uint32_t i = 0; i < 4; i++) {
+				is_valid = is_valid && read_json(value.find(keys[i]), material.textures[i]) && !material.textures[i].empty();
+			}
+		}
+		else {
+			is_valid = is_valid && read_json(albedo, material.albedo) &&
+				read_json(value.find("metallic"), material.metallic) &&
+				read_json(value.find("roughness"), material.roughness);
+		}
+		if (!is_valid) {
+			LOG_WARNING("Invalid material ", _materials.size(), " in the scene ", filename,
+				", it needs four textures or constant values.");
+			return false;
+		}
+		_materials.push_back(std::move(material));
+	}
+
+	for (const JsonValue& value : get_json_array(root, "meshes")) {
+		SceneMeshDescription mesh;
+		if (!read_json(value.find("name"), mesh.name) || !read_json(value.find("file"), mesh.filename) ||
+			!read_json(value.find("material"), mesh.material) || mesh.filename.empty()) {
+			LOG_WARNING("Invalid mesh ", _meshes.size(), " in the scene ", filename);
+			return false;
+		}
+		_meshes.push_back(std::move(mesh));
+	}
+
+	for (const JsonValue& value : get_json_array(root, "instances")) {
+		MeshInstance instance;
+		if (!read_json(value.find("mesh"), instance.mesh) || !read_json(value.find("position"), instance.position) ||
+			!read_json(value.find("rotation"), instance.rotation) || !read_json(value.find("size"), instance.size) ||
+			!read_json(value.find("parent"), instance.parent) || !read_json(value.find("material"), instance.material_index)) {
+			LOG_WARNING("Invalid instance ", _instances.size(), " in the scene ", filename);
+			return false;
+		}
+		_instances.push_back(instance);
+	}
+
+	for (const JsonValue& value : get_json_array(root, "lights")) {
+		SceneLightDescription light;
+		if (!read_json(value.find("name"), light.name) || !read_json(value.find("position"), light.position) ||
+			!read_json(value.find("color"), light.color) || !read_json(value.find("radius"), light.radius)) {
+			LOG_WARNING("Invalid light ", _lights.size(), " in the scene ", filename);
+			return false;
+		}
+		_lights.push_back(std::move(light));
+	}
+	return validate(filename);
+}
+
+bool SceneDescription::validate(const std::string& filename) const {
+	const int32_t material_count = static_cast<int32_t>(_materials.size());
+	for (uint32_t i = 0; i < _meshes.size(); i++) {
+		if (_meshes[i].material < -1 || _meshes[i].material >= material_count) {
+			LOG_WARNING("Mesh ", i, " in the scene ", filename, " refers to a missing material.");
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < _instances.size(); i++) {
+		const MeshInstance& instance = _instances[i];
+		if (instance.mesh >= _meshes.size() || instance.material_index < -1 || instance.material_index >= material_count) {
+			LOG_WARNING("Instance ", i, " in the scene ", filename, " refers to a missing mesh or material.");
+			return false;
+		}
+		if (instance.parent != MESH_INSTANCE_NO_PARENT && instance.parent >= i) {
+			LOG_WARNING("Instance ", i, " in the scene ", filename, " has an invalid parent, parents have to come before their children.");
+			return false;
+		}
+	}
+	return true;
+}
+
+class BinaryWriter {
+private:
+	std::vector<char> _data;
+
+public:
+	void write(const void* data, size_t size) {
+		_data.insert(_data.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+	}
+	template<typename T>
+	void write(const T& value) {
+		static_assert(std::is_trivially_copyable_v<T>, "BinaryWriter::write() needs plain data.");
+		write(&value, sizeof(T));
+	}
+	void write(const std::string& string) {
+		write(static_cast<uint32_t>(string.size()));
+		write(string.data(), string.size());
+	}
+
+	inline const std::vector<char>& get_data() const noexcept { return _data; }
+};
+
+//every read fails after the end of the data
+class BinaryReader {
+private:
+	const char* _src;
+	const char* _end;
+
+public:
+	BinaryReader(const std::vector<char>& data) noexcept : _src(data.data()), _end(data.data() + data.size()) {}
+
+	bool read(void* data, size_t size) noexcept {
+		if (static_cast<size_t>(_end - _src) < size) {
+			_src = _end;
+			return false;
+		}
+		memcpy(data, _src, size);
+		_src += size;
+		return true;
+	}
+	template<typename T>
+	bool read(T& value) noexcept {
+		static_assert(std::is_trivially_copyable_v<T>, "BinaryReader::read() needs plain data.");
+		return read(&value, sizeof(T));
+	}
+	bool read(std::string& string) {
+		uint32_t size;
+		if (!read(size) || static_cast<size_t>(_end - _src) < size) {
+			return false;
+		}
+		string.assign(_src, size);
+		_src += size;
+		return true;
+	}
+
+	inline bool is_finished() const noexcept { return _src == _end; }
+};
+
+void SceneDescription::cook() {
+	PROFILE_FUNCTION();
+	std::unordered_map<std::string, const SceneMeshDescription*> cooked_files;
+	for (SceneMeshDescription& mesh : _meshes) {
+		if (mesh.is_cooked()) {
+			continue;
+		}
+		auto it = cooked_files.find(mesh.filename);
+		if (it != cooked_files.end()) {
+			mesh.vertices = it->second->vertices;
+			mesh.indices = it->second->indices;
+		}
+		else {
+			Mesh loaded(resolve_path(mesh.filename).c_str());
+			mesh.vertices.assign(loaded.get_vertex_data(), loaded.get_vertex_data() + loaded.get_vertices_count());
+			mesh.indices.assign(loaded.get_index_data(), loaded.get_index_data() + loaded.get_indices_count());
+			cooked_files.emplace(mesh.filename, &mesh);
+		}
+		if (mesh.name.empty()) {
+			mesh.name = std::filesystem::path(mesh.filename).stem().string();
+		}
+		mesh.filename.clear();
+	}
+}
+
+bool SceneDescription::save_binary(const std::string& filename) {
+	cook();
+
+	BinaryWriter writer;
+	writer.write(SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC));
+	writer.write(SCENE_FILE_VERSION);
+	writer.write(static_cast<uint32_t>(_materials.size()));
+	writer.write(static_cast<uint32_t>(_meshes.size()));
+	writer.write(static_cast<uint32_t>(_instances.size()));
+	writer.write(static_cast<uint32_t>(_lights.size()));
+
+	for (const SceneMaterialDescription& material : _materials) {
+		writer.write(material.name);
+		for (const std::string& texture : material.textures) {
+			writer.write(texture);
+		}
+		writer.write(material.albedo);
+		writer.write(material.metallic);
+		writer.write(material.roughness);
+	}
+	for (const SceneMeshDescription& mesh : _meshes) {
+		writer.write(mesh.name);
+		writer.write(mesh.material);
+		writer.write(static_cast<uint32_t>(mesh.vertices.size()));
+		writer.write(static_cast<uint32_t>(mesh.indices.size()));
+		writer.write(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+		writer.write(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+	}
+	//the instances are plain data
+	writer.write(_instances.data(), _instances.size() * sizeof(MeshInstance));
+	for (const SceneLightDescription& light : _lights) {
+		writer.write(light.name);
+		writer.write(light.position);
+		writer.write(light.color);
+		writer.write(light.radius);
+	}
+
+	const std::string path = resolve_path(filename);
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	const std::vector<char>& data = writer.get_data();
+	if (!file.write(data.data(), data.size())) {
+		LOG_WARNING("Failed to write the scene ", path);
+		return false;
+	}
+	LOG_STATUS("Cooked the scene to ", path, ", ", data.size() / 1024, " KB.");
+	return true;
+}
+
+bool SceneDescription::load_binary(const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		LOG_WARNING("Failed to open the scene ", filename);
+		return false;
+	}
+	std::vector<char> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	if (!file.read(data.data(), data.size())) {
+		LOG_WARNING("Failed to read the scene ", filename);
+		return false;
+	}
+
+	BinaryReader reader(data);
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t material_count, mesh_count, instance_count, light_count;
+	if (!reader.read(magic, sizeof(magic)) || memcmp(magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC)) != 0 ||
+		!reader.read(version) || version != SCENE_FILE_VERSION) {
+		LOG_WARNING("The scene ", filename, " is not a version ", SCENE_FILE_VERSION, " .escene file, cook it again.");
+		return false;
+	}
+	bool is_valid = reader.read(material_count) && reader.read(mesh_count) && reader.read(instance_count) && reader.read(light_count);
+
+	_materials.resize(is_valid ? material_count : 0);
+	for (SceneMaterialDescription& material : _materials) {
+		is_valid = is_valid && reader.read(material.name);
+		for (std::string& texture : material.textures) {
+			is_valid = is_valid && reader.read(texture);
+		}
+		is_valid = is_valid && reader.read(material.albedo) && reader.read(material.metallic) && reader.read(material.roughness);
+	}
+	_meshes.resize(is_valid ? mesh_count : 0);
+	for (SceneMeshDescription& mesh : _meshes) {
+		uint32_t vertex_count = 0, index_count = 0;
+		is_valid = is_valid && reader.read(mesh.name) && reader.read(mesh.material) &&
+			reader.read(vertex_count) && reader.read(index_count);
+		//the counts are checked against the data before allocating
+		is_valid = is_valid && vertex_count * sizeof(Vertex) + index_count * sizeof(uint32_t) <= data.size();
+		if (!is_valid) {
+			break;
+		}
+		mesh.vertices.resize(vertex_count);
+		mesh.indices.resize(index_count);
+		is_valid = reader.read(mesh.vertices.data(), vertex_count * sizeof(Vertex)) &&
+			reader.read(mesh.indices.data(), index_count * sizeof(uint32_t));
+	}
+	is_valid = is_valid && instance_count * sizeof(MeshInstance) <= data.size();
+	_instances.resize(is_valid ? instance_count : 0);
+	is_valid = is_valid && reader.read(_instances.data(), _instances.size() * sizeof(MeshInstance));
+	_lights.resize(is_valid ? light_count : 0);
+	for (SceneLightDescription& light : _lights) {
+		is_valid = is_valid && reader.read(light.name) && reader.read(light.position) && reader.read(light.color) && reader.read(light.radius);
+	}
+
+	if (!is_valid || !reader.is_finished()) {
+		LOG_WARNING("The scene ", filename, " is truncated or broken.");
+		return false;
+	}
+	return validate(filename);
+}
+
+void SceneDescription::instantiate(Scene& scene, MaterialManager& material_manager) const {
+	PROFILE_FUNCTION();
+	std::vector<int32_t> material_indices;
+	material_indices.reserve(_materials.size());
+	for (const SceneMaterialDescription& material : _materials) {
+		if (material.is_textured()) {
+			const std::array<std::string, 4> paths = { resolve_path(material.textures[0]), resolve_path(material.textures[1]),
+				resolve_path(material.textures[2]), resolve_path(material.textures[3]) };
+			material_indices.push_back(material_manager.create_new_material(material.name,
+				paths[0].c_str(), paths[1].c_str(), paths[2].c_str(), paths[3].c_str()).get_index());
+		}
+		else {
+			material_indices.push_back(material_manager.create_new_material(material.name,
+				material.albedo, material.metallic, material.roughness).get_index());
+		}
+	}
+	auto get_material_index = [&material_indices](int32_t material) {
+		return material >= 0 ? material_indices[material] : DEFAULT_MATERIAL_INDEX;
+	};
+
+	//every OBJ file is parsed once, meshes sharing it copy the vertices
+	std::vector<std::shared_ptr<Mesh>> meshes;
+	meshes.reserve(_meshes.size());
+	std::unordered_map<std::string, std::shared_ptr<Mesh>> loaded_files;
+	for (const SceneMeshDescription& description : _meshes) {
+		std::shared_ptr<Mesh> mesh;
+		if (description.is_cooked()) {
+			mesh = std::shared_ptr<Mesh>(new Mesh(description.name, description.vertices, description.indices));
+		}
+		else {
+			auto it = loaded_files.find(description.filename);
+			if (it == loaded_files.end()) {
+				mesh = std::shared_ptr<Mesh>(new Mesh(resolve_path(description.filename).c_str()));
+				loaded_files.emplace(description.filename, mesh);
+			}
+			else {
+				mesh = std::shared_ptr<Mesh>(new Mesh(*it->second));
+			}
+		}
+		mesh->set_material_index(get_material_index(description.material));
+		meshes.push_back(std::move(mesh));
+	}
+
+	std::vector<MeshInstance> instances = _instances;
+	for (MeshInstance& instance : instances) {
+		if (instance.material_index >= 0) {
+			instance.material_index = material_indices[instance.material_index];
+		}
+	}
+	scene.add_meshes(meshes, instances);
+
+	for (const SceneLightDescription& light : _lights) {
+		scene.add_point_light(std::shared_ptr<PointLight>(new PointLight(light.name, light.position, light.color, light.radius)));
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "SceneObject.h"
+#include <array>
+
+struct SceneMaterialDescription {
+	std::string name;
+	//albedo, metallic, roughness and normal, constant values are used if empty
+	std::array<std::string, 4> textures;
+	glm::vec3 albedo = glm::vec3(1.f);
+	float metallic = 0.f;
+	float roughness = 0.5f;
+
+	inline bool is_textured() const noexcept { return !textures[0].empty(); }
+};
+
+struct SceneMeshDescription {
+	std::string name;
+	//OBJ file, empty once the mesh is cooked
+	std::string filename;
+	//index into the materials of the scene, -1 for the default one
+	int32_t material = -1;
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+
+	inline bool is_cooked() const noexcept { return !vertices.empty(); }
+};
+
+struct SceneLightDescription {
+	std::string name;
+	glm::vec3 position = glm::vec3(0.f);
+	glm::vec3 color = glm::vec3(1.f);
+	float radius = 1.f;
+};
+
+//meshes, their instances, materials and lights of a scene,
+//authored as JSON and cooked to the binary .escene with the meshes inside,
+//paths are relative to RENDERER_DIRECTORY
+class SceneDescription {
+private:
+	std::vector<SceneMaterialDescription> _materials;
+	std::vector<SceneMeshDescription> _meshes;
+	//mesh indices of the instances point into _meshes
+	std::vector<MeshInstance> _instances;
+	std::vector<SceneLightDescription> _lights;
+
+private:
+	bool load_json(const std::string& filename);
+	bool load_binary(const std::string& filename);
+	//the indices between the meshes, instances and materials are in range, for both formats
+	bool validate(const std::string& filename) const;
+
+public:
+	//.escene files are binary, the others JSON
+	bool load(const std::string& filename);
+	//loads the OBJ files of the meshes, every file once
+	void cook();
+	//cooks the meshes first
+	bool save_binary(const std::string& filename);
+
+	//creates the materials, meshes and lights, the instances are added in one batch
+	void instantiate(class Scene& scene, class MaterialManager& material_manager) const;
+
+	inline uint32_t get_instance_count() const noexcept { return _instances.size(); }
+};
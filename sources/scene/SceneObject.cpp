@@ -2,6 +2,7 @@
 #include "imgui.h"
 #include "glm/gtc/type_ptr.hpp"
 #include "MaterialManager.h"
+#include "CpuProfiler.h"
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
@@ -70,6 +71,7 @@ void PositionedObject::set_pos(const glm::vec3& pos) noexcept {
 }
 
 Mesh Mesh::load_mesh(const std::string& filename) noexcept {
+	PROFILE_SCOPE("Mesh::load_mesh");
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
 	std::vector<tinyobj::material_t> materials;
@@ -201,11 +203,12 @@ Mesh::Mesh(const char* filename,
 
 void Mesh::set_material(const ObjectMaterial & material) noexcept { _material_index = material.get_index(); }
 
-void Model::set_new_transform() noexcept {
-	_transform = glm::translate(glm::mat4(1.f), _world_pos) *
-		glm::scale(glm::mat4(1.f), _size) * 
-		glm::mat4_cast(glm::quat(glm::radians(_rotation)));
-	_is_copied.assign(_is_copied.size(), false);
+Aabb Mesh::get_bounds() const noexcept {
+	Aabb bounds;
+	for (const Vertex& vertex : _vertices) {
+		bounds.expand(vertex.pos);
+	}
+	return bounds;
 }
 
 void Model::set_material(const ObjectMaterial& material) noexcept {
@@ -213,25 +216,20 @@ void Model::set_material(const ObjectMaterial& material) noexcept {
 }
 
 Model::Model(const Mesh* mesh,
-	uint32_t instance_index,
+	TransformSystem& transforms,
+	uint32_t transform_index,
+	uint32_t geometry_allocation,
 	uint32_t first_vertex,
-	uint32_t first_index,
-	std::vector<void*> _buffer_ptr) noexcept :
+	uint32_t first_index) noexcept :
 	SceneObject(mesh->get_name()),
-	WorldObject(mesh->get_pos(), mesh->get_size(), mesh->get_rotation()),
+	_transforms(transforms),
+	_transform_index(transform_index),
 	_vertices_count(mesh->get_vertices_count()),
 	_indices_count(mesh->get_indices_count()),
 	_first_buffer_vertex(first_vertex),
 	_first_buffer_index(first_index),
-	_instance_index(instance_index),
-	_model_transform_ptr(_buffer_ptr),
-	_material_index(mesh->get_material_index()){
-
-	set_new_transform();
-	for (void* ptr : _buffer_ptr) {
-		memcpy(ptr, &_transform, sizeof(glm::mat4));
-	}
-}
+	_geometry_allocation(geometry_allocation),
+	_material_index(mesh->get_material_index()){}
 
 void Model::display_gui_info() noexcept {
 	ImGui::BeginChild(_name.c_str(),ImVec2(0.f,0.f),
@@ -240,10 +238,17 @@ void Model::display_gui_info() noexcept {
 		ImGuiChildFlags_AlwaysAutoResize|
 		ImGuiChildFlags_AlwaysUseWindowPadding | ImGuiChildFlags_FrameStyle);
 	ImGui::Text(_name.c_str());
-	if (ImGui::SliderFloat3("Position: ", glm::value_ptr(_world_pos), -10.f, 10.f, "%.6f", ImGuiSliderFlags_AlwaysClamp) ||
-		ImGui::SliderFloat3("Rotation: ", glm::value_ptr(_rotation), -360.f, 360.f, "%.6f", ImGuiSliderFlags_AlwaysClamp) ||
-		ImGui::SliderFloat3("Size: ", glm::value_ptr(_size), 0.f, 10.f, "%.6f", ImGuiSliderFlags_AlwaysClamp)) {
-		_is_transformed = true;
+	glm::vec3 position = get_pos();
+	glm::vec3 rotation = get_rotation();
+	glm::vec3 size = get_size();
+	if (ImGui::SliderFloat3("Position: ", glm::value_ptr(position), -10.f, 10.f, "%.6f", ImGuiSliderFlags_AlwaysClamp)) {
+		set_pos(position);
+	}
+	if (ImGui::SliderFloat3("Rotation: ", glm::value_ptr(rotation), -360.f, 360.f, "%.6f", ImGuiSliderFlags_AlwaysClamp)) {
+		set_rotation(rotation);
+	}
+	if (ImGui::SliderFloat3("Size: ", glm::value_ptr(size), 0.f, 10.f, "%.6f", ImGuiSliderFlags_AlwaysClamp)) {
+		set_size(size);
 	}
 	ImGui::EndChild();
 }
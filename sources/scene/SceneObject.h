@@ -1,6 +1,8 @@
 #pragma once
 #include <unordered_map>
 #include "VulkanDataObjects.h"
+#include "TransformSystem.h"
+#include "Bvh.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
@@ -98,63 +100,84 @@ public:
 		glm::vec3 rotation = glm::vec3(0.f)) noexcept;
 
 	void set_material(const class ObjectMaterial& material) noexcept;
+	inline void set_material_index(int32_t material_index) noexcept { _material_index = material_index; }
 	inline int32_t get_material_index() const noexcept { return _material_index; }
 	inline uint32_t get_vertices_count() const noexcept { return _vertices.size(); }
 	inline uint32_t get_indices_count() const noexcept { return _indices.size(); }
 	inline const Vertex* get_vertex_data() const noexcept { return _vertices.data(); }
 	inline const uint32_t* get_index_data() const noexcept { return _indices.data(); }
+	//bounds of the vertices without the transform
+	Aabb get_bounds() const noexcept;
 };
 
-class Model : public WorldObject, public SceneObject {
+constexpr uint32_t MESH_INSTANCE_NO_PARENT = UINT32_MAX;
+
+//placement of a mesh for Scene::add_meshes()
+struct MeshInstance {
+	//index into the meshes of the batch
+	uint32_t mesh = 0;
+	glm::vec3 position = glm::vec3(0.f);
+	glm::vec3 rotation = glm::vec3(0.f);
+	glm::vec3 size = glm::vec3(1.f);
+	//index of an earlier instance of the batch, MESH_INSTANCE_NO_PARENT for a root
+	uint32_t parent = MESH_INSTANCE_NO_PARENT;
+	//-1 keeps the material of the mesh
+	int32_t material_index = -1;
+};
+
+//the transform lives in the TransformSystem of the scene, its index is the instance index of the draws
+class Model : public SceneObject {
 protected:
-	glm::mat4 _transform;
+	TransformSystem& _transforms;
+	uint32_t _transform_index;
 
 	uint32_t _vertices_count;
 	uint32_t _indices_count;
-	uint32_t _instance_index;
 	uint32_t _first_buffer_vertex;
 	uint32_t _first_buffer_index;
-
-	std::vector<void*> _model_transform_ptr;
-	std::vector<bool> _is_copied = std::vector<bool>(Core::get_swapchain_image_count(), true);
+	//geometry pool allocation shared with the other instances of the mesh
+	uint32_t _geometry_allocation;
 
 	int32_t _material_index;
 
-protected:
-
-	void set_new_transform() noexcept;
 public:
 	Model(const Mesh* mesh,
-		uint32_t instance_index,
+		TransformSystem& transforms,
+		uint32_t transform_index,
+		uint32_t geometry_allocation,
 		uint32_t first_vertex,
-		uint32_t first_index,
-		std::vector<void*> _buffer_ptr) noexcept;
+		uint32_t first_index) noexcept;
 
 	static std::vector<VkDescriptorSetLayoutBinding> get_bindings() noexcept;
 	
 	virtual void set_material(const class ObjectMaterial& material) noexcept;
+	inline void set_material_index(int32_t material_index) noexcept { _material_index = material_index; }
 
 	inline int32_t get_material_index() const noexcept { return _material_index; }
-
-	inline void copy_to_buffer() noexcept { memcpy(_model_transform_ptr[Core::get_current_frame()], &_transform, sizeof(glm::mat4)); }
-
-	virtual inline void draw(VkCommandBuffer command_buffer) noexcept {
-		if (_is_transformed) {
-			set_new_transform();
-		}
-		if (!_is_copied[Core::get_current_frame()]) {
-			copy_to_buffer();
-		}
-		vkCmdDraw(command_buffer, _vertices_count, 1, _first_buffer_vertex, _instance_index);
+	inline uint32_t get_triangle_count() const noexcept { return _vertices_count / 3; }
+
+	inline uint32_t get_transform_index() const noexcept { return _transform_index; }
+	inline uint32_t get_geometry_allocation() const noexcept { return _geometry_allocation; }
+	//the geometry pool moved the allocation
+	inline void set_buffer_offsets(uint32_t first_vertex, uint32_t first_index) noexcept {
+		_first_buffer_vertex = first_vertex;
+		_first_buffer_index = first_index;
+	}
+	inline const glm::mat4& get_world_matrix() const noexcept { return _transforms.get_matrix(_transform_index); }
+
+	//relative to the parent model
+	inline glm::vec3 get_pos() const noexcept { return _transforms.get_position(_transform_index); }
+	inline glm::vec3 get_size() const noexcept { return _transforms.get_scale(_transform_index); }
+	inline glm::vec3 get_rotation() const noexcept { return _transforms.get_rotation(_transform_index); }
+	inline void set_pos(const glm::vec3& pos) noexcept { _transforms.set_position(_transform_index, pos); }
+	inline void set_size(const glm::vec3& size) noexcept { _transforms.set_scale(_transform_index, size); }
+	inline void set_rotation(const glm::vec3& rotation) noexcept { _transforms.set_rotation(_transform_index, rotation); }
+
+	inline void draw(VkCommandBuffer command_buffer) const noexcept {
+		vkCmdDraw(command_buffer, _vertices_count, 1, _first_buffer_vertex, _transform_index);
 	}
-	virtual inline void draw_indexed(VkCommandBuffer command_buffer) noexcept {
-		if (_is_transformed) {
-			set_new_transform();
-		}
-		if (!_is_copied[Core::get_current_frame()]) {
-			copy_to_buffer();
-		}
-		vkCmdDrawIndexed(command_buffer, _indices_count, 1, _first_buffer_index, 0, _instance_index);
+	inline void draw_indexed(VkCommandBuffer command_buffer) const noexcept {
+		vkCmdDrawIndexed(command_buffer, _indices_count, 1, _first_buffer_index, 0, _transform_index);
 	}
 
 	virtual void display_gui_info() noexcept;
@@ -176,6 +199,8 @@ public:
 	PointLight(const std::string& name, const glm::vec3& position = glm::vec3(0.f), const glm::vec3& color = glm::vec3(1.f), float radius = 1.f);
 
 	inline PointLightData get_data() const noexcept { return PointLightData{ glm::vec4(_world_pos,_radius), _color }; }
+	//distance where the inverse square falloff drops below 1/256 of the brightest channel
+	inline float get_range() const noexcept { return sqrt(std::max(_color.x, std::max(_color.y, _color.z)) * 256.f); }
 	//get point light uniform bindings
 	static std::vector<VkDescriptorSetLayoutBinding> get_bindings() noexcept;
 
@@ -0,0 +1,288 @@
+#include "TransformSystem.h"
+#include "CpuProfiler.h"
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TRANSFORM_SYSTEM_SSE
+#include <xmmintrin.h>
+#endif
+
+static_assert(TRANSFORM_LIMIT % 64 == 0, "The dirty bitset words must cover whole blocks.");
+
+TransformSystem::TransformSystem() :
+	_position_x(TRANSFORM_LIMIT, 0.f),
+	_position_y(TRANSFORM_LIMIT, 0.f),
+	_position_z(TRANSFORM_LIMIT, 0.f),
+	_rotation_x(TRANSFORM_LIMIT, 0.f),
+	_rotation_y(TRANSFORM_LIMIT, 0.f),
+	_rotation_z(TRANSFORM_LIMIT, 0.f),
+	_scale_x(TRANSFORM_LIMIT, 1.f),
+	_scale_y(TRANSFORM_LIMIT, 1.f),
+	_scale_z(TRANSFORM_LIMIT, 1.f),
+	_local_matrices(TRANSFORM_LIMIT, glm::mat4(1.f)),
+	_matrices(TRANSFORM_LIMIT, glm::mat4(1.f)),
+	_parents(TRANSFORM_LIMIT, TRANSFORM_NO_PARENT),
+	_order_dirty(TRANSFORM_LIMIT, 0),
+	_dirty_bits(TRANSFORM_LIMIT / 64, 0),
+	_frame_dirty_bits(Core::get_swapchain_image_count(), std::vector<uint64_t>(TRANSFORM_LIMIT / 64, 0)) {
+
+	const uint32_t image_count = Core::get_swapchain_image_count();
+	_buffers.reserve(image_count);
+	_buffer_data_ptrs.reserve(image_count);
+	for (uint32_t i = 0; i < image_count; i++) {
+		_buffers.push_back(new VulkanBuffer(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			sizeof(glm::mat4) * TRANSFORM_LIMIT,
+			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+		_buffer_data_ptrs.push_back(_buffers.back()->map_memory(0, VK_WHOLE_SIZE));
+	}
+}
+
+TransformSystem::~TransformSystem() {
+	for (VulkanBuffer* buffer : _buffers) {
+		delete buffer;
+	}
+}
+
+uint32_t TransformSystem::create(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale, uint32_t parent) {
+	uint32_t index;
+	if (!_free_indices.empty()) {
+		index = _free_indices.back();
+		_free_indices.pop_back();
+	}
+	else if (_count < TRANSFORM_LIMIT) {
+		index = _count++;
+	}
+	else {
+		return TRANSFORM_LIMIT;
+	}
+	//a new transform has no children, any live parent is free of cycles
+	_parents[index] = parent != index && is_alive(parent) ? parent : TRANSFORM_NO_PARENT;
+	_is_order_dirty = true;
+	set_position(index, position);
+	set_rotation(index, rotation);
+	set_scale(index, scale);
+	return index;
+}
+
+void TransformSystem::destroy(uint32_t index) noexcept {
+	_parents[index] = TRANSFORM_FREE;
+	_free_indices.push_back(index);
+	_is_order_dirty = true;
+	//the order is rebuilt only by a dirty update
+	mark_dirty(index);
+}
+
+bool TransformSystem::set_parent(uint32_t index, uint32_t parent) noexcept {
+	for (uint32_t ancestor = parent; ancestor != TRANSFORM_NO_PARENT; ancestor = _parents[ancestor]) {
+		if (ancestor == index) {
+			return false;
+		}
+	}
+	_parents[index] = parent;
+	_is_order_dirty = true;
+	mark_dirty(index);
+	return true;
+}
+
+void TransformSystem::rebuild_order() {
+	//children grouped by their parent with a counting sort
+	std::vector<uint32_t> first_child(_count + 1, 0);
+	for (uint32_t i = 0; i < _count; i++) {
+		if (_parents[i] != TRANSFORM_NO_PARENT && _parents[i] != TRANSFORM_FREE) {
+			first_child[_parents[i] + 1]++;
+		}
+	}
+	for (uint32_t i = 0; i < _count; i++) {
+		first_child[i + 1] += first_child[i];
+	}
+	std::vector<uint32_t> children(first_child[_count]);
+	std::vector<uint32_t> next_child(first_child.begin(), first_child.end() - 1);
+	for (uint32_t i = 0; i < _count; i++) {
+		if (_parents[i] != TRANSFORM_NO_PARENT && _parents[i] != TRANSFORM_FREE) {
+			children[next_child[_parents[i]]++] = i;
+		}
+	}
+
+	_order.clear();
+	_order_parents.clear();
+	for (uint32_t i = 0; i < _count; i++) {
+		if (_parents[i] == TRANSFORM_NO_PARENT) {
+			_order.push_back(i);
+			_order_parents.push_back(TRANSFORM_NO_PARENT);
+		}
+	}
+	for (uint32_t position = 0; position < _order.size(); position++) {
+		const uint32_t index = _order[position];
+		for (uint32_t child = first_child[index]; child < first_child[index + 1]; child++) {
+			_order.push_back(children[child]);
+			_order_parents.push_back(position);
+		}
+	}
+	_is_order_dirty = false;
+}
+
+void TransformSystem::mark_dirty(uint32_t index) noexcept {
+	_dirty_bits[index / 64] |= 1ull << (index % 64);
+}
+
+void TransformSystem::set_position(uint32_t index, const glm::vec3& position) noexcept {
+	_position_x[index] = position.x;
+	_position_y[index] = position.y;
+	_position_z[index] = position.z;
+	mark_dirty(index);
+}
+
+void TransformSystem::set_rotation(uint32_t index, const glm::vec3& rotation) noexcept {
+	_rotation_x[index] = rotation.x;
+	_rotation_y[index] = rotation.y;
+	_rotation_z[index] = rotation.z;
+	mark_dirty(index);
+}
+
+void TransformSystem::set_scale(uint32_t index, const glm::vec3& scale) noexcept {
+	_scale_x[index] = scale.x;
+	_scale_y[index] = scale.y;
+	_scale_z[index] = scale.z;
+	mark_dirty(index);
+}
+
+void TransformSystem::build_matrices(uint32_t first) noexcept {
+	//glm::quat(glm::radians(rotation)), the trigonometry stays scalar
+	alignas(16) float qx[4], qy[4], qz[4], qw[4];
+	for (uint32_t i = 0; i < 4; i++) {
+		const float half_x = glm::radians(_rotation_x[first + i]) * 0.5f;
+		const float half_y = glm::radians(_rotation_y[first + i]) * 0.5f;
+		const float half_z = glm::radians(_rotation_z[first + i]) * 0.5f;
+		const float cx = cos(half_x), cy = cos(half_y), cz = cos(half_z);
+		const float sx = sin(half_x), sy = sin(half_y), sz = sin(half_z);
+		qw[i] = cx * cy * cz + sx * sy * sz;
+		qx[i] = sx * cy * cz - cx * sy * sz;
+		qy[i] = cx * sy * cz + sx * cy * sz;
+		qz[i] = cx * cy * sz - sx * sy * cz;
+	}
+
+	//translate * scale * rotation like the previous per model transform,
+	//column c, row r of the 3x3 part is scale[r] * rotation[c][r]
+#ifdef TRANSFORM_SYSTEM_SSE
+	const __m128 x = _mm_load_ps(qx), y = _mm_load_ps(qy), z = _mm_load_ps(qz), w = _mm_load_ps(qw);
+	const __m128 one = _mm_set1_ps(1.f), two = _mm_set1_ps(2.f);
+	const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+	const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+	const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+	const __m128 scale_x = _mm_loadu_ps(&_scale_x[first]);
+	const __m128 scale_y = _mm_loadu_ps(&_scale_y[first]);
+	const __m128 scale_z = _mm_loadu_ps(&_scale_z[first]);
+
+	__m128 columns[4][4];
+	columns[0][0] = _mm_mul_ps(scale_x, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))));
+	columns[0][1] = _mm_mul_ps(scale_y, _mm_mul_ps(two, _mm_add_ps(xy, wz)));
+	columns[0][2] = _mm_mul_ps(scale_z, _mm_mul_ps(two, _mm_sub_ps(xz, wy)));
+	columns[0][3] = _mm_setzero_ps();
+	columns[1][0] = _mm_mul_ps(scale_x, _mm_mul_ps(two, _mm_sub_ps(xy, wz)));
+	columns[1][1] = _mm_mul_ps(scale_y, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))));
+	columns[1][2] = _mm_mul_ps(scale_z, _mm_mul_ps(two, _mm_add_ps(yz, wx)));
+	columns[1][3] = _mm_setzero_ps();
+	columns[2][0] = _mm_mul_ps(scale_x, _mm_mul_ps(two, _mm_add_ps(xz, wy)));
+	columns[2][1] = _mm_mul_ps(scale_y, _mm_mul_ps(two, _mm_sub_ps(yz, wx)));
+	columns[2][2] = _mm_mul_ps(scale_z, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))));
+	columns[2][3] = _mm_setzero_ps();
+	columns[3][0] = _mm_loadu_ps(&_position_x[first]);
+	columns[3][1] = _mm_loadu_ps(&_position_y[first]);
+	columns[3][2] = _mm_loadu_ps(&_position_z[first]);
+	columns[3][3] = one;
+
+	//every register holds one element of the 4 matrices, transpose them into columns
+	for (uint32_t c = 0; c < 4; c++) {
+		__m128 c0 = columns[c][0], c1 = columns[c][1], c2 = columns[c][2], c3 = columns[c][3];
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_mm_storeu_ps(&_local_matrices[first + 0][c][0], c0);
+		_mm_storeu_ps(&_local_matrices[first + 1][c][0], c1);
+		_mm_storeu_ps(&_local_matrices[first + 2][c][0], c2);
+		_mm_storeu_ps(&_local_matrices[first + 3][c][0], c3);
+	}
+#else
+	for (uint32_t i = 0; i < 4; i++) {
+		const float x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+		const glm::vec3 scale(_scale_x[first + i], _scale_y[first + i], _scale_z[first + i]);
+		glm::mat4& matrix = _local_matrices[first + i];
+		matrix[0] = glm::vec4(scale * glm::vec3(1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z), 2.f * (x * z - w * y)), 0.f);
+		matrix[1] = glm::vec4(scale * glm::vec3(2.f * (x * y - w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x)), 0.f);
+		matrix[2] = glm::vec4(scale * glm::vec3(2.f * (x * z + w * y), 2.f * (y * z - w * x), 1.f - 2.f * (x * x + y * y)), 0.f);
+		matrix[3] = glm::vec4(_position_x[first + i], _position_y[first + i], _position_z[first + i], 1.f);
+	}
+#endif
+}
+
+void TransformSystem::propagate_world_matrices() noexcept {
+	//a position is dirty if its local transform or any ancestor changed,
+	//the parent is always swept before, so its world matrix and flag are final
+	for (uint32_t position = 0; position < _order.size(); position++) {
+		const uint32_t index = _order[position];
+		const uint32_t parent_position = _order_parents[position];
+		const bool is_dirty = ((_dirty_bits[index / 64] >> (index % 64)) & 1) ||
+			(parent_position != TRANSFORM_NO_PARENT && _order_dirty[parent_position]);
+		_order_dirty[position] = is_dirty;
+		if (!is_dirty) {
+			continue;
+		}
+
+		_matrices[index] = parent_position == TRANSFORM_NO_PARENT ?
+			_local_matrices[index] : _matrices[_order[parent_position]] * _local_matrices[index];
+		_changed.push_back(index);
+		for (auto& frame_bits : _frame_dirty_bits) {
+			frame_bits[index / 64] |= 1ull << (index % 64);
+		}
+	}
+}
+
+void TransformSystem::update() noexcept {
+	PROFILE_FUNCTION();
+	_changed.clear();
+	bool is_dirty = false;
+	for (uint32_t word = 0; word < _dirty_bits.size(); word++) {
+		const uint64_t bits = _dirty_bits[word];
+		if (bits == 0) {
+			continue;
+		}
+		for (uint32_t block = 0; block < 64; block += 4) {
+			if ((bits >> block) & 0xF) {
+				build_matrices(word * 64 + block);
+			}
+		}
+		is_dirty = true;
+	}
+	if (is_dirty) {
+		if (_is_order_dirty) {
+			rebuild_order();
+		}
+		propagate_world_matrices();
+		std::fill(_dirty_bits.begin(), _dirty_bits.end(), 0);
+	}
+
+	//the frame fence was waited, its buffer is not read anymore
+	std::vector<uint64_t>& frame_bits = _frame_dirty_bits[Core::get_current_frame()];
+	char* data = _buffer_data_ptrs[Core::get_current_frame()];
+	uint32_t range_begin = UINT32_MAX;
+	for (uint32_t word = 0; word < frame_bits.size(); word++) {
+		const uint64_t bits = frame_bits[word];
+		frame_bits[word] = 0;
+		if ((bits == 0 && range_begin == UINT32_MAX) || (bits == UINT64_MAX && range_begin != UINT32_MAX)) {
+			continue;
+		}
+		for (uint32_t bit = 0; bit < 64; bit++) {
+			const uint32_t index = word * 64 + bit;
+			const bool is_dirty = (bits >> bit) & 1;
+			if (is_dirty && range_begin == UINT32_MAX) {
+				range_begin = index;
+			}
+			else if (!is_dirty && range_begin != UINT32_MAX) {
+				memcpy(data + range_begin * sizeof(glm::mat4), &_matrices[range_begin], (index - range_begin) * sizeof(glm::mat4));
+				range_begin = UINT32_MAX;
+			}
+		}
+	}
+	if (range_begin != UINT32_MAX) {
+		memcpy(data + range_begin * sizeof(glm::mat4), &_matrices[range_begin], (TRANSFORM_LIMIT - range_begin) * sizeof(glm::mat4));
+	}
+}
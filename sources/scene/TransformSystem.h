@@ -0,0 +1,92 @@
+#pragma once
+#include "VulkanDataObjects.h"
+#include <glm/glm.hpp>
+
+//transforms of a scene, the buffers are indexed by gl_InstanceIndex in solid.vert
+constexpr uint32_t TRANSFORM_LIMIT = 4096;
+constexpr uint32_t TRANSFORM_NO_PARENT = UINT32_MAX;
+//parent of a destroyed transform, the index is reused by create
+constexpr uint32_t TRANSFORM_FREE = UINT32_MAX - 1;
+
+//parent relative translation, euler rotation in degrees and scale of every object in separate arrays,
+//changed transforms are marked in a dirty bitset, their local matrices are rebuilt in one pass, 4 at a time,
+//the world matrices are propagated in one sweep over the breadth first order of the hierarchy,
+//only for the dirty subtrees, and copied to the mapped buffer of every frame in contiguous ranges
+class TransformSystem {
+private:
+	std::vector<float> _position_x;
+	std::vector<float> _position_y;
+	std::vector<float> _position_z;
+	std::vector<float> _rotation_x;
+	std::vector<float> _rotation_y;
+	std::vector<float> _rotation_z;
+	std::vector<float> _scale_x;
+	std::vector<float> _scale_y;
+	std::vector<float> _scale_z;
+	std::vector<glm::mat4> _local_matrices;
+	//world matrices
+	std::vector<glm::mat4> _matrices;
+	uint32_t _count = 0;
+	std::vector<uint32_t> _free_indices;
+
+	std::vector<uint32_t> _parents;
+	//transform indices in the breadth first order, parents come before their children
+	std::vector<uint32_t> _order;
+	//position of the parent in the order
+	std::vector<uint32_t> _order_parents;
+	//the world matrix of the order position changed in this update
+	std::vector<uint8_t> _order_dirty;
+	bool _is_order_dirty = false;
+	//world matrices changed by the last update
+	std::vector<uint32_t> _changed;
+
+	//the local matrix must be rebuilt
+	std::vector<uint64_t> _dirty_bits;
+	//the matrix must be copied to the buffer of the frame
+	std::vector<std::vector<uint64_t>> _frame_dirty_bits;
+
+	std::vector<VulkanBuffer*> _buffers;
+	std::vector<char*> _buffer_data_ptrs;
+
+private:
+	void mark_dirty(uint32_t index) noexcept;
+	//rebuilds the local matrices of the 4 transforms starting at first
+	void build_matrices(uint32_t first) noexcept;
+	void rebuild_order();
+	void propagate_world_matrices() noexcept;
+
+public:
+	TransformSystem();
+
+	//TRANSFORM_LIMIT if the system is full, destroyed indices are reused first
+	uint32_t create(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale,
+		uint32_t parent = TRANSFORM_NO_PARENT);
+	//the children have to be destroyed or reparented before
+	void destroy(uint32_t index) noexcept;
+	//one past the highest index ever created
+	inline uint32_t size() const noexcept { return _count; }
+	inline uint32_t get_available() const noexcept { return TRANSFORM_LIMIT - _count + _free_indices.size(); }
+	inline bool is_alive(uint32_t index) const noexcept { return index < _count && _parents[index] != TRANSFORM_FREE; }
+
+	inline glm::vec3 get_position(uint32_t index) const noexcept { return glm::vec3(_position_x[index], _position_y[index], _position_z[index]); }
+	inline glm::vec3 get_rotation(uint32_t index) const noexcept { return glm::vec3(_rotation_x[index], _rotation_y[index], _rotation_z[index]); }
+	inline glm::vec3 get_scale(uint32_t index) const noexcept { return glm::vec3(_scale_x[index], _scale_y[index], _scale_z[index]); }
+	//world matrix of the last update
+	inline const glm::mat4& get_matrix(uint32_t index) const noexcept { return _matrices[index]; }
+	inline uint32_t get_parent(uint32_t index) const noexcept { return _parents[index]; }
+	inline const std::vector<uint32_t>& get_changed() const noexcept { return _changed; }
+
+	//the local transform becomes relative to the parent, false if it makes a cycle
+	bool set_parent(uint32_t index, uint32_t parent) noexcept;
+
+	void set_position(uint32_t index, const glm::vec3& position) noexcept;
+	void set_rotation(uint32_t index, const glm::vec3& rotation) noexcept;
+	void set_scale(uint32_t index, const glm::vec3& scale) noexcept;
+
+	//rebuild the dirty matrices and their subtrees, copy the changed ranges to the buffer of the current frame
+	void update() noexcept;
+
+	inline const std::vector<VulkanBuffer*>& get_buffers() const noexcept { return _buffers; }
+
+	~TransformSystem();
+};
@@ -0,0 +1,344 @@
+#include "BakeCache.h"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//bump when a blob layout changes, the directories of other versions are removed
+constexpr uint32_t BAKE_CACHE_VERSION = 1;
+constexpr uint32_t BLOB_MAGIC = 0x424B4345;//"ECKB"
+
+const std::string cache_root_directory = std::string(RENDERER_DIRECTORY) + "/cache";
+
+struct BlobHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t data_size;
+};
+
+namespace fs = std::filesystem;
+
+static int64_t get_time(const fs::file_time_type& time) noexcept {
+	return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+//
+//
+//BakeKey
+//
+//
+
+BakeKey& BakeKey::add(const void* data, size_t size) noexcept {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++) {
+		_hash ^= bytes[i];
+		_hash *= 1099511628211ull;
+	}
+	return *this;
+}
+
+BakeKey& BakeKey::add(const std::string& value) noexcept {
+	return add(value.data(), value.size());
+}
+
+BakeKey& BakeKey::add_file(const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open()) {
+		LOG_ERROR("Failed to open the file: ", filename);
+	}
+
+	std::vector<char> buffer(1 << 20);
+	while (file) {
+		file.read(buffer.data(), buffer.size());
+		add(buffer.data(), static_cast<size_t>(file.gcount()));
+	}
+	return *this;
+}
+
+std::string BakeKey::to_string() const {
+	std::stringstream stream;
+	stream << std::hex << std::setw(16) << std::setfill('0') << _hash;
+	return stream.str();
+}
+
+//
+//
+//MappedBlob
+//
+//
+
+MappedBlob::MappedBlob(MappedBlob&& blob) noexcept :
+	_view(blob._view), _view_size(blob._view_size)
+#ifdef _WIN32
+	, _file(blob._file), _mapping(blob._mapping)
+#endif
+{
+	blob._view = nullptr;
+#ifdef _WIN32
+	blob._file = nullptr;
+	blob._mapping = nullptr;
+#endif
+}
+
+MappedBlob& MappedBlob::operator=(MappedBlob&& blob) noexcept {
+	if (this != &blob) {
+		unmap();
+		_view = blob._view;
+		_view_size = blob._view_size;
+		blob._view = nullptr;
+#ifdef _WIN32
+		_file = blob._file;
+		_mapping = blob._mapping;
+		blob._file = nullptr;
+		blob._mapping = nullptr;
+#endif
+	}
+	return *this;
+}
+
+bool MappedBlob::map(const std::string& filename) noexcept {
+#ifdef _WIN32
+	_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_file == INVALID_HANDLE_VALUE) {
+		_file = nullptr;
+		return false;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(_file, &file_size) || file_size.QuadPart < static_cast<LONGLONG>(sizeof(BlobHeader))) {
+		unmap();
+		return false;
+	}
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr) {
+		unmap();
+		return false;
+	}
+	_view = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	_view_size = static_cast<size_t>(file_size.QuadPart);
+#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat file_stat;
+	if (fstat(file, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(BlobHeader))) {
+		close(file);
+		return false;
+	}
+	void* view = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	//the mapping keeps its own reference to the file
+	close(file);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	_view = static_cast<const char*>(view);
+	_view_size = static_cast<size_t>(file_stat.st_size);
+#endif
+	if (_view == nullptr) {
+		unmap();
+		return false;
+	}
+
+	//an interrupted write leaves a blob shorter than its header says
+	const BlobHeader* header = reinterpret_cast<const BlobHeader*>(_view);
+	if (header->magic != BLOB_MAGIC || header->version != BAKE_CACHE_VERSION ||
+		header->data_size != _view_size - sizeof(BlobHeader)) {
+		unmap();
+		return false;
+	}
+	return true;
+}
+
+const char* MappedBlob::data() const noexcept {
+	return _view + sizeof(BlobHeader);
+}
+
+size_t MappedBlob::size() const noexcept {
+	return _view_size - sizeof(BlobHeader);
+}
+
+void MappedBlob::unmap() noexcept {
+#ifdef _WIN32
+	if (_view != nullptr) {
+		UnmapViewOfFile(_view);
+	}
+	if (_mapping != nullptr) {
+		CloseHandle(_mapping);
+	}
+	if (_file != nullptr) {
+		CloseHandle(_file);
+	}
+	_file = nullptr;
+	_mapping = nullptr;
+#else
+	if (_view != nullptr) {
+		munmap(const_cast<char*>(_view), _view_size);
+	}
+#endif
+	_view = nullptr;
+	_view_size = 0;
+}
+
+MappedBlob::~MappedBlob() {
+	unmap();
+}
+
+//
+//
+//BakeCache
+//
+//
+
+BakeCache::BakeCache(uint64_t size_limit) :
+	_directory(cache_root_directory + "/v" + std::to_string(BAKE_CACHE_VERSION)),
+	_size_limit(size_limit) {
+	assert(bake_cache_ptr == nullptr && "There can be only one BakeCache.");
+	bake_cache_ptr = this;
+
+	std::error_code error;
+	//blobs of other versions can not be read anymore
+	if (fs::exists(cache_root_directory, error)) {
+		for (const auto& entry : fs::directory_iterator(cache_root_directory, error)) {
+			if (entry.path() != fs::path(_directory)) {
+				fs::remove_all(entry.path(), error);
+			}
+		}
+	}
+	fs::create_directories(_directory, error);
+
+	scan_directory();
+	evict("");
+	LOG_STATUS("Opened the bake cache, blobs: ", _entries.size(), ", size: ", _total_size / (1024 * 1024), " MB");
+}
+
+BakeCache::~BakeCache() {
+	bake_cache_ptr = nullptr;
+}
+
+void BakeCache::scan_directory() {
+	std::error_code error;
+	for (const auto& entry : fs::directory_iterator(_directory, error)) {
+		if (!entry.is_regular_file(error)) {
+			continue;
+		}
+		//leftover of an interrupted store
+		if (entry.path().extension() == ".tmp") {
+			fs::remove(entry.path(), error);
+			continue;
+		}
+		Entry cache_entry{};
+		cache_entry.size = entry.file_size(error);
+		cache_entry.last_used = get_time(entry.last_write_time(error));
+		_entries[entry.path().filename().string()] = cache_entry;
+		_total_size += cache_entry.size;
+	}
+}
+
+void BakeCache::evict(const std::string& kept_filename) {
+	if (_total_size <= _size_limit) {
+		return;
+	}
+
+	std::vector<std::pair<int64_t, std::string>> order;
+	order.reserve(_entries.size());
+	for (const auto& [filename, entry] : _entries) {
+		if (filename != kept_filename) {
+			order.emplace_back(entry.last_used, filename);
+		}
+	}
+	std::sort(order.begin(), order.end());
+
+	std::error_code error;
+	for (const auto& [last_used, filename] : order) {
+		if (_total_size <= _size_limit) {
+			break;
+		}
+		fs::remove(fs::path(_directory) / filename, error);
+		_total_size -= _entries[filename].size;
+		_entries.erase(filename);
+		LOG_STATUS("Evicted ", filename, " from the bake cache.");
+	}
+}
+
+std::string BakeCache::get_filename(const std::string& kind, const BakeKey& key) const {
+	return kind + "_" + key.to_string() + ".bin";
+}
+
+MappedBlob BakeCache::load(const std::string& kind, const BakeKey& key) {
+	BakeCache& cache = *bake_cache_ptr;
+	const std::string filename = cache.get_filename(kind, key);
+
+	std::lock_guard<std::mutex> lock(cache._mutex);
+	auto entry = cache._entries.find(filename);
+	if (entry == cache._entries.end()) {
+		return MappedBlob();
+	}
+
+	const fs::path path = fs::path(cache._directory) / filename;
+	MappedBlob blob;
+	std::error_code error;
+	if (!blob.map(path.string())) {
+		LOG_WARNING("Removed the broken blob ", filename, " from the bake cache.");
+		fs::remove(path, error);
+		cache._total_size -= entry->second.size;
+		cache._entries.erase(entry);
+		return MappedBlob();
+	}
+
+	const auto now = fs::file_time_type::clock::now();
+	fs::last_write_time(path, now, error);
+	entry->second.last_used = get_time(now);
+	return blob;
+}
+
+void BakeCache::store(const std::string& kind, const BakeKey& key, const void* data, size_t size) {
+	BakeCache& cache = *bake_cache_ptr;
+	const std::string filename = cache.get_filename(kind, key);
+	const fs::path path = fs::path(cache._directory) / filename;
+	const fs::path temporary_path = fs::path(cache._directory) / (filename + ".tmp");
+
+	//written aside and renamed, a reader never maps a partial blob
+	{
+		std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+		BlobHeader header{ BLOB_MAGIC, BAKE_CACHE_VERSION, size };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(BlobHeader));
+		file.write(static_cast<const char*>(data), size);
+		if (!file) {
+			LOG_WARNING("Failed to write ", filename, " to the bake cache.");
+			file.close();
+			std::error_code error;
+			fs::remove(temporary_path, error);
+			return;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(cache._mutex);
+	std::error_code error;
+	fs::rename(temporary_path, path, error);
+	if (error) {
+		LOG_WARNING("Failed to write ", filename, " to the bake cache.");
+		fs::remove(temporary_path, error);
+		return;
+	}
+
+	Entry& entry = cache._entries[filename];
+	cache._total_size -= entry.size;
+	entry.size = sizeof(BlobHeader) + size;
+	entry.last_used = get_time(fs::last_write_time(path, error));
+	cache._total_size += entry.size;
+	cache.evict(filename);
+}
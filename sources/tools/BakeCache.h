@@ -0,0 +1,92 @@
+#pragma once
+#include "Utils.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <type_traits>
+
+//FNV-1a hash of the inputs and parameters of a bake
+class BakeKey {
+private:
+	uint64_t _hash = 14695981039346656037ull;
+
+public:
+	BakeKey& add(const void* data, size_t size) noexcept;
+	BakeKey& add(const std::string& value) noexcept;
+	//content of the file, not its name or time
+	BakeKey& add_file(const std::string& filename);
+
+	template<typename T>
+	BakeKey& add(const T& value) noexcept {
+		static_assert(std::is_trivially_copyable_v<T>, "BakeKey::add() needs plain data.");
+		return add(&value, sizeof(T));
+	}
+
+	inline uint64_t get() const noexcept { return _hash; }
+	//16 hex digits
+	std::string to_string() const;
+};
+
+//read only memory mapping of a cached blob, unmapped by the destructor
+class MappedBlob {
+private:
+	const char* _view = nullptr;
+	size_t _view_size = 0;
+#ifdef _WIN32
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#endif
+
+private:
+	void unmap() noexcept;
+
+public:
+	MappedBlob() noexcept {}
+	MappedBlob(MappedBlob&& blob) noexcept;
+	MappedBlob& operator=(MappedBlob&& blob) noexcept;
+	MappedBlob(const MappedBlob& blob) = delete;
+	MappedBlob& operator=(const MappedBlob& blob) = delete;
+
+	bool map(const std::string& filename) noexcept;
+
+	//the blob data without the header
+	const char* data() const noexcept;
+	size_t size() const noexcept;
+	inline explicit operator bool() const noexcept { return _view != nullptr; }
+
+	~MappedBlob();
+};
+
+//blobs of expensive precomputations under RENDERER_DIRECTORY/cache/v<version>,
+//named by their kind and key, the least recently used ones are removed over the size limit
+class BakeCache {
+private:
+	struct Entry {
+		uint64_t size;
+		//file write time, touched on every hit so the order survives restarts
+		int64_t last_used;
+	};
+
+	std::string _directory;
+	uint64_t _size_limit;
+	uint64_t _total_size = 0;
+	std::unordered_map<std::string, Entry> _entries;
+	std::mutex _mutex;
+
+	static inline BakeCache* bake_cache_ptr = nullptr;
+
+private:
+	void scan_directory();
+	//remove the least recently used blobs until the cache fits, keep the given one
+	void evict(const std::string& kept_filename);
+	std::string get_filename(const std::string& kind, const BakeKey& key) const;
+
+public:
+	explicit BakeCache(uint64_t size_limit = 1024ull * 1024 * 1024);
+
+	//empty if the blob is not cached or broken
+	static MappedBlob load(const std::string& kind, const BakeKey& key);
+	static void store(const std::string& kind, const BakeKey& key, const void* data, size_t size);
+
+	~BakeCache();
+};
@@ -0,0 +1,170 @@
+#include "Benchmark.h"
+#include "GpuProfiler.h"
+#include "FrameStatistics.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+const std::string benchmark_directory = std::string(RENDERER_DIRECTORY) + "/traces";
+
+Benchmark::Benchmark(const std::string& filename) {
+	if (!load_script(filename, _script)) {
+		LOG_ERROR("Failed to load the benchmark ", filename);
+	}
+	_frame_times.reserve(_script.frame_count);
+	LOG_STATUS("Benchmark ", _script.name, ": ", _script.frame_count, " frames after ", _script.warmup_count, " warmup frames.");
+}
+
+bool Benchmark::load_script(const std::string& filename, BenchmarkScript& script) {
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		return false;
+	}
+	script.name = std::filesystem::path(filename).stem().string();
+	script.output_filename = benchmark_directory + "/benchmark_" + script.name + ".json";
+
+	std::string line;
+	for (uint32_t line_number = 1; std::getline(file, line); line_number++) {
+		line = line.substr(0, line.find('#'));
+		std::istringstream stream(line);
+		std::string setting;
+		if (!(stream >> setting)) {
+			continue;
+		}
+
+		bool is_valid = true;
+		if (setting == "frames") {
+			is_valid = static_cast<bool>(stream >> script.frame_count);
+		}
+		else if (setting == "warmup") {
+			is_valid = static_cast<bool>(stream >> script.warmup_count);
+		}
+		else if (setting == "timestep") {
+			is_valid = stream >> script.timestep && script.timestep > 0.f;
+		}
+		else if (setting == "output") {
+			std::string output;
+			is_valid = static_cast<bool>(stream >> output);
+			script.output_filename = std::filesystem::path(output).is_absolute() ? output : std::string(RENDERER_DIRECTORY) + '/' + output;
+		}
+		else if (setting == "recording") {
+			std::string recording;
+			is_valid = stream >> recording &&
+				script.recording.load(std::filesystem::path(recording).is_absolute() ? recording : std::string(RENDERER_DIRECTORY) + '/' + recording);
+		}
+		else if (setting == "key") {
+			CameraKey key;
+			is_valid = static_cast<bool>(stream >> key.time >> key.position.x >> key.position.y >> key.position.z
+				>> key.forward.x >> key.forward.y >> key.forward.z);
+			if (is_valid) {
+				script.camera_path.add_key(key);
+			}
+		}
+		else {
+			is_valid = false;
+		}
+
+		if (!is_valid) {
+			LOG_WARNING(filename, ':', line_number, " - invalid line: ", line);
+			return false;
+		}
+	}
+	return script.frame_count > 0;
+}
+
+void Benchmark::update_camera(FreeCamera& camera) const noexcept {
+	if (!_script.recording.empty()) {
+		const InputFrame& frame = _script.recording[std::min<size_t>(_frame, _script.recording.size() - 1)];
+		camera.set_view(frame.position, frame.forward);
+	}
+	else if (!_script.camera_path.empty()) {
+		_script.camera_path.apply(camera, _frame * _script.timestep);
+	}
+}
+
+void Benchmark::end_frame(float frame_time) {
+	const uint32_t frame = _frame++;
+	if (frame < _script.warmup_count) {
+		return;
+	}
+
+	_frame_times.push_back(frame_time);
+	//GPU results are a few frames old, warmup frames cover the latency
+	for (const GpuScopeResult& result : GpuProfiler::get_results()) {
+		auto it = std::find_if(_gpu_times.begin(), _gpu_times.end(),
+			[&result](const Samples& samples) { return samples.name == result.name; });
+		if (it == _gpu_times.end()) {
+			_gpu_times.push_back(Samples{ result.name });
+			it = _gpu_times.end() - 1;
+		}
+		it->values.push_back(result.time);
+	}
+
+	const FrameCounters& counters = FrameStatistics::get_counters();
+	_draw_calls += counters.render_queue.draw_calls;
+	_triangles += counters.render_queue.triangles;
+
+	const std::vector<MemoryHeapStatistics>& heaps = FrameStatistics::get_heaps();
+	_peak_heap_usage.resize(heaps.size(), 0);
+	for (size_t i = 0; i < heaps.size(); i++) {
+		_peak_heap_usage[i] = std::max(_peak_heap_usage[i], heaps[i].usage);
+	}
+}
+
+static void write_samples(std::ofstream& file, std::vector<float> values) {
+	if (values.empty()) {
+		file << "null";
+		return;
+	}
+	std::sort(values.begin(), values.end());
+	//nearest rank
+	auto percentile = [&values](float p) {
+		const size_t rank = static_cast<size_t>(std::ceil(p / 100.f * values.size()));
+		return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+	};
+	const double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+	file << "{\"mean\":" << mean << ",\"min\":" << values.front() << ",\"max\":" << values.back()
+		<< ",\"p50\":" << percentile(50.f) << ",\"p95\":" << percentile(95.f) << ",\"p99\":" << percentile(99.f) << '}';
+}
+
+bool Benchmark::write_results() const {
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(_script.output_filename).parent_path(), error);
+	std::ofstream file(_script.output_filename, std::ios::trunc);
+	if (!file.is_open()) {
+		LOG_WARNING("Failed to write the benchmark results ", _script.output_filename);
+		return false;
+	}
+
+	const size_t frame_count = std::max<size_t>(_frame_times.size(), 1);
+	file << "{\n\"benchmark\":\"" << _script.name << "\",\n"
+		<< "\"frames\":" << _frame_times.size() << ",\n"
+		<< "\"timestep_ms\":" << _script.timestep << ",\n"
+		<< "\"frame_time_ms\":";
+	write_samples(file, _frame_times);
+
+	//pass names are identifiers or literals without quotes
+	file << ",\n\"gpu_ms\":{";
+	for (size_t i = 0; i < _gpu_times.size(); i++) {
+		file << (i > 0 ? ",\n" : "\n") << '"' << _gpu_times[i].name << "\":";
+		write_samples(file, _gpu_times[i].values);
+	}
+	file << "\n},\n"
+		<< "\"draw_calls\":" << _draw_calls / frame_count << ",\n"
+		<< "\"triangles\":" << _triangles / frame_count << ",\n"
+		<< "\"memory_heaps\":[";
+
+	const std::vector<MemoryHeapStatistics>& heaps = FrameStatistics::get_heaps();
+	for (size_t i = 0; i < heaps.size(); i++) {
+		file << (i > 0 ? ",\n" : "\n") << "{\"size\":" << heaps[i].size
+			<< ",\"budget\":" << heaps[i].budget
+			<< ",\"peak_usage\":" << (i < _peak_heap_usage.size() ? _peak_heap_usage[i] : 0)
+			<< ",\"device_local\":" << (heaps[i].is_device_local ? "true" : "false") << '}';
+	}
+	file << "\n]\n}\n";
+	LOG_STATUS("Wrote the benchmark results to ", _script.output_filename);
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "CameraPath.h"
+#include "InputRecording.h"
+#include <string>
+#include <vector>
+
+//text file with one setting per line, # starts a comment:
+//	frames 600				- measured frames
+//	warmup 30				- frames before the measurement
+//	timestep 16.667			- fixed delta time in ms
+//	output benchmarks/a.json	- relative to RENDERER_DIRECTORY, traces/benchmark_<name>.json by default
+//	key 0 0 0 -5 0 0 1		- camera key: time in ms, position, forward
+//	recording traces/a.ecir	- camera transforms of an input recording, one per frame, instead of the keys
+struct BenchmarkScript {
+	std::string name;
+	uint32_t frame_count = 600;
+	uint32_t warmup_count = 30;
+	float timestep = 1000.f / 60.f;
+	std::string output_filename;
+	CameraPath camera_path;
+	InputRecording recording;
+};
+
+//drives the camera at a fixed timestep and writes the frame time percentiles,
+//GPU pass times and memory heaps of the measured frames to JSON
+class Benchmark {
+private:
+	struct Samples {
+		std::string name;
+		std::vector<float> values;
+	};
+
+	BenchmarkScript _script;
+	uint32_t _frame = 0;
+
+	std::vector<float> _frame_times;
+	//in the order of the first appearance
+	std::vector<Samples> _gpu_times;
+	uint64_t _draw_calls = 0;
+	uint64_t _triangles = 0;
+	std::vector<uint64_t> _peak_heap_usage;
+
+private:
+	static bool load_script(const std::string& filename, BenchmarkScript& script);
+
+public:
+	explicit Benchmark(const std::string& filename);
+
+	inline bool is_finished() const noexcept { return _frame >= _script.warmup_count + _script.frame_count; }
+	inline float get_timestep() const noexcept { return _script.timestep; }
+
+	//call before the frame is recorded
+	void update_camera(FreeCamera& camera) const noexcept;
+	//call after the frame is submitted, frame_time is the measured wall time in ms
+	void end_frame(float frame_time);
+
+	bool write_results() const;
+};
@@ -1,5 +1,6 @@
 #include "Core.h"
 #include "Window.h"
+#include "VulkanDataObjects.h"
 #include <iostream>
 #include <array>
 #include <unordered_set>
@@ -22,24 +23,31 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL messenger_callback(VkDebugUtilsMessageSeve
 
 
 
-Core::Core(GLFWwindow* window, const char* application_name, const char* engine_name) {
+Core::Core(const Window& window, const char* application_name, const char* engine_name) {
 
 	assert(core_ptr == nullptr && "There is only one core instance.");
 	core_ptr = this;
+	_is_headless = window.is_headless();
 
 	std::vector<const char*> available_layers;
-	create_instance(window, application_name,engine_name, available_layers);
+	create_instance(window.get_window(), application_name,engine_name, available_layers);
 	pick_physical_device();
 	create_device(available_layers);
-	create_swapchain(window);
+	if (_is_headless) {
+		create_offscreen_images(window.get_width(), window.get_height());
+	}
+	else {
+		create_swapchain(window.get_window());
+	}
 }
 
 void Core::create_instance(GLFWwindow* window, const char* application_name, const char* engine_name, std::vector<const char*> available_layers) {
 	VkInstanceCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 
+	//headless instances do not need the surface extensions
 	uint32_t extensions_count = 0;
-	const char** glfw_extensions = glfwGetRequiredInstanceExtensions(&extensions_count);
+	const char** glfw_extensions = _is_headless ? nullptr : glfwGetRequiredInstanceExtensions(&extensions_count);
 
 	std::vector<const char*> extensions(glfw_extensions, glfw_extensions + extensions_count);
 
@@ -117,6 +125,9 @@ void Core::create_instance(GLFWwindow* window, const char* application_name, con
 
 
 
+	if (_is_headless) {
+		return;
+	}
 	VK_ASSERT(glfwCreateWindowSurface(_instance, window, nullptr, &_surface), "glfwCreateWindowSurface() - FAILED");
 	LOG_STATUS("Surface created.");
 }
@@ -152,6 +163,9 @@ void Core::pick_physical_device() {
 		}
 
 		for (auto& i : required_device_extensions) {
+			if (_is_headless) {
+				break;
+			}
 			bool is_found = false;
 			for (auto& extension : extensions_properties) {
 				if (strcmp(i, extension.extensionName) == 0) {
@@ -172,8 +186,11 @@ void Core::pick_physical_device() {
 				graphics_family = idx;
 			}
 
-			VkBool32 is_present_supported;
-			vkGetPhysicalDeviceSurfaceSupportKHR(phys_dev, idx, _surface, &is_present_supported);
+			//headless frames are only read back from the graphics queue
+			VkBool32 is_present_supported = _is_headless && graphics_family.has_value();
+			if (!_is_headless) {
+				vkGetPhysicalDeviceSurfaceSupportKHR(phys_dev, idx, _surface, &is_present_supported);
+			}
 
 			if (is_present_supported) {
 				present_family = idx;
@@ -206,6 +223,9 @@ void Core::create_device(std::vector<const char*> available_layers) {
 	VkPhysicalDeviceProperties phys_dev_properties;
 	vkGetPhysicalDeviceProperties(_physical_device, &phys_dev_properties);
 	_min_uniform_offset_alignment = phys_dev_properties.limits.minUniformBufferOffsetAlignment;
+	if (phys_dev_properties.limits.timestampComputeAndGraphics) {
+		_timestamp_period = phys_dev_properties.limits.timestampPeriod;
+	}
 
 	VkDeviceCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -242,8 +262,33 @@ void Core::create_device(std::vector<const char*> available_layers) {
 	features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
 	features2.pNext = &descriptor_indexing_features;
 
-	create_info.enabledExtensionCount = required_device_extension_count;
-	create_info.ppEnabledExtensionNames = required_device_extensions.data();
+	//optional, the GPU profiler counts the invocations of every render unit
+	VkPhysicalDeviceFeatures supported_features;
+	vkGetPhysicalDeviceFeatures(_physical_device, &supported_features);
+	_is_pipeline_statistics_supported = supported_features.pipelineStatisticsQuery;
+	features2.features.pipelineStatisticsQuery = supported_features.pipelineStatisticsQuery;
+
+	std::vector<const char*> device_extensions;
+	if (!_is_headless) {
+		device_extensions.assign(required_device_extensions.begin(), required_device_extensions.end());
+	}
+
+	//optional, lets the texture streamer read the video memory budget
+	uint32_t extension_properties_count;
+	vkEnumerateDeviceExtensionProperties(_physical_device, nullptr, &extension_properties_count, nullptr);
+	std::vector<VkExtensionProperties> extensions_properties(extension_properties_count);
+	vkEnumerateDeviceExtensionProperties(_physical_device, nullptr, &extension_properties_count, extensions_properties.data());
+	for (auto& extension : extensions_properties) {
+		if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+			device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+			_is_memory_budget_supported = true;
+			LOG_STATUS("VK_EXT_memory_budget is supported.");
+			break;
+		}
+	}
+
+	create_info.enabledExtensionCount = device_extensions.size();
+	create_info.ppEnabledExtensionNames = device_extensions.data();
 	create_info.queueCreateInfoCount = queue_create_info.size();
 	create_info.pQueueCreateInfos = queue_create_info.data();
 
@@ -340,7 +385,10 @@ void Core::create_swapchain(GLFWwindow* window) {
 	create_info.imageColorSpace = preffered_format.colorSpace;
 	create_info.imageFormat = _swapchain_info.format;
 	create_info.imageExtent = { _swapchain_info.width, _swapchain_info.height };
-	create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	//transfer lets the compute post-process blit into the swapchain
+	_swapchain_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+		(surface_capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+	create_info.imageUsage = _swapchain_info.usage;
 	create_info.minImageCount = surface_capabilities.minImageCount + 1;
 	if (create_info.minImageCount > surface_capabilities.maxImageCount) {
 		create_info.minImageCount = surface_capabilities.minImageCount;
@@ -368,7 +416,7 @@ void Core::create_swapchain(GLFWwindow* window) {
 	vkGetSwapchainImagesKHR(_device, _swapchain, &_swapchain_info.image_count, nullptr);
 }
 
-VkFormat Core::find_appropriate_format(const std::vector<VkFormat>& candidates, VkFormatFeatureFlagBits features, VkImageTiling tiling) noexcept {
+VkFormat Core::find_appropriate_format(const std::vector<VkFormat>& candidates, VkFormatFeatureFlags features, VkImageTiling tiling) noexcept {
 	for (VkFormat format : candidates) {
 		VkFormatProperties properties;
 		vkGetPhysicalDeviceFormatProperties(core_ptr->_physical_device, format, &properties);
@@ -383,7 +431,51 @@ VkFormat Core::find_appropriate_format(const std::vector<VkFormat>& candidates,
 	LOG_ERROR("Failed to find appropriate format.");
 }
 
+void Core::create_offscreen_images(uint32_t width, uint32_t height) {
+	_swapchain_info.width = width;
+	_swapchain_info.height = height;
+	_swapchain_info.image_count = 2;
+	//same formats as the preferred surface formats, so the frames look the same
+	_swapchain_info.format = find_appropriate_format({ VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_UNORM },
+		VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT, VK_IMAGE_TILING_OPTIMAL);
+	_swapchain_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+	_offscreen_images.resize(_swapchain_info.image_count);
+	_offscreen_memory.resize(_swapchain_info.image_count);
+	for (uint32_t i = 0; i < _swapchain_info.image_count; i++) {
+		VkImageCreateInfo create_info{};
+		create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		create_info.imageType = VK_IMAGE_TYPE_2D;
+		create_info.extent = { width, height, 1 };
+		create_info.mipLevels = 1;
+		create_info.arrayLayers = 1;
+		create_info.format = _swapchain_info.format;
+		create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		create_info.usage = _swapchain_info.usage;
+		create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+		if (vkCreateImage(_device, &create_info, nullptr, &_offscreen_images[i]) != VK_SUCCESS) {
+			LOG_ERROR("vkCreateImage(), offscreen image - FAILED");
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(_device, _offscreen_images[i], &requirements);
+		VkMemoryAllocateInfo alloc_info{};
+		alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		alloc_info.allocationSize = requirements.size;
+		alloc_info.memoryTypeIndex = VulkanDataObject::find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (vkAllocateMemory(_device, &alloc_info, nullptr, &_offscreen_memory[i]) != VK_SUCCESS ||
+			vkBindImageMemory(_device, _offscreen_images[i], _offscreen_memory[i], 0) != VK_SUCCESS) {
+			LOG_ERROR("vkAllocateMemory(), offscreen image - FAILED");
+		}
+	}
+	LOG_STATUS("Created headless render targets ", width, "x", height, ", format: ", _swapchain_info.format);
+}
+
 std::vector<VkImage> Core::get_swapchain_images() noexcept {
+	if (core_ptr->_is_headless) {
+		return core_ptr->_offscreen_images;
+	}
 	uint32_t image_count = Core::get_swapchain_image_count();
 	std::vector<VkImage> images(image_count);
 	vkGetSwapchainImagesKHR(Core::get_device(), Core::get_swapchain(), &image_count, images.data());
@@ -392,9 +484,18 @@ std::vector<VkImage> Core::get_swapchain_images() noexcept {
 }
 
 Core::~Core() {
-	vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+	for (uint32_t i = 0; i < _offscreen_images.size(); i++) {
+		vkDestroyImage(_device, _offscreen_images[i], nullptr);
+		vkFreeMemory(_device, _offscreen_memory[i], nullptr);
+	}
+	//the swapchain extensions are not enabled in headless mode
+	if (!_is_headless) {
+		vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+	}
 	vkDestroyDevice(_device, nullptr);
-	vkDestroySurfaceKHR(_instance, _surface, nullptr);
+	if (!_is_headless) {
+		vkDestroySurfaceKHR(_instance, _surface, nullptr);
+	}
 
 #ifdef DEBUG
 	if (_debug_messenger != VK_NULL_HANDLE) {
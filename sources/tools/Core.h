@@ -20,6 +20,7 @@ private:
 		uint32_t width;
 		uint32_t height;
 		VkFormat format;
+		VkImageUsageFlags usage;
 		uint32_t image_count;
 		uint32_t image_index = 0;
 		uint32_t current_frame = 1;
@@ -27,11 +28,20 @@ private:
 	};
 	SwapchainInfo _swapchain_info;
 
+	//without a window the swapchain images are plain images read back by FrameCapture
+	bool _is_headless = false;
+	std::vector<VkImage> _offscreen_images;
+	std::vector<VkDeviceMemory> _offscreen_memory;
+
 	VkDeviceSize _min_uniform_offset_alignment;
+	bool _is_memory_budget_supported = false;
+	//nanoseconds per timestamp tick, 0 if the graphics queue can not write timestamps
+	float _timestamp_period = 0.f;
+	bool _is_pipeline_statistics_supported = false;
 
 	static Core* core_ptr;
 public:
-	Core(struct GLFWwindow* window, const char* application_name, const char* engine_name);
+	Core(const class Window& window, const char* application_name, const char* engine_name);
 
 	static inline VkInstance get_instance() noexcept { return core_ptr->_instance; }
 	static inline VkPhysicalDevice get_physical_device() noexcept { return core_ptr->_physical_device; }
@@ -47,19 +57,37 @@ public:
 	static inline uint32_t get_swapchain_width() noexcept { return core_ptr->_swapchain_info.width; }
 	static inline uint32_t get_swapchain_height() noexcept { return core_ptr->_swapchain_info.height; }
 	static inline VkFormat get_swapchain_format() noexcept { return core_ptr->_swapchain_info.format; }
+	static inline VkImageUsageFlags get_swapchain_usage() noexcept { return core_ptr->_swapchain_info.usage; }
 	static inline uint32_t get_swapchain_image_count() noexcept { return core_ptr->_swapchain_info.image_count; }
 	static inline uint32_t get_image_index() noexcept { return core_ptr->_swapchain_info.image_index; }
 	static inline uint32_t get_current_frame() noexcept { return core_ptr->_swapchain_info.current_frame; }
 	static inline uint32_t get_previous_frame() noexcept { return core_ptr->_swapchain_info.previous_frame; }
+	static inline bool is_headless() noexcept { return core_ptr->_is_headless; }
+	//layout the swapchain images are left in after the frame
+	static inline VkImageLayout get_present_layout() noexcept {
+		return core_ptr->_is_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	}
 
 	static inline VkDeviceSize get_min_uniform_offset_alignment() noexcept { return core_ptr->_min_uniform_offset_alignment; }
+	static inline bool is_memory_budget_supported() noexcept { return core_ptr->_is_memory_budget_supported; }
+	static inline float get_timestamp_period() noexcept { return core_ptr->_timestamp_period; }
+	static inline bool is_pipeline_statistics_supported() noexcept { return core_ptr->_is_pipeline_statistics_supported; }
 
-	static VkFormat find_appropriate_format(const std::vector<VkFormat>& candidates, VkFormatFeatureFlagBits features, VkImageTiling tiling) noexcept;
+	//first candidate supporting all the features, candidates go from the preferred one
+	static VkFormat find_appropriate_format(const std::vector<VkFormat>& candidates, VkFormatFeatureFlags features, VkImageTiling tiling) noexcept;
 
 	inline VkResult acquire_next_image(VkSemaphore semaphore, VkFence fence) noexcept{
+		if (_is_headless) {
+			//the frame fence was waited, so the image of this frame is free
+			_swapchain_info.image_index = _swapchain_info.current_frame;
+			return VK_SUCCESS;
+		}
 		return vkAcquireNextImageKHR(_device, _swapchain, UINT32_MAX, semaphore, fence, &_swapchain_info.image_index);
 	}
 	inline VkResult queue_present(const std::vector<VkSemaphore>& wait_semaphores) {
+		if (_is_headless) {
+			return VK_SUCCESS;
+		}
 		VkPresentInfoKHR present_info{};
 		present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 		present_info.pImageIndices = &_swapchain_info.image_index;
@@ -83,4 +111,5 @@ private:
 	void pick_physical_device();
 	void create_device(std::vector<const char*> available_layers);
 	void create_swapchain(GLFWwindow* window);
+	void create_offscreen_images(uint32_t width, uint32_t height);
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "CpuProfiler.h"
+
+#ifdef CPU_PROFILER
+
+#include "Utils.h"
+#include "imgui.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+const std::string trace_directory = std::string(RENDERER_DIRECTORY) + "/traces";
+
+static const std::chrono::steady_clock::time_point profiler_start = std::chrono::steady_clock::now();
+
+int64_t CpuProfiler::now() noexcept {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profiler_start).count();
+}
+
+CpuProfiler::ThreadZones& CpuProfiler::get_thread_zones() noexcept {
+	if (thread_zones == nullptr) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_threads.push_back(std::unique_ptr<ThreadZones>(new ThreadZones()));
+		thread_zones = _threads.back().get();
+		thread_zones->thread_id = static_cast<uint32_t>(_threads.size() - 1);
+	}
+	return *thread_zones;
+}
+
+void CpuProfiler::end_zone(const char* name, int64_t begin, uint32_t depth) noexcept {
+	ThreadZones& zones = *thread_zones;
+	zones.depth = depth;
+	const uint64_t index = zones.write_index.load(std::memory_order_relaxed);
+	ZoneSlot& slot = zones.slots[index % CPU_PROFILER_ZONE_CAPACITY];
+	slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.begin.store(begin, std::memory_order_relaxed);
+	slot.end.store(now(), std::memory_order_relaxed);
+	slot.depth.store(depth, std::memory_order_relaxed);
+	slot.sequence.store(2 * index + 2, std::memory_order_release);
+	zones.write_index.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::begin_frame() noexcept {
+	_frame_starts[_frame_count % CPU_PROFILER_FRAME_CAPACITY] = now();
+	_frame_count++;
+}
+
+std::vector<std::pair<uint32_t, CpuZone>> CpuProfiler::collect_zones(int64_t begin) noexcept {
+	std::vector<std::pair<uint32_t, CpuZone>> result;
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (const auto& thread : _threads) {
+		const uint64_t write_index = thread->write_index.load(std::memory_order_acquire);
+		const uint64_t first = write_index > CPU_PROFILER_ZONE_CAPACITY ? write_index - CPU_PROFILER_ZONE_CAPACITY : 0;
+		for (uint64_t i = first; i < write_index; i++) {
+			const ZoneSlot& slot = thread->slots[i % CPU_PROFILER_ZONE_CAPACITY];
+			const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+			//the slot is being written or already holds a newer zone
+			if (sequence != 2 * i + 2) {
+				continue;
+			}
+			const CpuZone zone{
+				slot.name.load(std::memory_order_relaxed),
+				slot.begin.load(std::memory_order_relaxed),
+				slot.end.load(std::memory_order_relaxed),
+				slot.depth.load(std::memory_order_relaxed) };
+			//the thread overwrote the slot while it was copied
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+				continue;
+			}
+			if (zone.end >= begin) {
+				result.emplace_back(thread->thread_id, zone);
+			}
+		}
+	}
+	return result;
+}
+
+bool CpuProfiler::dump_trace(const std::string& path) noexcept {
+	std::vector<std::pair<uint32_t, CpuZone>> zones = collect_zones(0);
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open()) {
+		LOG_WARNING("Failed to write the CPU trace ", path);
+		return false;
+	}
+
+	//complete events in microseconds, zone names are identifiers or literals without quotes
+	file << "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < zones.size(); i++) {
+		const auto& [thread_id, zone] = zones[i];
+		file << "{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread_id
+			<< ",\"ts\":" << zone.begin / 1000.0 << ",\"dur\":" << (zone.end - zone.begin) / 1000.0 << '}'
+			<< (i + 1 < zones.size() ? ",\n" : "\n");
+	}
+	file << "],\"displayTimeUnit\":\"ms\"}\n";
+	LOG_STATUS("Wrote ", zones.size(), " CPU zones to ", path);
+	return true;
+}
+
+void CpuProfiler::show_gui() noexcept {
+	if (ImGui::Button("Save CPU trace")) {
+		dump_trace(trace_directory + "/cpu_trace_" + std::to_string(_frame_count) + ".json");
+	}
+	if (_frame_count < 2) {
+		return;
+	}
+
+	//begin_frame is called before the gui, so the last frame is finished
+	const int64_t frame_begin = _frame_starts[(_frame_count - 2) % CPU_PROFILER_FRAME_CAPACITY];
+	const int64_t frame_end = _frame_starts[(_frame_count - 1) % CPU_PROFILER_FRAME_CAPACITY];
+	const float frame_time = (frame_end - frame_begin) / 1000000.f;
+	ImGui::Text("Last frame: %.3f ms", frame_time);
+
+	std::vector<std::pair<uint32_t, CpuZone>> zones = collect_zones(frame_begin);
+	std::erase_if(zones, [frame_end](const auto& zone) { return zone.second.begin > frame_end; });
+	std::sort(zones.begin(), zones.end(), [](const auto& a, const auto& b) {
+		return a.first != b.first ? a.first < b.first : a.second.depth < b.second.depth; });
+
+	//one band per thread, a row per depth
+	const float row_height = ImGui::GetTextLineHeight() + 2.f;
+	const float width = std::max(ImGui::GetContentRegionAvail().x, 400.f);
+	const float scale = width / static_cast<float>(frame_end - frame_begin);
+	ImDrawList* draw_list = ImGui::GetWindowDrawList();
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	float band_top = 0.f;
+	for (size_t i = 0; i < zones.size();) {
+		const uint32_t thread_id = zones[i].first;
+		uint32_t max_depth = 0;
+		for (; i < zones.size() && zones[i].first == thread_id; i++) {
+			const CpuZone& zone = zones[i].second;
+			max_depth = std::max(max_depth, zone.depth);
+
+			const float x0 = origin.x + std::max<int64_t>(zone.begin - frame_begin, 0) * scale;
+			const float x1 = origin.x + std::min<int64_t>(zone.end - frame_begin, frame_end - frame_begin) * scale;
+			const float y0 = origin.y + band_top + zone.depth * row_height;
+			const ImVec2 min(x0, y0);
+			const ImVec2 max(std::max(x1, x0 + 1.f), y0 + row_height - 1.f);
+			const ImU32 color = ImColor::HSV((std::hash<const char*>{}(zone.name) % 64) / 64.f, 0.5f, 0.7f);
+			draw_list->AddRectFilled(min, max, color);
+			draw_list->PushClipRect(min, max, true);
+			draw_list->AddText(ImVec2(x0 + 2.f, y0), IM_COL32_WHITE, zone.name);
+			draw_list->PopClipRect();
+
+			if (ImGui::IsMouseHoveringRect(min, max)) {
+				ImGui::SetTooltip("%s\nthread %u\n%.3f ms", zone.name, thread_id, (zone.end - zone.begin) / 1000000.f);
+			}
+		}
+		band_top += (max_depth + 1) * row_height + 4.f;
+	}
+	ImGui::Dummy(ImVec2(width, band_top));
+}
+
+#endif // CPU_PROFILER
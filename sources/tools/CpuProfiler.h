@@ -0,0 +1,99 @@
+#pragma once
+
+//PROFILE_SCOPE("name") times the enclosing scope on any thread, the name must be a string literal,
+//without CPU_PROFILER the macros expand to nothing and the profiler is not compiled
+#ifdef CPU_PROFILER
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+constexpr uint32_t CPU_PROFILER_ZONE_CAPACITY = 1 << 16;
+constexpr uint32_t CPU_PROFILER_FRAME_CAPACITY = 256;
+
+struct CpuZone {
+	const char* name;
+	int64_t begin;//ns since the profiler start
+	int64_t end;
+	uint32_t depth;
+};
+
+//every thread writes its zones to its own ring buffer without locks, the oldest ones are overwritten,
+//every slot is a seqlock so readers drop a zone which is overwritten while they copy it
+class CpuProfiler {
+private:
+	struct ZoneSlot {
+		//odd while the zone is written, 2 * (write index + 1) once it is published
+		std::atomic<uint64_t> sequence = 0;
+		std::atomic<const char*> name;
+		std::atomic<int64_t> begin;
+		std::atomic<int64_t> end;
+		std::atomic<uint32_t> depth;
+	};
+
+	struct ThreadZones {
+		std::unique_ptr<ZoneSlot[]> slots = std::unique_ptr<ZoneSlot[]>(new ZoneSlot[CPU_PROFILER_ZONE_CAPACITY]);
+		std::atomic<uint64_t> write_index = 0;
+		uint32_t depth = 0;
+		uint32_t thread_id = 0;
+	};
+
+	//threads register once, the buffers outlive them so their zones can still be dumped
+	static inline std::mutex _mutex;
+	static inline std::vector<std::unique_ptr<ThreadZones>> _threads;
+	//frame starts written by the main thread
+	static inline int64_t _frame_starts[CPU_PROFILER_FRAME_CAPACITY]{};
+	static inline uint64_t _frame_count = 0;
+
+	static inline thread_local ThreadZones* thread_zones = nullptr;
+
+private:
+	static ThreadZones& get_thread_zones() noexcept;
+	//zones of every thread which end after begin
+	static std::vector<std::pair<uint32_t, CpuZone>> collect_zones(int64_t begin) noexcept;
+
+public:
+	static int64_t now() noexcept;
+
+	static inline uint32_t begin_zone() noexcept { return get_thread_zones().depth++; }
+	static void end_zone(const char* name, int64_t begin, uint32_t depth) noexcept;
+
+	//call on the main thread at the start of every frame
+	static void begin_frame() noexcept;
+
+	//writes the recorded zones as Chrome trace_event JSON, open it in chrome://tracing or Perfetto
+	static bool dump_trace(const std::string& path) noexcept;
+	//flame graph of the last finished frame
+	static void show_gui() noexcept;
+};
+
+class CpuScope {
+private:
+	const char* _name;
+	uint32_t _depth;
+	int64_t _begin;
+
+public:
+	CpuScope(const char* name) noexcept : _name(name), _depth(CpuProfiler::begin_zone()), _begin(CpuProfiler::now()) {}
+	CpuScope(const CpuScope& scope) = delete;
+	CpuScope& operator=(const CpuScope& scope) = delete;
+
+	~CpuScope() {
+		CpuProfiler::end_zone(_name, _begin, _depth);
+	}
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) CpuScope PROFILE_CONCAT(cpu_scope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+
+#endif // CPU_PROFILER
@@ -0,0 +1,110 @@
+#include "FrameCapture.h"
+#include "CommandManager.h"
+#include "ImageExport.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+FrameCapture::FrameCapture(const std::string& output_directory) :
+	_output_directory(output_directory),
+	_images(Core::get_swapchain_images()) {
+	const VkDeviceSize size = static_cast<VkDeviceSize>(Core::get_swapchain_width()) * Core::get_swapchain_height() * 4;
+	_readbacks.resize(Core::get_swapchain_image_count());
+	for (auto& readback : _readbacks) {
+		readback.buffer = new VulkanBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT, size,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		readback.data = reinterpret_cast<const uint8_t*>(readback.buffer->map_memory(0, VK_WHOLE_SIZE));
+	}
+
+	if (!_output_directory.empty()) {
+		std::error_code error;
+		std::filesystem::create_directories(_output_directory, error);
+		LOG_STATUS("Writing frames to ", _output_directory);
+	}
+	LOG_STATUS("Created FrameCapture.");
+}
+
+FrameCapture::~FrameCapture() {
+	for (auto& write : _writes) {
+		write.wait();
+	}
+	for (auto& readback : _readbacks) {
+		delete readback.buffer;
+	}
+}
+
+void FrameCapture::finish_readback(Readback& readback) {
+	const uint64_t frame = readback.frame;
+	readback.frame = UINT64_MAX;
+	if (_output_directory.empty()) {
+		return;
+	}
+
+	std::vector<uint8_t> texels(readback.buffer->get_size());
+	memcpy(texels.data(), readback.data, texels.size());
+
+	std::string number = std::to_string(frame);
+	number.insert(0, number.size() < 5 ? 5 - number.size() : 0, '0');
+	const std::string path = _output_directory + "/frame_" + number + ".png";
+	const bool is_bgra = Core::get_swapchain_format() == VK_FORMAT_B8G8R8A8_SRGB ||
+		Core::get_swapchain_format() == VK_FORMAT_B8G8R8A8_UNORM;
+	const uint32_t width = Core::get_swapchain_width();
+	const uint32_t height = Core::get_swapchain_height();
+	_writes.push_back(ThreadPool::submit([path, texels = std::move(texels), width, height, is_bgra] {
+		return image_export::write_png(path, width, height, texels.data(), is_bgra);
+		}));
+
+	//drop the finished writes
+	std::erase_if(_writes, [](const std::future<bool>& write) {
+		return write.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+}
+
+void FrameCapture::begin_frame() {
+	//the fence of this frame was waited, the copy recorded in it is done
+	Readback& readback = _readbacks[Core::get_current_frame()];
+	if (readback.frame != UINT64_MAX) {
+		finish_readback(readback);
+	}
+}
+
+void FrameCapture::record(VkCommandBuffer command_buffer) noexcept {
+	Readback& readback = _readbacks[Core::get_current_frame()];
+
+	//the render pass left the image in the transfer source layout
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+	VkBufferImageCopy region{};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { Core::get_swapchain_width(), Core::get_swapchain_height(), 1 };
+	CommandManager::copy_image_to_buffer(command_buffer,
+		_images[Core::get_image_index()], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		*readback.buffer, { region });
+
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT);
+	readback.frame = _frame++;
+}
+
+void FrameCapture::flush() {
+	//in the frame order
+	std::vector<Readback*> pending;
+	for (auto& readback : _readbacks) {
+		if (readback.frame != UINT64_MAX) {
+			pending.push_back(&readback);
+		}
+	}
+	std::sort(pending.begin(), pending.end(), [](const Readback* a, const Readback* b) { return a->frame < b->frame; });
+	for (Readback* readback : pending) {
+		finish_readback(*readback);
+	}
+
+	for (auto& write : _writes) {
+		write.wait();
+	}
+	_writes.clear();
+	LOG_STATUS("Captured ", _frame, " frames.");
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "VulkanDataObjects.h"
+#include <future>
+#include <string>
+
+//reads the headless frames back to host memory a few frames later without stalling,
+//writes them as PNG on the thread pool if the output directory is set
+class FrameCapture {
+private:
+	struct Readback {
+		VulkanBuffer* buffer;
+		const uint8_t* data;
+		//UINT64_MAX if nothing is pending
+		uint64_t frame = UINT64_MAX;
+	};
+
+	std::string _output_directory;
+	std::vector<VkImage> _images;
+	std::vector<Readback> _readbacks;
+	std::vector<std::future<bool>> _writes;
+	uint64_t _frame = 0;
+
+private:
+	void finish_readback(Readback& readback);
+
+public:
+	FrameCapture(const std::string& output_directory);
+
+	//call after the frame fence is waited
+	void begin_frame();
+	//call after the post-process, the swapchain image is in the present layout
+	void record(VkCommandBuffer command_buffer) noexcept;
+	//finish the pending frames, the device must be idle
+	void flush();
+
+	~FrameCapture();
+};
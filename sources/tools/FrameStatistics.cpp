@@ -0,0 +1,180 @@
+#include "FrameStatistics.h"
+#include "GpuProfiler.h"
+#include "imgui.h"
+#include <cassert>
+#include <algorithm>
+#include <filesystem>
+
+const std::string statistics_directory = std::string(RENDERER_DIRECTORY) + "/traces";
+
+FrameStatistics::FrameStatistics() {
+	assert(frame_statistics_ptr == nullptr && "There can be only one FrameStatistics.");
+	frame_statistics_ptr = this;
+	update_heaps();
+	LOG_STATUS("Created FrameStatistics.");
+}
+
+FrameStatistics::~FrameStatistics() {
+	stop_recording();
+	frame_statistics_ptr = nullptr;
+}
+
+void FrameStatistics::update_heaps() noexcept {
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties{};
+	budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+	VkPhysicalDeviceMemoryProperties2 memory_properties{};
+	memory_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	memory_properties.pNext = Core::is_memory_budget_supported() ? &budget_properties : nullptr;
+	vkGetPhysicalDeviceMemoryProperties2(Core::get_physical_device(), &memory_properties);
+
+	_heaps.resize(memory_properties.memoryProperties.memoryHeapCount);
+	for (uint32_t i = 0; i < _heaps.size(); i++) {
+		const VkMemoryHeap& heap = memory_properties.memoryProperties.memoryHeaps[i];
+		_heaps[i].size = heap.size;
+		_heaps[i].usage = budget_properties.heapUsage[i];
+		_heaps[i].budget = budget_properties.heapBudget[i];
+		_heaps[i].is_device_local = heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+	}
+}
+
+void FrameStatistics::end_frame(float delta_time, const RenderQueueStatistics& render_queue_statistics) {
+	_frame++;
+	_counters.frame_time = delta_time;
+	_counters.render_queue = render_queue_statistics;
+	_counters.upload_bytes = _upload_bytes.exchange(0, std::memory_order_relaxed);
+	update_heaps();
+
+	if (_csv.is_open()) {
+		write_csv_row();
+	}
+}
+
+bool FrameStatistics::start_recording() {
+	FrameStatistics& statistics = *frame_statistics_ptr;
+	if (statistics._csv.is_open()) {
+		return true;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(statistics_directory, error);
+	statistics._csv_path = statistics_directory + "/frame_statistics_" + std::to_string(statistics._frame) + ".csv";
+	statistics._csv.open(statistics._csv_path, std::ios::trunc);
+	if (!statistics._csv.is_open()) {
+		LOG_WARNING("Failed to open ", statistics._csv_path);
+		return false;
+	}
+
+	statistics._csv_scopes.clear();
+	for (const GpuScopeResult& result : GpuProfiler::get_results()) {
+		if (result.has_statistics) {
+			statistics._csv_scopes.push_back(result.name);
+		}
+	}
+	statistics.write_csv_header();
+	LOG_STATUS("Recording frame statistics to ", statistics._csv_path);
+	return true;
+}
+
+void FrameStatistics::stop_recording() noexcept {
+	FrameStatistics& statistics = *frame_statistics_ptr;
+	if (statistics._csv.is_open()) {
+		statistics._csv.close();
+		LOG_STATUS("Saved frame statistics to ", statistics._csv_path);
+	}
+}
+
+void FrameStatistics::write_csv_header() {
+	_csv << "frame,frame_ms,draw_calls,triangles,pipeline_binds,descriptor_binds,vertex_buffer_binds,upload_bytes";
+	for (uint32_t i = 0; i < _heaps.size(); i++) {
+		_csv << ",heap" << i << "_usage";
+	}
+	for (const auto& scope : _csv_scopes) {
+		_csv << ',' << scope << "_gpu_ms"
+			<< ',' << scope << "_input_primitives"
+			<< ',' << scope << "_vertex_invocations"
+			<< ',' << scope << "_clipping_invocations"
+			<< ',' << scope << "_clipping_primitives"
+			<< ',' << scope << "_fragment_invocations"
+			<< ',' << scope << "_compute_invocations";
+	}
+	_csv << '\n';
+}
+
+void FrameStatistics::write_csv_row() {
+	const RenderQueueStatistics& queue = _counters.render_queue;
+	_csv << _frame << ',' << _counters.frame_time << ',' << queue.draw_calls << ',' << queue.triangles << ','
+		<< queue.pipeline_binds << ',' << queue.descriptor_binds << ',' << queue.vertex_buffer_binds << ',' << _counters.upload_bytes;
+	for (const auto& heap : _heaps) {
+		_csv << ',' << heap.usage;
+	}
+
+	//GPU results are a few frames old, a scope missing in this frame leaves its cells empty
+	const std::vector<GpuScopeResult>& results = GpuProfiler::get_results();
+	for (const auto& scope : _csv_scopes) {
+		auto it = std::find_if(results.begin(), results.end(),
+			[&scope](const GpuScopeResult& result) { return result.has_statistics && scope == result.name; });
+		if (it == results.end()) {
+			_csv << ",,,,,,,";
+			continue;
+		}
+		const PipelineStatistics& statistics = it->statistics;
+		_csv << ',' << it->time << ',' << statistics.input_primitives << ',' << statistics.vertex_invocations << ','
+			<< statistics.clipping_invocations << ',' << statistics.clipping_primitives << ','
+			<< statistics.fragment_invocations << ',' << statistics.compute_invocations;
+	}
+	_csv << '\n';
+}
+
+void FrameStatistics::show_gui() noexcept {
+	FrameStatistics& statistics = *frame_statistics_ptr;
+	const FrameCounters& counters = statistics._counters;
+	ImGui::Text("Uploaded: %.1f KB", counters.upload_bytes / 1024.f);
+
+	for (uint32_t i = 0; i < statistics._heaps.size(); i++) {
+		const MemoryHeapStatistics& heap = statistics._heaps[i];
+		if (Core::is_memory_budget_supported()) {
+			ImGui::Text("Heap %u%s: %.1f / %.1f MB", i, heap.is_device_local ? " (device)" : "",
+				heap.usage / (1024.f * 1024.f), heap.budget / (1024.f * 1024.f));
+		}
+		else {
+			ImGui::Text("Heap %u%s: %.1f MB", i, heap.is_device_local ? " (device)" : "", heap.size / (1024.f * 1024.f));
+		}
+	}
+
+	if (ImGui::BeginTable("Pipeline statistics", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+		ImGui::TableSetupColumn("Unit");
+		ImGui::TableSetupColumn("Primitives");
+		ImGui::TableSetupColumn("Vertices");
+		ImGui::TableSetupColumn("Clipping in");
+		ImGui::TableSetupColumn("Clipping out");
+		ImGui::TableSetupColumn("Fragments");
+		ImGui::TableSetupColumn("Compute");
+		ImGui::TableHeadersRow();
+		for (const GpuScopeResult& result : GpuProfiler::get_results()) {
+			if (!result.has_statistics) {
+				continue;
+			}
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(result.name);
+			for (uint64_t value : { result.statistics.input_primitives, result.statistics.vertex_invocations,
+				result.statistics.clipping_invocations, result.statistics.clipping_primitives,
+				result.statistics.fragment_invocations, result.statistics.compute_invocations }) {
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", static_cast<unsigned long long>(value));
+			}
+		}
+		ImGui::EndTable();
+	}
+
+	bool is_recording = statistics._csv.is_open();
+	if (ImGui::Checkbox("Record statistics CSV", &is_recording)) {
+		if (is_recording) {
+			start_recording();
+		}
+		else {
+			stop_recording();
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Core.h"
+#include "RenderQueue.h"
+#include <atomic>
+#include <fstream>
+#include <string>
+
+struct MemoryHeapStatistics {
+	VkDeviceSize size;
+	//0 without VK_EXT_memory_budget
+	VkDeviceSize usage;
+	VkDeviceSize budget;
+	bool is_device_local;
+};
+
+struct FrameCounters {
+	float frame_time = 0.f;//ms
+	RenderQueueStatistics render_queue;
+	//written to the staging buffers
+	VkDeviceSize upload_bytes = 0;
+};
+
+//CPU side counters of the last frame and the device memory heaps,
+//can record them with the pipeline statistics of the render units to a CSV every frame
+class FrameStatistics {
+private:
+	//textures and meshes are uploaded from the loading threads too
+	std::atomic<VkDeviceSize> _upload_bytes = 0;
+
+	FrameCounters _counters;
+	std::vector<MemoryHeapStatistics> _heaps;
+
+	uint64_t _frame = 0;
+	std::ofstream _csv;
+	std::string _csv_path;
+	//columns are fixed when the recording starts
+	std::vector<std::string> _csv_scopes;
+
+	static inline FrameStatistics* frame_statistics_ptr = nullptr;
+
+private:
+	void update_heaps() noexcept;
+	void write_csv_header();
+	void write_csv_row();
+
+public:
+	FrameStatistics();
+
+	static inline void add_upload_bytes(VkDeviceSize size) noexcept {
+		frame_statistics_ptr->_upload_bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	//call after the frame is submitted
+	void end_frame(float delta_time, const RenderQueueStatistics& render_queue_statistics);
+
+	static inline const FrameCounters& get_counters() noexcept { return frame_statistics_ptr->_counters; }
+	static inline const std::vector<MemoryHeapStatistics>& get_heaps() noexcept { return frame_statistics_ptr->_heaps; }
+
+	static bool start_recording();
+	static void stop_recording() noexcept;
+	static inline bool is_recording() noexcept { return frame_statistics_ptr->_csv.is_open(); }
+
+	//counters, memory heaps and the pipeline statistics table
+	static void show_gui() noexcept;
+
+	~FrameStatistics();
+};
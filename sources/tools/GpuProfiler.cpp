@@ -0,0 +1,216 @@
+#include "GpuProfiler.h"
+#include "imgui.h"
+#include <cassert>
+
+//begin and end timestamp of every scope in a frame
+constexpr uint32_t GPU_PROFILER_FRAME_QUERIES = 128;
+constexpr uint32_t GPU_PROFILER_FRAME_STATISTICS = 16;
+constexpr VkQueryPipelineStatisticFlags GPU_PROFILER_STATISTICS_FLAGS =
+	VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+GpuProfiler::GpuProfiler() {
+	assert(gpu_profiler_ptr == nullptr && "There can be only one GpuProfiler.");
+	gpu_profiler_ptr = this;
+
+	const uint32_t frame_count = Core::get_swapchain_image_count();
+	_frames.resize(frame_count);
+	if (Core::get_timestamp_period() == 0.f) {
+		LOG_WARNING("Timestamps are not supported, GPU profiling is disabled.");
+		return;
+	}
+
+	VkQueryPoolCreateInfo create_info{};
+	create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	create_info.queryCount = frame_count * GPU_PROFILER_FRAME_QUERIES;
+	if (vkCreateQueryPool(Core::get_device(), &create_info, nullptr, &_query_pool) != VK_SUCCESS) {
+		LOG_WARNING("Failed to create the GPU profiler query pool, GPU profiling is disabled.");
+		_query_pool = VK_NULL_HANDLE;
+		return;
+	}
+	_timestamps.resize(GPU_PROFILER_FRAME_QUERIES);
+	create_statistics_pool(frame_count);
+	LOG_STATUS("Created GpuProfiler.");
+}
+
+void GpuProfiler::create_statistics_pool(uint32_t frame_count) noexcept {
+	if (!Core::is_pipeline_statistics_supported()) {
+		LOG_WARNING("Pipeline statistics queries are not supported.");
+		return;
+	}
+
+	VkQueryPoolCreateInfo create_info{};
+	create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	create_info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	create_info.queryCount = frame_count * GPU_PROFILER_FRAME_STATISTICS;
+	create_info.pipelineStatistics = GPU_PROFILER_STATISTICS_FLAGS;
+	if (vkCreateQueryPool(Core::get_device(), &create_info, nullptr, &_statistics_pool) != VK_SUCCESS) {
+		LOG_WARNING("Failed to create the pipeline statistics query pool.");
+		_statistics_pool = VK_NULL_HANDLE;
+		return;
+	}
+	_statistics.resize(GPU_PROFILER_FRAME_STATISTICS);
+}
+
+GpuProfiler::~GpuProfiler() {
+	vkDestroyQueryPool(Core::get_device(), _query_pool, nullptr);
+	vkDestroyQueryPool(Core::get_device(), _statistics_pool, nullptr);
+	gpu_profiler_ptr = nullptr;
+}
+
+void GpuProfiler::begin_frame(VkCommandBuffer command_buffer) noexcept {
+	if (_query_pool == VK_NULL_HANDLE) {
+		return;
+	}
+
+	const uint32_t frame = Core::get_current_frame();
+	FrameQueries& frame_queries = _frames[frame];
+	//the frame fence was waited, so the queries of this frame are done
+	read_results(frame_queries);
+
+	frame_queries.scopes.clear();
+	frame_queries.query_count = 0;
+	frame_queries.statistics_count = 0;
+	_open_scopes.clear();
+	_is_statistics_query_active = false;
+	vkCmdResetQueryPool(command_buffer, _query_pool, frame * GPU_PROFILER_FRAME_QUERIES, GPU_PROFILER_FRAME_QUERIES);
+	if (_statistics_pool != VK_NULL_HANDLE) {
+		vkCmdResetQueryPool(command_buffer, _statistics_pool, frame * GPU_PROFILER_FRAME_STATISTICS, GPU_PROFILER_FRAME_STATISTICS);
+	}
+}
+
+void GpuProfiler::read_results(FrameQueries& frame) noexcept {
+	if (frame.query_count == 0) {
+		return;
+	}
+
+	const uint32_t first_query = Core::get_current_frame() * GPU_PROFILER_FRAME_QUERIES;
+	VkResult result = vkGetQueryPoolResults(Core::get_device(), _query_pool, first_query, frame.query_count,
+		frame.query_count * sizeof(uint64_t), _timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS) {
+		return;
+	}
+	if (frame.statistics_count > 0) {
+		//the structure is tightly packed with the statistics in the flag order
+		result = vkGetQueryPoolResults(Core::get_device(), _statistics_pool,
+			Core::get_current_frame() * GPU_PROFILER_FRAME_STATISTICS, frame.statistics_count,
+			frame.statistics_count * sizeof(PipelineStatistics), _statistics.data(), sizeof(PipelineStatistics), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS) {
+			frame.statistics_count = 0;
+		}
+	}
+
+	_results.clear();
+	for (const Scope& scope : frame.scopes) {
+		if (scope.begin_query == UINT32_MAX) {
+			continue;
+		}
+		const float time = static_cast<float>(_timestamps[scope.begin_query + 1] - _timestamps[scope.begin_query]) *
+			Core::get_timestamp_period() / 1000000.f;
+		const bool has_statistics = scope.statistics_query < frame.statistics_count;
+		_results.push_back(GpuScopeResult{ scope.name, scope.depth, time, has_statistics,
+			has_statistics ? _statistics[scope.statistics_query] : PipelineStatistics{} });
+
+		History& history = _history[scope.name];
+		history.times[history.next] = time;
+		history.next = (history.next + 1) % GPU_PROFILER_HISTORY;
+		history.last_time = time;
+	}
+}
+
+void GpuProfiler::begin_scope(VkCommandBuffer command_buffer, const char* name, bool with_statistics) noexcept {
+	GpuProfiler& profiler = *gpu_profiler_ptr;
+	if (profiler._query_pool == VK_NULL_HANDLE) {
+		return;
+	}
+
+	const uint32_t frame = Core::get_current_frame();
+	FrameQueries& frame_queries = profiler._frames[frame];
+	Scope scope{ name, static_cast<uint32_t>(profiler._open_scopes.size()), UINT32_MAX, UINT32_MAX };
+	if (frame_queries.query_count + 2 <= GPU_PROFILER_FRAME_QUERIES) {
+		//the end query is always the next one
+		scope.begin_query = frame_queries.query_count;
+		frame_queries.query_count += 2;
+		vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, profiler._query_pool,
+			frame * GPU_PROFILER_FRAME_QUERIES + scope.begin_query);
+	}
+	if (with_statistics && profiler._statistics_pool != VK_NULL_HANDLE &&
+		frame_queries.statistics_count < GPU_PROFILER_FRAME_STATISTICS) {
+		assert(!profiler._is_statistics_query_active && "Nested pipeline statistics scopes.");
+		scope.statistics_query = frame_queries.statistics_count++;
+		vkCmdBeginQuery(command_buffer, profiler._statistics_pool, frame * GPU_PROFILER_FRAME_STATISTICS + scope.statistics_query, 0);
+		profiler._is_statistics_query_active = true;
+	}
+	profiler._open_scopes.push_back(static_cast<uint32_t>(frame_queries.scopes.size()));
+	frame_queries.scopes.push_back(scope);
+}
+
+void GpuProfiler::end_scope(VkCommandBuffer command_buffer) noexcept {
+	GpuProfiler& profiler = *gpu_profiler_ptr;
+	if (profiler._query_pool == VK_NULL_HANDLE) {
+		return;
+	}
+	assert(!profiler._open_scopes.empty() && "GpuProfiler::end_scope() without begin_scope().");
+
+	const uint32_t frame = Core::get_current_frame();
+	const Scope& scope = profiler._frames[frame].scopes[profiler._open_scopes.back()];
+	profiler._open_scopes.pop_back();
+	if (scope.statistics_query != UINT32_MAX) {
+		vkCmdEndQuery(command_buffer, profiler._statistics_pool, frame * GPU_PROFILER_FRAME_STATISTICS + scope.statistics_query);
+		profiler._is_statistics_query_active = false;
+	}
+	if (scope.begin_query != UINT32_MAX) {
+		vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, profiler._query_pool,
+			frame * GPU_PROFILER_FRAME_QUERIES + scope.begin_query + 1);
+	}
+}
+
+float GpuProfiler::get_last_time(const std::string& name) noexcept {
+	auto it = gpu_profiler_ptr->_history.find(name);
+	return it == gpu_profiler_ptr->_history.end() ? 0.f : it->second.last_time;
+}
+
+void GpuProfiler::show_gui() noexcept {
+	GpuProfiler& profiler = *gpu_profiler_ptr;
+	if (profiler._query_pool == VK_NULL_HANDLE) {
+		ImGui::Text("Timestamps are not supported.");
+		return;
+	}
+
+	if (!ImGui::BeginTable("GPU profiler", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+		return;
+	}
+	ImGui::TableSetupColumn("Pass");
+	ImGui::TableSetupColumn("ms");
+	ImGui::TableSetupColumn("History");
+	ImGui::TableHeadersRow();
+
+	for (const GpuScopeResult& result : profiler._results) {
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		//indent of 0 means the default width
+		const float indent = result.depth * 12.f;
+		if (result.depth > 0) {
+			ImGui::Indent(indent);
+		}
+		ImGui::TextUnformatted(result.name);
+		if (result.depth > 0) {
+			ImGui::Unindent(indent);
+		}
+
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3f", result.time);
+
+		ImGui::TableNextColumn();
+		const History& history = profiler._history[result.name];
+		ImGui::PushID(result.name);
+		ImGui::PlotLines("##history", history.times.data(), GPU_PROFILER_HISTORY, history.next, nullptr, 0.f, FLT_MAX, ImVec2(160.f, 24.f));
+		ImGui::PopID();
+	}
+	ImGui::EndTable();
+}
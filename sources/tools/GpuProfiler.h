@@ -0,0 +1,106 @@
+#pragma once
+#include "Core.h"
+#include <array>
+#include <string>
+#include <unordered_map>
+
+constexpr uint32_t GPU_PROFILER_HISTORY = 128;
+
+//results of VK_QUERY_TYPE_PIPELINE_STATISTICS in the order of the query flags
+struct PipelineStatistics {
+	uint64_t input_primitives = 0;
+	uint64_t vertex_invocations = 0;
+	uint64_t clipping_invocations = 0;
+	uint64_t clipping_primitives = 0;
+	uint64_t fragment_invocations = 0;
+	uint64_t compute_invocations = 0;
+};
+
+struct GpuScopeResult {
+	const char* name;
+	uint32_t depth;
+	float time;//ms
+	bool has_statistics;
+	PipelineStatistics statistics;
+};
+
+//nested timestamp scopes of the frame command buffer, every frame in flight has its own queries
+//read back when its fence is waited again, so the results are a few frames old and never stall
+class GpuProfiler {
+private:
+	struct Scope {
+		const char* name;
+		uint32_t depth;
+		//UINT32_MAX if the frame ran out of queries
+		uint32_t begin_query;
+		//UINT32_MAX if the scope does not collect pipeline statistics
+		uint32_t statistics_query;
+	};
+
+	struct FrameQueries {
+		std::vector<Scope> scopes;
+		uint32_t query_count = 0;
+		uint32_t statistics_count = 0;
+	};
+
+	struct History {
+		std::array<float, GPU_PROFILER_HISTORY> times{};
+		uint32_t next = 0;
+		float last_time = 0.f;
+	};
+
+	VkQueryPool _query_pool = VK_NULL_HANDLE;
+	//VK_NULL_HANDLE if pipelineStatisticsQuery is not supported
+	VkQueryPool _statistics_pool = VK_NULL_HANDLE;
+	std::vector<FrameQueries> _frames;
+	//scopes of the recorded frame which are not ended yet
+	std::vector<uint32_t> _open_scopes;
+
+	std::vector<GpuScopeResult> _results;
+	std::unordered_map<std::string, History> _history;
+	std::vector<uint64_t> _timestamps;
+	std::vector<PipelineStatistics> _statistics;
+	//statistics queries of one type can not be nested
+	bool _is_statistics_query_active = false;
+
+	static inline GpuProfiler* gpu_profiler_ptr = nullptr;
+
+private:
+	void create_statistics_pool(uint32_t frame_count) noexcept;
+	void read_results(FrameQueries& frame) noexcept;
+
+public:
+	GpuProfiler();
+
+	//read the queries of the current frame and reset them, call first in the frame command buffer
+	void begin_frame(VkCommandBuffer command_buffer) noexcept;
+
+	//with_statistics counts the invocations inside the scope, it must not contain another such scope
+	static void begin_scope(VkCommandBuffer command_buffer, const char* name, bool with_statistics = false) noexcept;
+	static void end_scope(VkCommandBuffer command_buffer) noexcept;
+
+	//the last measured time of the scope even if it was not recorded lately, 0 if it never was
+	static float get_last_time(const std::string& name) noexcept;
+	static inline const std::vector<GpuScopeResult>& get_results() noexcept { return gpu_profiler_ptr->_results; }
+	//hierarchical timing table with the rolling graph of every scope
+	static void show_gui() noexcept;
+
+	~GpuProfiler();
+};
+
+//times the commands recorded during its lifetime
+class GpuScope {
+private:
+	VkCommandBuffer _command_buffer;
+
+public:
+	GpuScope(VkCommandBuffer command_buffer, const char* name, bool with_statistics = false) noexcept : _command_buffer(command_buffer) {
+		GpuProfiler::begin_scope(command_buffer, name, with_statistics);
+	}
+	GpuScope(const GpuScope& scope) = delete;
+	GpuScope& operator=(const GpuScope& scope) = delete;
+
+	~GpuScope() {
+		GpuProfiler::end_scope(_command_buffer);
+	}
+};
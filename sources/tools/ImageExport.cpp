@@ -0,0 +1,106 @@
+#include "ImageExport.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+namespace {
+	std::array<uint32_t, 256> make_crc_table() noexcept {
+		std::array<uint32_t, 256> table{};
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; bit++) {
+				crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+			}
+			table[i] = crc;
+		}
+		return table;
+	}
+
+	uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+		static const std::array<uint32_t, 256> table = make_crc_table();
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++) {
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+
+	void push_u32(std::vector<uint8_t>& data, uint32_t value) {
+		data.push_back(value >> 24);
+		data.push_back(value >> 16);
+		data.push_back(value >> 8);
+		data.push_back(value);
+	}
+
+	void write_chunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+		std::vector<uint8_t> chunk;
+		chunk.reserve(data.size() + 12);
+		push_u32(chunk, static_cast<uint32_t>(data.size()));
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		//the crc covers the type and the data
+		push_u32(chunk, crc32(0, chunk.data() + 4, chunk.size() - 4));
+		file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+	}
+}
+
+bool image_export::write_png(const std::string& filename, uint32_t width, uint32_t height, const uint8_t* texels, bool is_bgra) noexcept {
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		LOG_WARNING("Failed to write the image: ", filename);
+		return false;
+	}
+
+	constexpr uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	std::vector<uint8_t> header;
+	push_u32(header, width);
+	push_u32(header, height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });//8 bit rgba, deflate, adaptive filtering, no interlace
+	write_chunk(file, "IHDR", header);
+
+	//every row starts with the filter type 0
+	const size_t row_size = static_cast<size_t>(width) * 4 + 1;
+	std::vector<uint8_t> rows(row_size * height);
+	for (uint32_t y = 0; y < height; y++) {
+		uint8_t* row = rows.data() + y * row_size;
+		const uint8_t* src = texels + static_cast<size_t>(y) * width * 4;
+		row[0] = 0;
+		for (uint32_t x = 0; x < width; x++) {
+			row[1 + x * 4 + 0] = src[x * 4 + (is_bgra ? 2 : 0)];
+			row[1 + x * 4 + 1] = src[x * 4 + 1];
+			row[1 + x * 4 + 2] = src[x * 4 + (is_bgra ? 0 : 2)];
+			row[1 + x * 4 + 3] = 255;
+		}
+	}
+
+	//zlib stream of stored deflate blocks
+	constexpr size_t MAX_STORED_BLOCK = 65535;
+	std::vector<uint8_t> stream;
+	stream.reserve(rows.size() + rows.size() / MAX_STORED_BLOCK * 5 + 16);
+	stream.insert(stream.end(), { 0x78, 0x01 });
+	for (size_t offset = 0;; offset += MAX_STORED_BLOCK) {
+		const size_t size = std::min(MAX_STORED_BLOCK, rows.size() - offset);
+		const bool is_last = offset + size == rows.size();
+		stream.push_back(is_last ? 1 : 0);
+		stream.push_back(size & 0xFF);
+		stream.push_back(size >> 8);
+		stream.push_back(~size & 0xFF);
+		stream.push_back((~size >> 8) & 0xFF);
+		stream.insert(stream.end(), rows.begin() + offset, rows.begin() + offset + size);
+		if (is_last) {
+			break;
+		}
+	}
+	uint32_t a = 1, b = 0;
+	for (uint8_t value : rows) {
+		a = (a + value) % 65521;
+		b = (b + a) % 65521;
+	}
+	push_u32(stream, (b << 16) | a);
+	write_chunk(file, "IDAT", stream);
+	write_chunk(file, "IEND", {});
+	return file.good();
+}
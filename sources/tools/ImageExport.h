@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Utils.h"
+#include <string>
+
+namespace image_export {
+	//8 bit rgba rows from the top, bgra texels are swizzled, the file is not compressed
+	bool write_png(const std::string& filename, uint32_t width, uint32_t height, const uint8_t* texels, bool is_bgra) noexcept;
+}
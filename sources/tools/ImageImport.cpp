@@ -0,0 +1,330 @@
+#include "ImageImport.h"
+#include "ThreadPool.h"
+#include "CpuProfiler.h"
+#include "stb_image.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define IMAGE_IMPORT_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_ATTRIBUTE(features)
+#else
+#include <cpuid.h>
+#define TARGET_ATTRIBUTE(features) __attribute__((target(features)))
+#endif
+#endif
+
+//
+//
+//DecodedImage
+//
+//
+
+DecodedImage::DecodedImage(DecodedImage&& image) noexcept :
+	width(image.width), height(image.height), channels(image.channels), is_hdr(image.is_hdr), pixels(image.pixels) {
+	image.pixels = nullptr;
+}
+
+DecodedImage& DecodedImage::operator=(DecodedImage&& image) noexcept {
+	if (this != &image) {
+		stbi_image_free(pixels);
+		width = image.width;
+		height = image.height;
+		channels = image.channels;
+		is_hdr = image.is_hdr;
+		pixels = image.pixels;
+		image.pixels = nullptr;
+	}
+	return *this;
+}
+
+DecodedImage::~DecodedImage() {
+	stbi_image_free(pixels);
+}
+
+//
+//
+//CPU features
+//
+//
+
+namespace {
+	struct CpuFeatures {
+		bool ssse3 = false;
+		bool f16c = false;
+
+		CpuFeatures() noexcept {
+#ifdef IMAGE_IMPORT_X86
+			uint32_t ecx = 0;
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 1);
+			ecx = static_cast<uint32_t>(info[2]);
+#else
+			uint32_t eax, ebx, edx;
+			if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+				return;
+			}
+#endif
+			ssse3 = ecx & (1u << 9);
+			//f16c is vex encoded, the os has to save ymm registers
+			const bool osxsave = ecx & (1u << 27);
+			const bool avx = ecx & (1u << 28);
+			if (osxsave && avx) {
+#ifdef _MSC_VER
+				uint64_t xcr0 = _xgetbv(0);
+#else
+				uint32_t xcr0_low, xcr0_high;
+				__asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+				uint64_t xcr0 = (static_cast<uint64_t>(xcr0_high) << 32) | xcr0_low;
+#endif
+				f16c = (ecx & (1u << 29)) && (xcr0 & 0x6) == 0x6;
+			}
+#endif
+		}
+	};
+
+	const CpuFeatures& cpu_features() noexcept {
+		static const CpuFeatures features;
+		return features;
+	}
+
+	uint16_t float_to_half(float value) noexcept {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(float));
+
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFF;
+
+		//nan and infinity
+		if (((bits >> 23) & 0xFF) == 0xFF) {
+			return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+		}
+		//overflow
+		if (exponent >= 0x1F) {
+			return static_cast<uint16_t>(sign | 0x7C00);
+		}
+		//subnormal half or zero
+		if (exponent <= 0) {
+			if (exponent < -10) {
+				return static_cast<uint16_t>(sign);
+			}
+			mantissa |= 0x800000;
+			const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+			uint32_t half_mantissa = mantissa >> shift;
+			//round to nearest even
+			const uint32_t remainder = mantissa & ((1u << shift) - 1);
+			const uint32_t halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (half_mantissa & 1))) {
+				half_mantissa++;
+			}
+			return static_cast<uint16_t>(sign | half_mantissa);
+		}
+
+		uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+		const uint32_t remainder = mantissa & 0x1FFF;
+		//a carry into the exponent is the correct rounding
+		if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+			half++;
+		}
+		return static_cast<uint16_t>(half);
+	}
+
+	//channel c of texel i, missing channels follow stb's grey and grey alpha layouts
+	template<typename T>
+	inline T fetch_channel(const T* src, uint32_t channels, size_t i, uint32_t c, T one) noexcept {
+		const T* texel = src + i * channels;
+		switch (channels) {
+		case 1: return c < 3 ? texel[0] : one;
+		case 2: return c < 3 ? texel[0] : texel[1];
+		case 3: return c < 3 ? texel[c] : one;
+		default: return texel[c];
+		}
+	}
+
+	void expand_rgba8_scalar(const uint8_t* src, uint32_t channels, uint8_t* dst, size_t first, size_t count) noexcept {
+		for (size_t i = first; i < count; i++) {
+			for (uint32_t c = 0; c < 4; c++) {
+				dst[i * 4 + c] = fetch_channel<uint8_t>(src, channels, i, c, 255);
+			}
+		}
+	}
+
+	void expand_rgba32f_scalar(const float* src, uint32_t channels, float* dst, size_t first, size_t count) noexcept {
+		for (size_t i = first; i < count; i++) {
+			for (uint32_t c = 0; c < 4; c++) {
+				dst[i * 4 + c] = fetch_channel<float>(src, channels, i, c, 1.f);
+			}
+		}
+	}
+
+	void convert_rgba16f_scalar(const float* src, uint32_t channels, uint16_t* dst, size_t first, size_t count) noexcept {
+		for (size_t i = first; i < count; i++) {
+			for (uint32_t c = 0; c < 4; c++) {
+				dst[i * 4 + c] = float_to_half(fetch_channel<float>(src, channels, i, c, 1.f));
+			}
+		}
+	}
+
+#ifdef IMAGE_IMPORT_X86
+	//4 texels per shuffle, a 16 byte load reads 4 bytes past them
+	TARGET_ATTRIBUTE("ssse3")
+	size_t expand_rgb8_ssse3(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+		const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+		size_t i = 0;
+		for (; i + 6 <= count; i += 4) {
+			__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+			__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), rgba);
+		}
+		return i;
+	}
+
+	//a texel per load, the load of the last texel would read past the image
+	size_t expand_rgb32f_sse(const float* src, float* dst, size_t count) noexcept {
+		const __m128 rgb_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+		const __m128 alpha = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+		size_t i = 0;
+		for (; i + 1 < count; i++) {
+			__m128 texel = _mm_or_ps(_mm_and_ps(_mm_loadu_ps(src + i * 3), rgb_mask), alpha);
+			_mm_storeu_ps(dst + i * 4, texel);
+		}
+		return i;
+	}
+
+	TARGET_ATTRIBUTE("avx,f16c")
+	size_t convert_rgba16f_f16c(const float* src, uint32_t channels, uint16_t* dst, size_t count) noexcept {
+		size_t i = 0;
+		if (channels == 4) {
+			//two texels per conversion
+			for (; i + 2 <= count; i += 2) {
+				__m256 texels = _mm256_loadu_ps(src + i * 4);
+				__m128i half = _mm256_cvtps_ph(texels, _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), half);
+			}
+		}
+		else if (channels == 3) {
+			const __m128 rgb_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+			const __m128 alpha = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+			for (; i + 1 < count; i++) {
+				__m128 texel = _mm_or_ps(_mm_and_ps(_mm_loadu_ps(src + i * 3), rgb_mask), alpha);
+				__m128i half = _mm_cvtps_ph(texel, _MM_FROUND_TO_NEAREST_INT);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 4), half);
+			}
+		}
+		return i;
+	}
+#endif
+}
+
+//
+//
+//image_import
+//
+//
+
+DecodedImage image_import::decode(const std::string& filename, bool is_hdr) noexcept {
+	DecodedImage image;
+	if (!try_decode(filename, is_hdr, image)) {
+		LOG_ERROR("Failed to load the image: ", filename);
+	}
+	return image;
+}
+
+bool image_import::try_decode(const std::string& filename, bool is_hdr, DecodedImage& image) noexcept {
+	PROFILE_SCOPE("image_import::decode");
+	int width, height, channels;
+	//keep the file channels, expansion to rgba happens during conversion
+	if (is_hdr) {
+		image.pixels = stbi_loadf(filename.c_str(), &width, &height, &channels, 0);
+	}
+	else {
+		image.pixels = stbi_load(filename.c_str(), &width, &height, &channels, 0);
+	}
+	if (!image.pixels) {
+		return false;
+	}
+	image.width = width;
+	image.height = height;
+	image.channels = channels;
+	image.is_hdr = is_hdr;
+	return true;
+}
+
+std::future<DecodedImage> image_import::decode_async(const std::string& filename, bool is_hdr) {
+	return ThreadPool::submit([filename, is_hdr] { return decode(filename, is_hdr); });
+}
+
+bool image_import::is_float_format(VkFormat format) noexcept {
+	return format == VK_FORMAT_R32G32B32A32_SFLOAT || format == VK_FORMAT_R16G16B16A16_SFLOAT;
+}
+
+uint32_t image_import::get_texel_size(VkFormat format) noexcept {
+	switch (format)
+	{
+	case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+	case VK_FORMAT_R16G16B16A16_SFLOAT: return 8;
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_SRGB: return 4;
+	default: return 0;
+	}
+}
+
+void image_import::convert(const DecodedImage& image, VkFormat format, void* dst) noexcept {
+	if (!try_convert(image, format, dst)) {
+		LOG_ERROR("Failed to convert the image, unsupported format: ", format);
+	}
+}
+
+bool image_import::try_convert(const DecodedImage& image, VkFormat format, void* dst) noexcept {
+	if (image.is_hdr != is_float_format(format) || get_texel_size(format) == 0) {
+		return false;
+	}
+
+	const size_t count = image.get_texel_count();
+	size_t converted = 0;
+
+	if (format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB) {
+		const uint8_t* src = static_cast<const uint8_t*>(image.pixels);
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		if (image.channels == 4) {
+			memcpy(out, src, count * 4);
+			return true;
+		}
+#ifdef IMAGE_IMPORT_X86
+		if (image.channels == 3 && cpu_features().ssse3) {
+			converted = expand_rgb8_ssse3(src, out, count);
+		}
+#endif
+		expand_rgba8_scalar(src, image.channels, out, converted, count);
+	}
+	else if (format == VK_FORMAT_R16G16B16A16_SFLOAT) {
+		const float* src = static_cast<const float*>(image.pixels);
+		uint16_t* out = static_cast<uint16_t*>(dst);
+#ifdef IMAGE_IMPORT_X86
+		if (cpu_features().f16c) {
+			converted = convert_rgba16f_f16c(src, image.channels, out, count);
+		}
+#endif
+		convert_rgba16f_scalar(src, image.channels, out, converted, count);
+	}
+	else {
+		const float* src = static_cast<const float*>(image.pixels);
+		float* out = static_cast<float*>(dst);
+		if (image.channels == 4) {
+			memcpy(out, src, count * 16);
+			return true;
+		}
+#ifdef IMAGE_IMPORT_X86
+		if (image.channels == 3) {
+			converted = expand_rgb32f_sse(src, out, count);
+		}
+#endif
+		expand_rgba32f_scalar(src, image.channels, out, converted, count);
+	}
+	return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Utils.h"
+#include <future>
+#include <string>
+
+//image decoded with its own channel count, stb memory is freed by the destructor
+struct DecodedImage {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t channels = 0;
+	//float channels if true, else 8 bit
+	bool is_hdr = false;
+	void* pixels = nullptr;
+
+	DecodedImage() noexcept {}
+	DecodedImage(DecodedImage&& image) noexcept;
+	DecodedImage& operator=(DecodedImage&& image) noexcept;
+	DecodedImage(const DecodedImage& image) = delete;
+	DecodedImage& operator=(const DecodedImage& image) = delete;
+
+	inline size_t get_texel_count() const noexcept { return static_cast<size_t>(width) * height; }
+
+	~DecodedImage();
+};
+
+namespace image_import {
+	DecodedImage decode(const std::string& filename, bool is_hdr) noexcept;
+	//false if the file can not be decoded, for the threads that must not exit on a bad file
+	bool try_decode(const std::string& filename, bool is_hdr, DecodedImage& image) noexcept;
+	//decode on the thread pool
+	std::future<DecodedImage> decode_async(const std::string& filename, bool is_hdr);
+
+	bool is_float_format(VkFormat format) noexcept;
+	//0 if the format can not be imported
+	uint32_t get_texel_size(VkFormat format) noexcept;
+
+	//expand to four channels and convert to the format,
+	//dst may be a mapped staging region of width * height * get_texel_size(format) bytes
+	void convert(const DecodedImage& image, VkFormat format, void* dst) noexcept;
+	//false if the format is not supported
+	bool try_convert(const DecodedImage& image, VkFormat format, void* dst) noexcept;
+}
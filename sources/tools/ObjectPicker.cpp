@@ -0,0 +1,67 @@
+#include "ObjectPicker.h"
+#include "CommandManager.h"
+#include <algorithm>
+
+ObjectPicker::ObjectPicker(const std::shared_ptr<VulkanImage>& object_id_image) :
+	_object_id_image(object_id_image) {
+	_readbacks.resize(Core::get_swapchain_image_count());
+	for (auto& readback : _readbacks) {
+		readback.buffer = new VulkanBuffer(VK_BUFFER_USAGE_TRANSFER_DST_BIT, sizeof(uint32_t),
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		readback.data = reinterpret_cast<const uint32_t*>(readback.buffer->map_memory(0, VK_WHOLE_SIZE));
+	}
+	LOG_STATUS("Created ObjectPicker.");
+}
+
+ObjectPicker::~ObjectPicker() {
+	for (auto& readback : _readbacks) {
+		delete readback.buffer;
+	}
+}
+
+void ObjectPicker::request(uint32_t x, uint32_t y) noexcept {
+	_x = std::min(x, Core::get_swapchain_width() - 1);
+	_y = std::min(y, Core::get_swapchain_height() - 1);
+	_is_requested = true;
+}
+
+void ObjectPicker::begin_frame() noexcept {
+	//the fence of this frame was waited, the copy recorded in it is done
+	Readback& readback = _readbacks[Core::get_current_frame()];
+	if (readback.is_pending) {
+		readback.is_pending = false;
+		_result = *readback.data;
+		_has_result = true;
+	}
+}
+
+void ObjectPicker::record(VkCommandBuffer command_buffer) noexcept {
+	if (!_is_requested) {
+		return;
+	}
+	_is_requested = false;
+	Readback& readback = _readbacks[Core::get_current_frame()];
+
+	//the solid render pass left the image in the transfer source layout
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+	VkBufferImageCopy region{};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageOffset = { static_cast<int32_t>(_x), static_cast<int32_t>(_y), 0 };
+	region.imageExtent = { 1, 1, 1 };
+	CommandManager::copy_image_to_buffer(command_buffer,
+		_object_id_image->get_image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		*readback.buffer, { region });
+
+	CommandManager::set_memory_dependency(command_buffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT);
+	readback.is_pending = true;
+}
+
+bool ObjectPicker::get_result(uint32_t& object_id) noexcept {
+	object_id = _result;
+	return std::exchange(_has_result, false);
+}
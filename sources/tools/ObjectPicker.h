@@ -0,0 +1,40 @@
+#pragma once
+#include "VulkanDataObjects.h"
+
+//id of the pixels without an object
+constexpr uint32_t OBJECT_ID_NONE = 0;
+
+//reads single pixels of the object id attachment back to host memory,
+//a request is resolved when its frame slot is reused, without stalling
+class ObjectPicker {
+private:
+	struct Readback {
+		VulkanBuffer* buffer;
+		const uint32_t* data;
+		bool is_pending = false;
+	};
+
+	std::shared_ptr<VulkanImage> _object_id_image;
+	std::vector<Readback> _readbacks;
+
+	bool _is_requested = false;
+	uint32_t _x = 0;
+	uint32_t _y = 0;
+
+	bool _has_result = false;
+	uint32_t _result = OBJECT_ID_NONE;
+
+public:
+	ObjectPicker(const std::shared_ptr<VulkanImage>& object_id_image);
+
+	//the pixel is copied in the next recorded frame, a newer request replaces it
+	void request(uint32_t x, uint32_t y) noexcept;
+	//call after the frame fence is waited
+	void begin_frame() noexcept;
+	//call after the solid pass, the object id image is in the transfer source layout
+	void record(VkCommandBuffer command_buffer) noexcept;
+	//returns true once per resolved request
+	bool get_result(uint32_t& object_id) noexcept;
+
+	~ObjectPicker();
+};
@@ -0,0 +1,96 @@
+#include "PipelineCache.h"
+#include "BakeCache.h"
+#include "Timer.h"
+#include <cassert>
+#include <cstring>
+
+PipelineCache::PipelineCache() {
+	assert(pipeline_cache_ptr == nullptr && "There can be only one PipelineCache.");
+	pipeline_cache_ptr = this;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(Core::get_physical_device(), &properties);
+
+	MappedBlob blob = BakeCache::load("pipelines", get_key(properties));
+	_is_warm = blob && is_compatible(blob.data(), blob.size(), properties);
+
+	VkPipelineCacheCreateInfo create_info{};
+	create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	create_info.initialDataSize = _is_warm ? blob.size() : 0;
+	create_info.pInitialData = _is_warm ? blob.data() : nullptr;
+	if (vkCreatePipelineCache(Core::get_device(), &create_info, nullptr, &_pipeline_cache) != VK_SUCCESS) {
+		LOG_ERROR("vkCreatePipelineCache() - FAILED");
+	}
+	LOG_STATUS(_is_warm ? "Loaded the pipeline cache, size: " : "Created an empty pipeline cache, size: ", create_info.initialDataSize);
+}
+
+PipelineCache::~PipelineCache() {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(Core::get_physical_device(), &properties);
+
+	size_t size = 0;
+	if (vkGetPipelineCacheData(Core::get_device(), _pipeline_cache, &size, nullptr) == VK_SUCCESS && size > 0) {
+		std::vector<char> data(size);
+		if (vkGetPipelineCacheData(Core::get_device(), _pipeline_cache, &size, data.data()) == VK_SUCCESS) {
+			BakeCache::store("pipelines", get_key(properties), data.data(), size);
+		}
+	}
+
+	vkDestroyPipelineCache(Core::get_device(), _pipeline_cache, nullptr);
+	pipeline_cache_ptr = nullptr;
+}
+
+BakeKey PipelineCache::get_key(const VkPhysicalDeviceProperties& properties) {
+	BakeKey key;
+	key.add(properties.vendorID)
+		.add(properties.deviceID)
+		.add(properties.driverVersion)
+		.add(properties.pipelineCacheUUID);
+	return key;
+}
+
+bool PipelineCache::is_compatible(const void* data, size_t size, const VkPhysicalDeviceProperties& properties) noexcept {
+	VkPipelineCacheHeaderVersionOne header;
+	if (size < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	return header.headerSize >= sizeof(header) &&
+		header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header.vendorID == properties.vendorID &&
+		header.deviceID == properties.deviceID &&
+		memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::add_creation_time(uint64_t time) noexcept {
+	_pipeline_count.fetch_add(1, std::memory_order_relaxed);
+	_creation_time.fetch_add(time, std::memory_order_relaxed);
+}
+
+VkPipeline PipelineCache::create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info, const std::string& name) {
+	Timer<> timer;
+	VkPipeline pipeline;
+	if (vkCreateGraphicsPipelines(Core::get_device(), pipeline_cache_ptr->_pipeline_cache, 1, &create_info, nullptr, &pipeline) != VK_SUCCESS) {
+		LOG_ERROR("vkCreateGraphicsPipelines() ", name, " - FAILED");
+	}
+	pipeline_cache_ptr->add_creation_time(static_cast<uint64_t>(timer.get_elapsed_time_from_start<std::chrono::microseconds>()));
+	return pipeline;
+}
+
+VkPipeline PipelineCache::create_compute_pipeline(const VkComputePipelineCreateInfo& create_info, const std::string& name) {
+	Timer<> timer;
+	VkPipeline pipeline;
+	if (vkCreateComputePipelines(Core::get_device(), pipeline_cache_ptr->_pipeline_cache, 1, &create_info, nullptr, &pipeline) != VK_SUCCESS) {
+		LOG_ERROR("vkCreateComputePipelines() ", name, " - FAILED");
+	}
+	pipeline_cache_ptr->add_creation_time(static_cast<uint64_t>(timer.get_elapsed_time_from_start<std::chrono::microseconds>()));
+	return pipeline;
+}
+
+PipelineCacheStatistics PipelineCache::get_statistics() noexcept {
+	PipelineCacheStatistics statistics{};
+	statistics.pipeline_count = pipeline_cache_ptr->_pipeline_count.load(std::memory_order_relaxed);
+	statistics.creation_time = pipeline_cache_ptr->_creation_time.load(std::memory_order_relaxed) / 1000.f;
+	statistics.is_warm = pipeline_cache_ptr->_is_warm;
+	return statistics;
+}
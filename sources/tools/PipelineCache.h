@@ -0,0 +1,41 @@
+#pragma once
+#include "Core.h"
+#include <atomic>
+#include <string>
+
+struct PipelineCacheStatistics {
+	uint32_t pipeline_count;
+	//summed over the threads creating pipelines
+	float creation_time;//ms
+	bool is_warm;
+};
+
+//VkPipelineCache shared by every pipeline, kept in the bake cache between runs,
+//the data is dropped if another device or driver wrote it
+class PipelineCache {
+private:
+	VkPipelineCache _pipeline_cache;
+	bool _is_warm = false;
+
+	std::atomic<uint32_t> _pipeline_count = 0;
+	std::atomic<uint64_t> _creation_time = 0;//us
+
+	static inline PipelineCache* pipeline_cache_ptr = nullptr;
+
+private:
+	static class BakeKey get_key(const VkPhysicalDeviceProperties& properties);
+	static bool is_compatible(const void* data, size_t size, const VkPhysicalDeviceProperties& properties) noexcept;
+
+	void add_creation_time(uint64_t time) noexcept;
+
+public:
+	PipelineCache();
+
+	//safe to call from several threads, exits if the pipeline can not be created
+	static VkPipeline create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info, const std::string& name);
+	static VkPipeline create_compute_pipeline(const VkComputePipelineCreateInfo& create_info, const std::string& name);
+
+	static PipelineCacheStatistics get_statistics() noexcept;
+
+	~PipelineCache();
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+//fixed set of worker threads for loading tasks,
+//tasks must not wait for other tasks of the pool
+class ThreadPool {
+private:
+	std::vector<std::thread> _workers;
+	std::deque<std::function<void()>> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _is_running = true;
+
+	static inline ThreadPool* thread_pool_ptr = nullptr;
+
+private:
+	void worker_loop() noexcept {
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_condition.wait(lock, [this] { return !_tasks.empty() || !_is_running; });
+				if (!_is_running && _tasks.empty()) {
+					return;
+				}
+				task = std::move(_tasks.front());
+				_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+public:
+	explicit ThreadPool(uint32_t thread_count = std::max(2u, std::thread::hardware_concurrency()) - 1) {
+		assert(thread_pool_ptr == nullptr && "There can be only one ThreadPool.");
+		thread_pool_ptr = this;
+
+		_workers.reserve(thread_count);
+		for (uint32_t i = 0; i < thread_count; i++) {
+			_workers.emplace_back(&ThreadPool::worker_loop, this);
+		}
+	}
+
+	template<typename F>
+	static auto submit(F&& function) -> std::future<std::invoke_result_t<F>> {
+		using result_type = std::invoke_result_t<F>;
+
+		//std::function needs a copyable callable
+		auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(function));
+		std::future<result_type> future = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(thread_pool_ptr->_mutex);
+			thread_pool_ptr->_tasks.emplace_back([task] { (*task)(); });
+		}
+		thread_pool_ptr->_condition.notify_one();
+		return future;
+	}
+
+	static inline uint32_t get_thread_count() noexcept { return thread_pool_ptr->_workers.size(); }
+
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_is_running = false;
+		}
+		_condition.notify_all();
+		for (auto& worker : _workers) {
+			worker.join();
+		}
+		thread_pool_ptr = nullptr;
+	}
+};
@@ -3,6 +3,7 @@
 #include <vulkan/vulkan.h>
 #include <iostream>
 #include <vector>
+#include <mutex>
 
 #ifdef DEBUG
 	#include <cassert>
@@ -15,6 +16,9 @@
 namespace utils {
 
 	class Log {
+		//lines of the loading threads must not interleave
+		static inline std::mutex _mutex;
+
 		template<typename T, typename... Args>
 		static void message(T msg, Args... msgs) {
 			std::cout << msg;
@@ -27,18 +31,23 @@ namespace utils {
 	public:
 		template<typename T, typename... Args>
 		static void status(T msg, Args... msgs) {
+			std::lock_guard<std::mutex> lock(_mutex);
 			std::cout << "---\t";
 			message(msg, msgs...);
 		}
 		template<typename T, typename... Args>
 		static void warning(T msg, Args... msgs) {
+			std::lock_guard<std::mutex> lock(_mutex);
 			std::cout << "!!!\t";
 			message(msg, msgs...);
 		}
 		template<typename T, typename... Args>
 		static void error(T msg, Args... msgs) {
-			std::cout << "ERROR\t";
-			message(msg, msgs...);
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				std::cout << "ERROR\t";
+				message(msg, msgs...);
+			}
 			exit(1);
 		}
 	};
@@ -1,5 +1,9 @@
 #include "VulkanDataObjects.h"
 #include "CommandManager.h"
+#include "ImageImport.h"
+#include "BakeCache.h"
+#include "FrameStatistics.h"
+#include "CpuProfiler.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -95,7 +99,7 @@ VkImageView VulkanImageViewBase::create_image_view(
 	create_info.viewType = view_create_info.type;
 	create_info.subresourceRange.aspectMask = view_create_info.aspect;
 	create_info.subresourceRange.baseArrayLayer = 0;
-	create_info.subresourceRange.baseMipLevel = 0;
+	create_info.subresourceRange.baseMipLevel = view_create_info.base_mip_level;
 	create_info.subresourceRange.layerCount = view_create_info.layer_count;
 	create_info.subresourceRange.levelCount = view_create_info.mip_level_count;
 	
@@ -248,12 +252,40 @@ void StagingBuffer::copy_buffer_to_image(VkCommandBuffer command_buffer,
 	CommandManager::copy_buffer_to_image(command_buffer, *_buffer_ptr, dst_image, dst_image_layout, subresource);
 }
 
+void* StagingBuffer::map_region(size_t size) noexcept {
+	_last_copied_size = size;
+	FrameStatistics::add_upload_bytes(size);
+
+	if (_last_copied_size > _buffer_ptr->_size) {
+		recreate_buffer();
+	}
+
+	return _buffer_ptr->map_memory(0, _last_copied_size);
+}
+
+void StagingBuffer::copy_region_to_image(VkCommandBuffer command_buffer, const class VulkanImage& dst_image,
+	VkImageLayout dst_image_layout, const VkImageSubresourceLayers& subresource) noexcept {
+	if (_buffer_ptr->_data_ptr != nullptr) {
+		_buffer_ptr->unmap_memory();
+	}
+	CommandManager::copy_buffer_to_image(command_buffer, *_buffer_ptr, dst_image, dst_image_layout, subresource);
+}
+
+void StagingBuffer::copy_region_to_buffer(VkCommandBuffer command_buffer, const class VulkanBuffer& dst,
+	VkDeviceSize src_offset, VkDeviceSize dst_offset, VkDeviceSize size) noexcept {
+	if (_buffer_ptr->_data_ptr != nullptr) {
+		_buffer_ptr->unmap_memory();
+	}
+	CommandManager::copy_buffers(command_buffer, *_buffer_ptr, dst, src_offset, dst_offset, size);
+}
+
 void StagingBuffer::recreate_buffer() noexcept {
 	_buffer_ptr->recreate(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, _last_copied_size, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 }
 
 void StagingBuffer::copy_data_to_buffer(const void* data, size_t size) noexcept {
 	_last_copied_size = size;
+	FrameStatistics::add_upload_bytes(size);
 
 	if (_last_copied_size > _buffer_ptr->_size) {
 		recreate_buffer();
@@ -282,6 +314,7 @@ VkImage VulkanImage::create_image(const VulkanImageCreateInfo& image_create_info
 	VkImage image;
 	VkImageCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	create_info.flags = image_create_info.flags;
 	create_info.extent.depth = 1.f;
 	create_info.extent.width = image_create_info.width;
 	create_info.extent.height = image_create_info.height;
@@ -334,7 +367,8 @@ VulkanTextureBase::VulkanTextureBase(VkFormat format,
 	VulkanImage(VulkanImageCreateInfo(
 	width, height, format,
 	array_layers, 1, VK_SAMPLE_COUNT_1_BIT,
-	usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+	usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+	type == VK_IMAGE_VIEW_TYPE_CUBE ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0u)),
 	VulkanImageView(_image, format, VulkanImageViewCreateInfo(
 		type, aspect,array_layers,1
 	)) {
@@ -361,7 +395,41 @@ VulkanTexture2D::VulkanTexture2D(VkFormat format, uint32_t width, uint32_t heigh
 	VulkanTextureBase(format,width,height,usage,1, VK_IMAGE_VIEW_TYPE_2D, aspect){}
 
 VulkanTexture2D::VulkanTexture2D(VkFormat format, const char* filename) noexcept : VulkanTextureBase(format){
-	load_texture(filename);
+	PROFILE_SCOPE("VulkanTexture2D::load");
+	//cooked texture: width, height and the texels converted to the format
+	uint32_t extent[2];
+	const size_t texel_size = image_import::get_texel_size(_format);
+	BakeKey key;
+	key.add_file(filename).add(_format);
+
+	MappedBlob blob = BakeCache::load("texture", key);
+	if (blob && blob.size() >= sizeof(extent)) {
+		memcpy(extent, blob.data(), sizeof(extent));
+		if (blob.size() == sizeof(extent) + static_cast<size_t>(extent[0]) * extent[1] * texel_size) {
+			load_texture(extent[0], extent[1], [&blob](void* dst) {
+				memcpy(dst, blob.data() + sizeof(extent), blob.size() - sizeof(extent));
+				});
+			LOG_STATUS("Loaded cooked ", filename);
+			return;
+		}
+	}
+
+	DecodedImage image = image_import::decode(filename, image_import::is_float_format(_format));
+	extent[0] = image.width;
+	extent[1] = image.height;
+	std::vector<char> cooked(sizeof(extent) + image.get_texel_count() * texel_size);
+	memcpy(cooked.data(), extent, sizeof(extent));
+	image_import::convert(image, _format, cooked.data() + sizeof(extent));
+	BakeCache::store("texture", key, cooked.data(), cooked.size());
+
+	load_texture(extent[0], extent[1], [&cooked](void* dst) {
+		memcpy(dst, cooked.data() + sizeof(extent), cooked.size() - sizeof(extent));
+		});
+	LOG_STATUS("Loaded ", filename);
+}
+
+VulkanTexture2D::VulkanTexture2D(VkFormat format, const DecodedImage& image) noexcept : VulkanTextureBase(format) {
+	load_texture(image);
 }
 
 VulkanTexture2D::VulkanTexture2D(VulkanTexture2D&& texture) noexcept : VulkanTextureBase(texture){}
@@ -375,42 +443,26 @@ VkDescriptorImageInfo VulkanTexture2D::get_info(VkImageLayout layout) const noex
 	return info;
 }
 
-void VulkanTexture2D::load_texture(const char* filename) {
-	int width, height, comp;
-	void* pixels;
-	if (_format == VK_FORMAT_R32G32B32A32_SFLOAT || _format == VK_FORMAT_R16G16B16A16_SFLOAT) {
-		pixels = stbi_loadf(filename, &width, &height, &comp, STBI_rgb_alpha);
-	}
-	else if (_format == VK_FORMAT_R8G8B8A8_UNORM || _format == VK_FORMAT_R8G8B8A8_SRGB) {
-		pixels = stbi_load(filename, &width, &height, &comp, STBI_rgb_alpha);
-	}
-	else {
-		LOG_ERROR("Failed to create the image, undefined format: ", filename);
-	}
+void VulkanTexture2D::load_texture(const DecodedImage& image) {
+	//convert straight into the staging memory
+	load_texture(image.width, image.height, [this, &image](void* dst) {
+		image_import::convert(image, _format, dst);
+		});
+}
 
-	if (!pixels) {
-		LOG_ERROR("Failed to load the image: ", filename);
+void VulkanTexture2D::load_texture(uint32_t width, uint32_t height, const std::function<void(void*)>& write_texels) {
+	const uint32_t texel_size = image_import::get_texel_size(_format);
+	if (texel_size == 0) {
+		LOG_ERROR("Failed to create the image, undefined format: ", _format);
 	}
 
-	LOG_STATUS("Loaded ", filename);
-
 	_width = width;
 	_height = height;
-	VkDeviceSize image_size = _width * _height;
-
-	switch (_format)
-	{
-	case VK_FORMAT_R32G32B32A32_SFLOAT: image_size *= 16; break;
-	case VK_FORMAT_R16G16B16A16_SFLOAT: image_size *= 8; break;
-	case VK_FORMAT_R8G8B8A8_UNORM:
-	case VK_FORMAT_R8G8B8A8_SRGB: image_size *= 4; break;
-	default:
-		LOG_ERROR("Failed to create the image, undefined format: ", filename);
-	}
+	VkDeviceSize image_size = static_cast<VkDeviceSize>(_width) * _height * texel_size;
 
 	VulkanImageCreateInfo image_create_info{};
-	image_create_info.width = width;
-	image_create_info.height = height;
+	image_create_info.width = _width;
+	image_create_info.height = _height;
 	image_create_info.mip_levels = 1;
 	image_create_info.memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	image_create_info.array_layers = 1;
@@ -446,7 +498,8 @@ void VulkanTexture2D::load_texture(const char* filename) {
 		VK_ACCESS_NONE, VK_ACCESS_TRANSFER_WRITE_BIT,
 		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresource_range);
 
-	StagingBuffer::copy_buffer_to_image(cmd, pixels, image_size, *this, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresource_layers);
+	write_texels(StagingBuffer::map_region(image_size));
+	StagingBuffer::copy_region_to_image(cmd, *this, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresource_layers);
 
 	CommandManager::transition_image_layout(cmd, *this,
 		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
@@ -455,12 +508,10 @@ void VulkanTexture2D::load_texture(const char* filename) {
 
 	CommandManager::end_single_command_buffer(cmd);
 
-	stbi_image_free(pixels);
-
 	create_sampler();
 }
 
-void VulkanTextureBase::create_sampler() {
+void VulkanTextureBase::create_sampler(float max_lod) {
 	VkSamplerCreateInfo create_info{};
 	create_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 	create_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
@@ -471,7 +522,7 @@ void VulkanTextureBase::create_sampler() {
 	create_info.magFilter = VK_FILTER_LINEAR;
 	create_info.minFilter = VK_FILTER_LINEAR;
 	create_info.minLod = 0.f;
-	create_info.maxLod = 0.f;
+	create_info.maxLod = max_lod;
 	create_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	create_info.unnormalizedCoordinates = VK_FALSE;
 	create_info.compareEnable = VK_FALSE;
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "Core.h"
+#include <functional>
 
 class VulkanDataObject {
 protected:
 	static int32_t find_memory_type(uint32_t memory_type_bits, VkMemoryPropertyFlags memory_property) noexcept;
+
+	friend class Core;
 public:
 	VulkanDataObject() noexcept {}
 	VulkanDataObject(VulkanDataObject&& obj) noexcept {}
@@ -130,6 +133,15 @@ public:
 
 	static void copy_buffer_to_image(VkCommandBuffer command_buffer, const void* data, size_t size, const class VulkanImage& dst_image,
 		VkImageLayout dst_image_layout, const VkImageSubresourceLayers& subresource) noexcept;
+
+	//map the staging memory to write the data in place instead of copying it from another buffer,
+	//the region is unmapped when it is copied
+	static void* map_region(size_t size) noexcept;
+	static void copy_region_to_image(VkCommandBuffer command_buffer, const class VulkanImage& dst_image,
+		VkImageLayout dst_image_layout, const VkImageSubresourceLayers& subresource) noexcept;
+	//part of the mapped region, can be called for several parts before the submission
+	static void copy_region_to_buffer(VkCommandBuffer command_buffer, const class VulkanBuffer& dst,
+		VkDeviceSize src_offset, VkDeviceSize dst_offset, VkDeviceSize size) noexcept;
 };
 
 struct VulkanImageCreateInfo {
@@ -141,6 +153,7 @@ struct VulkanImageCreateInfo {
 	VkSampleCountFlagBits samples;
 	VkImageUsageFlags usage;
 	VkMemoryPropertyFlags memory_property;
+	VkImageCreateFlags flags = 0;
 };
 
 
@@ -173,6 +186,7 @@ struct VulkanImageViewCreateInfo {
 	VkImageAspectFlags aspect;
 	uint32_t layer_count;
 	uint32_t mip_level_count;
+	uint32_t base_mip_level = 0;
 };
 
 class VulkanImageViewBase : public VulkanDataObject {
@@ -235,7 +249,7 @@ protected:
 	VulkanTextureBase(VulkanTextureBase&& texture) noexcept;
 	VulkanTextureBase(const VulkanTextureBase& texture) noexcept;
 
-	void create_sampler();
+	void create_sampler(float max_lod = 0.f);
 public:
 	virtual VkDescriptorImageInfo get_info(VkImageLayout layout) const noexcept = 0;
 
@@ -244,12 +258,15 @@ public:
 
 class VulkanTexture2D : public VulkanTextureBase{
 private:
-	void load_texture(const char* filename);
+	//create the image, write_texels fills the mapped staging memory with width * height texels
+	void load_texture(uint32_t width, uint32_t height, const std::function<void(void*)>& write_texels);
+	void load_texture(const struct DecodedImage& image);
 
 public:
 	VulkanTexture2D() noexcept;
 	VulkanTexture2D(VkFormat format, uint32_t width, uint32_t height, VkImageUsageFlags usage, VkImageAspectFlags aspect)noexcept;
 	VulkanTexture2D(VkFormat format, const char* filename) noexcept;
+	VulkanTexture2D(VkFormat format, const struct DecodedImage& image) noexcept;
 	VulkanTexture2D(VulkanTexture2D&& texture) noexcept;
 
 	virtual VkDescriptorImageInfo get_info(VkImageLayout layout) const noexcept;